@@ -43,6 +43,7 @@ Some default parameters of Faust's ALSA applications are controlled by the follo
     FAUST2ALSA_FREQUENCY= 44100
     FAUST2ALSA_BUFFER   = 512
     FAUST2ALSA_PERIODS  = 2
+    FAUST2ALSA_MMAP     = 0 (1 to use the memory mapped access mode when the device supports it)
 */
 
 // handle 32/64 bits int size issues
@@ -116,13 +117,16 @@ struct AudioParam
 	unsigned int	fSoftInputs;
 	unsigned int	fSoftOutputs;
 
+	bool			fMmap;
+
  	AudioParam() :
 		fCardName("hw:0"),
 		fFrequency(44100),
 		fBuffering(512),
 		fPeriods(2),
 		fSoftInputs(2),
-		fSoftOutputs(2)
+		fSoftOutputs(2),
+		fMmap(false)
 	{}
 
 	AudioParam&	cardName(const char* n)	{ fCardName = n; 		return *this; }
@@ -131,6 +135,53 @@ struct AudioParam
 	AudioParam&	periods(int p)			{ fPeriods = p; 		return *this; }
 	AudioParam&	inputs(int n)			{ fSoftInputs = n; 		return *this; }
 	AudioParam&	outputs(int n)			{ fSoftOutputs = n; 	return *this; }
+	AudioParam&	mmap(bool m)			{ fMmap = m; 			return *this; }
+};
+
+/**
+ * Conversion between audio card samples of BITS bits and floating point samples.
+ * Card samples are accessed with a constant stride (1 in non-interleaved mode, the
+ * number of card channels in interleaved mode). The contiguous case is a separate
+ * loop without any branch, so that the compiler vectorizes it.
+ */
+template <typename SAMPLE, int BITS>
+struct alsa_converter
+{
+	// Largest sample value, and largest float value that can be converted to a sample without overflow
+	static float scale() { return float((1LL << (BITS - 1)) - 1); }
+	static float limit() { return (BITS < 32) ? scale() : 2147483520.f; }
+
+	// 24 bits samples are in the low bits of a 32 bits word, so the sign has to be extended
+	static int32 load(SAMPLE s) { return (BITS == 24) ? ((int32)((uint32)s << 8) >> 8) : (int32)s; }
+
+	static void toFloat(const SAMPLE* src, int stride, float* dst, int count)
+	{
+		const float gain = 1.0f / scale();
+		if (stride == 1) {
+			for (int i = 0; i < count; i++) {
+				dst[i] = float(load(src[i])) * gain;
+			}
+		} else {
+			for (int i = 0; i < count; i++) {
+				dst[i] = float(load(src[i * stride])) * gain;
+			}
+		}
+	}
+
+	static void fromFloat(const float* src, SAMPLE* dst, int stride, int count)
+	{
+		const float gain = scale();
+		const float lim = limit();
+		if (stride == 1) {
+			for (int i = 0; i < count; i++) {
+				dst[i] = SAMPLE(max(min(src[i] * gain, lim), -gain));
+			}
+		} else {
+			for (int i = 0; i < count; i++) {
+				dst[i * stride] = SAMPLE(max(min(src[i] * gain, lim), -gain));
+			}
+		}
+	}
 };
 
 /**
@@ -155,6 +206,13 @@ struct AudioInterface : public AudioParam
 
 	bool					fDuplexMode;
 
+	// sample size in bytes
+	unsigned int			fSampleSize;
+
+	// number of input overruns and output underruns
+	int						fInputXRuns;
+	int						fOutputXRuns;
+
 	// interleaved mode audiocard buffers
 	void*		fInputCardBuffer;
 	void*		fOutputCardBuffer;
@@ -184,8 +242,12 @@ struct AudioInterface : public AudioParam
 		fOutputDevice 			= 0;
 		fInputParams			= 0;
 		fOutputParams			= 0;
+		fInputXRuns				= 0;
+		fOutputXRuns			= 0;
 	}
 
+	bool isMmap() { return fSampleAccess == SND_PCM_ACCESS_MMAP_INTERLEAVED || fSampleAccess == SND_PCM_ACCESS_MMAP_NONINTERLEAVED; }
+
 	/**
 	 * Open the audio interface
 	 */
@@ -204,8 +266,10 @@ struct AudioInterface : public AudioParam
 		snd_pcm_hw_params_set_channels_near(fOutputDevice, fOutputParams, &fCardOutputs);
 		err = snd_pcm_hw_params(fOutputDevice, fOutputParams ); check_error(err);
 
-		// allocate alsa output buffers
-		if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
+		// allocate alsa output buffers (samples are directly written in the device ring buffer in mmap mode)
+		if (isMmap()) {
+			fOutputCardBuffer = 0;
+		} else if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
 			fOutputCardBuffer = calloc(interleavedBufferSize(fOutputParams), 1);
 		} else {
 			for (unsigned int i = 0; i < fCardOutputs; i++) {
@@ -240,7 +304,9 @@ struct AudioInterface : public AudioParam
             err = snd_pcm_hw_params(fInputDevice, fInputParams); check_error(err);
 
 			// allocation of alsa buffers
-			if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
+			if (isMmap()) {
+				fInputCardBuffer = 0;
+			} else if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
 				fInputCardBuffer = calloc(interleavedBufferSize(fInputParams), 1);
 			} else {
 				for (unsigned int i = 0; i < fCardInputs; i++) {
@@ -279,22 +345,37 @@ struct AudioInterface : public AudioParam
 		err = snd_pcm_hw_params_any(stream, params);
 		check_error_msg(err, "unable to init parameters")
 
-		// set alsa access mode (and fSampleAccess field) either to non interleaved or interleaved
+		// set alsa access mode (and fSampleAccess field) either to non interleaved or interleaved,
+		// in mmap mode when requested and supported by the device
 
-		err = snd_pcm_hw_params_set_access(stream, params, SND_PCM_ACCESS_RW_NONINTERLEAVED);
+		err = -1;
+		if (fMmap) {
+			err = snd_pcm_hw_params_set_access(stream, params, SND_PCM_ACCESS_MMAP_NONINTERLEAVED);
+			if (err) {
+				err = snd_pcm_hw_params_set_access(stream, params, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+			}
+			display_error_msg(err, "mmap access mode not available");
+		}
+		if (err) {
+			err = snd_pcm_hw_params_set_access(stream, params, SND_PCM_ACCESS_RW_NONINTERLEAVED);
+		}
 		if (err) {
 			err = snd_pcm_hw_params_set_access(stream, params, SND_PCM_ACCESS_RW_INTERLEAVED);
 			check_error_msg(err, "unable to set access mode neither to non-interleaved or to interleaved");
 		}
 		snd_pcm_hw_params_get_access(params, &fSampleAccess);
 
-		// search for 32-bits or 16-bits format
+		// search for 32-bits, 24-bits or 16-bits format
 		err = snd_pcm_hw_params_set_format(stream, params, SND_PCM_FORMAT_S32);
+		if (err) {
+			err = snd_pcm_hw_params_set_format(stream, params, SND_PCM_FORMAT_S24);
+		}
 		if (err) {
 			err = snd_pcm_hw_params_set_format(stream, params, SND_PCM_FORMAT_S16);
-		 	check_error_msg(err, "unable to set format to either 32-bits or 16-bits");
+		 	check_error_msg(err, "unable to set format to either 32-bits, 24-bits or 16-bits");
 		}
 		snd_pcm_hw_params_get_format(params, &fSampleFormat);
+		fSampleSize = snd_pcm_format_physical_width(fSampleFormat) / 8;
 		// set sample frequency
 		snd_pcm_hw_params_set_rate_near (stream, params, &fFrequency, 0);
 
@@ -326,38 +407,133 @@ struct AudioInterface : public AudioParam
 	void close()
 	{}
 
+	/**
+	 * Convert count card samples (accessed with the given stride) to floats
+	 */
+	void cardToFloat(const void* src, int stride, float* dst, int count)
+	{
+		if (fSampleFormat == SND_PCM_FORMAT_S16) {
+			alsa_converter<short, 16>::toFloat((const short*)src, stride, dst, count);
+		} else if (fSampleFormat == SND_PCM_FORMAT_S24) {
+			alsa_converter<int32, 24>::toFloat((const int32*)src, stride, dst, count);
+		} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
+			alsa_converter<int32, 32>::toFloat((const int32*)src, stride, dst, count);
+		} else {
+			printf("unrecognized input sample format : %u\n", fSampleFormat);
+			exit(1);
+		}
+	}
+
+	/**
+	 * Convert count floats to card samples (accessed with the given stride)
+	 */
+	void floatToCard(const float* src, void* dst, int stride, int count)
+	{
+		if (fSampleFormat == SND_PCM_FORMAT_S16) {
+			alsa_converter<short, 16>::fromFloat(src, (short*)dst, stride, count);
+		} else if (fSampleFormat == SND_PCM_FORMAT_S24) {
+			alsa_converter<int32, 24>::fromFloat(src, (int32*)dst, stride, count);
+		} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
+			alsa_converter<int32, 32>::fromFloat(src, (int32*)dst, stride, count);
+		} else {
+			printf("unrecognized output sample format : %u\n", fSampleFormat);
+			exit(1);
+		}
+	}
+
+	/**
+	 * Restart a stream after an error, counting xruns
+	 */
+	void recover(snd_pcm_t* stream, int err, int& xruns)
+	{
+		if (err == -EPIPE) xruns++;
+		err = snd_pcm_recover(stream, err, 1);
+		if (err < 0) {
+			err = snd_pcm_prepare(stream);
+			check_error_msg(err, "recovering stream");
+		}
+	}
+
+	/**
+	 * Transfer a period between the float channels and the device ring buffer in mmap mode :
+	 * samples are directly converted from/to the memory mapped areas, without intermediate buffers
+	 */
+	void transferMmap(snd_pcm_t* stream, float** channels, unsigned int nchannels, bool capture, int& xruns)
+	{
+		snd_pcm_uframes_t done = 0;
+		while (done < fBuffering) {
+			snd_pcm_sframes_t avail = snd_pcm_avail_update(stream);
+			if (avail < 0) {
+				recover(stream, avail, xruns);
+				continue;
+			}
+			if (avail == 0) {
+				// empty capture ring or full playback ring : the stream has to be started, or we wait for the device
+				if (snd_pcm_state(stream) == SND_PCM_STATE_PREPARED) {
+					int err = snd_pcm_start(stream);
+					if (err < 0) {
+						// recover and retry once, the stream would stay prepared and the loop would spin
+						display_error_msg(err, "starting stream");
+						recover(stream, err, xruns);
+						err = snd_pcm_start(stream);
+						check_error_msg(err, "starting stream");
+					}
+				} else {
+					int err = snd_pcm_wait(stream, 1000);
+					if (err < 0) recover(stream, err, xruns);
+				}
+				continue;
+			}
+
+			const snd_pcm_channel_area_t* areas;
+			snd_pcm_uframes_t offset;
+			snd_pcm_uframes_t frames = fBuffering - done;
+			int err = snd_pcm_mmap_begin(stream, &areas, &offset, &frames);
+			if (err < 0) {
+				recover(stream, err, xruns);
+				continue;
+			}
+
+			for (unsigned int c = 0; c < nchannels; c++) {
+				char* samples = (char*)areas[c].addr + (areas[c].first + offset * areas[c].step) / 8;
+				int stride = areas[c].step / (fSampleSize * 8);
+				if (capture) {
+					cardToFloat(samples, stride, channels[c] + done, frames);
+				} else {
+					floatToCard(channels[c] + done, samples, stride, frames);
+				}
+			}
+
+			snd_pcm_sframes_t committed = snd_pcm_mmap_commit(stream, offset, frames);
+			if (committed < 0 || snd_pcm_uframes_t(committed) != frames) {
+				recover(stream, (committed < 0) ? committed : -EPIPE, xruns);
+			}
+			done += frames;
+		}
+	}
+
 	/**
 	 * Read audio samples from the audio card. Convert samples to floats and take
 	 * care of interleaved buffers
 	 */
 	void read()
 	{
-        if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
+		if (isMmap()) {
+
+			transferMmap(fInputDevice, fInputSoftChannels, fCardInputs, true, fInputXRuns);
+
+		} else if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
 
 			int count = snd_pcm_readi(fInputDevice, fInputCardBuffer, fBuffering);
 			if (count < 0) {
 				 //display_error_msg(count, "reading samples");
+				 if (count == -EPIPE) fInputXRuns++;
 				 snd_pcm_prepare(fInputDevice);
 				 //check_error_msg(err, "preparing input stream");
 			}
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-				short* buffer16b = (short*)fInputCardBuffer;
-				for (unsigned int s = 0; s < fBuffering; s++) {
-					for (unsigned int c = 0; c < fCardInputs; c++) {
-						fInputSoftChannels[c][s] = float(buffer16b[c + s*fCardInputs])*(1.0/float(SHRT_MAX));
-					}
-				}
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
-				int32* buffer32b = (int32*)fInputCardBuffer;
-				for (unsigned int s = 0; s < fBuffering; s++) {
-					for (unsigned int c = 0; c < fCardInputs; c++) {
-						fInputSoftChannels[c][s] = float(buffer32b[c + s*fCardInputs])*(1.0/float(INT_MAX));
-					}
-				}
-			} else {
-				printf("unrecognized input sample format : %u\n", fSampleFormat);
-				exit(1);
+			for (unsigned int c = 0; c < fCardInputs; c++) {
+				cardToFloat((char*)fInputCardBuffer + c * fSampleSize, fCardInputs, fInputSoftChannels[c], fBuffering);
 			}
 
 		} else if (fSampleAccess == SND_PCM_ACCESS_RW_NONINTERLEAVED) {
@@ -365,27 +541,13 @@ struct AudioInterface : public AudioParam
 			int count = snd_pcm_readn(fInputDevice, fInputCardChannels, fBuffering);
 			if (count < 0) {
 				 //display_error_msg(count, "reading samples");
+				 if (count == -EPIPE) fInputXRuns++;
 				 snd_pcm_prepare(fInputDevice);
 				 //check_error_msg(err, "preparing input stream");
 			}
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-				for (unsigned int c = 0; c < fCardInputs; c++) {
-					short* chan16b = (short*)fInputCardChannels[c];
-					for (unsigned int s = 0; s < fBuffering; s++) {
-						fInputSoftChannels[c][s] = float(chan16b[s])*(1.0/float(SHRT_MAX));
-					}
-				}
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
-				for (unsigned int c = 0; c < fCardInputs; c++) {
-					int32* chan32b = (int32*)fInputCardChannels[c];
-					for (unsigned int s = 0; s < fBuffering; s++) {
-						fInputSoftChannels[c][s] = float(chan32b[s])*(1.0/float(INT_MAX));
-					}
-				}
-			} else {
-				printf("unrecognized input sample format : %u\n", fSampleFormat);
-				exit(1);
+			for (unsigned int c = 0; c < fCardInputs; c++) {
+				cardToFloat(fInputCardChannels[c], 1, fInputSoftChannels[c], fBuffering);
 			}
 
 		} else {
@@ -401,69 +563,35 @@ struct AudioInterface : public AudioParam
 	{
 		recovery :
 
-		if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
+		if (isMmap()) {
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-				short* buffer16b = (short*)fOutputCardBuffer;
-				for (unsigned int f = 0; f < fBuffering; f++) {
-					for (unsigned int c = 0; c < fCardOutputs; c++) {
-						float x = fOutputSoftChannels[c][f];
-						buffer16b[c + f*fCardOutputs] = short(max(min(x,1.0f),-1.0f) * float(SHRT_MAX)) ;
-					}
-				}
+			transferMmap(fOutputDevice, fOutputSoftChannels, fCardOutputs, false, fOutputXRuns);
 
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32)  {
-				int32* buffer32b = (int32*)fOutputCardBuffer;
-				for (unsigned int f = 0; f < fBuffering; f++) {
-					for (unsigned int c = 0; c < fCardOutputs; c++) {
-						float x = fOutputSoftChannels[c][f];
-						buffer32b[c + f*fCardOutputs] = int(max(min(x,1.0f),-1.0f) * float(INT_MAX));
-					}
-				}
-			} else {
-				printf("unrecognized output sample format : %u\n", fSampleFormat);
-				exit(1);
+		} else if (fSampleAccess == SND_PCM_ACCESS_RW_INTERLEAVED) {
+
+			for (unsigned int c = 0; c < fCardOutputs; c++) {
+				floatToCard(fOutputSoftChannels[c], (char*)fOutputCardBuffer + c * fSampleSize, fCardOutputs, fBuffering);
 			}
 
 			int count = snd_pcm_writei(fOutputDevice, fOutputCardBuffer, fBuffering);
 			if (count<0) {
 				//display_error_msg(count, "w3");
+				if (count == -EPIPE) fOutputXRuns++;
 				snd_pcm_prepare(fOutputDevice);
 				//check_error_msg(err, "preparing output stream");
 				goto recovery;
 			}
 
-
 		} else if (fSampleAccess == SND_PCM_ACCESS_RW_NONINTERLEAVED) {
 
-			if (fSampleFormat == SND_PCM_FORMAT_S16) {
-
-				for (unsigned int c = 0; c < fCardOutputs; c++) {
-					short* chan16b = (short*) fOutputCardChannels[c];
-					for (unsigned int f = 0; f < fBuffering; f++) {
-						float x = fOutputSoftChannels[c][f];
-						chan16b[f] = short(max(min(x,1.0f),-1.0f) * float(SHRT_MAX));
-					}
-				}
-
-			} else if (fSampleFormat == SND_PCM_FORMAT_S32) {
-
-				for (unsigned int c = 0; c < fCardOutputs; c++) {
-					int32* chan32b = (int32*) fOutputCardChannels[c];
-					for (unsigned int f = 0; f < fBuffering; f++) {
-						float x = fOutputSoftChannels[c][f];
-						chan32b[f] = int(max(min(x,1.0f),-1.0f) * float(INT_MAX));
-					}
-				}
-
-			} else {
-				printf("unrecognized output sample format : %u\n", fSampleFormat);
-				exit(1);
+			for (unsigned int c = 0; c < fCardOutputs; c++) {
+				floatToCard(fOutputSoftChannels[c], fOutputCardChannels[c], 1, fBuffering);
 			}
 
 			int count = snd_pcm_writen(fOutputDevice, fOutputCardChannels, fBuffering);
 			if (count<0) {
 				//display_error_msg(count, "w3");
+				if (count == -EPIPE) fOutputXRuns++;
 				snd_pcm_prepare(fOutputDevice);
 				//check_error_msg(err, "preparing output stream");
 				goto recovery;
@@ -551,6 +679,9 @@ struct AudioInterface : public AudioParam
     int getNumInputs() { return fCardInputs; }
     int getNumOutputs() { return fCardOutputs; }
 
+    int getInputXRuns() { return fInputXRuns; }
+    int getOutputXRuns() { return fOutputXRuns; }
+
 };
 
 // lopt : Scan Command Line long int Arguments
@@ -630,6 +761,7 @@ class alsaaudio : public audio
             .frequency(lopt(argc, argv, "--frequency", "-f", getDefaultEnv("FAUST2ALSA_FREQUENCY", 44100)))
             .buffering(lopt(argc, argv, "--buffer", "-b", getDefaultEnv("FAUST2ALSA_BUFFER", 512)))
             .periods(lopt(argc, argv, "--periods", "-p", getDefaultEnv("FAUST2ALSA_PERIODS", 2)))
+            .mmap(lopt(argc, argv, "--mmap", "-m", getDefaultEnv("FAUST2ALSA_MMAP", 0)))
             .inputs(DSP->getNumInputs())
             .outputs(DSP->getNumOutputs()));
     }
@@ -699,6 +831,10 @@ class alsaaudio : public audio
     virtual int getNumInputs() { return fAudio->getNumInputs(); }
     virtual int getNumOutputs() { return fAudio->getNumOutputs(); }
 
+    // Number of xruns since the audio interface was opened
+    int getInputXRuns() { return fAudio->getInputXRuns(); }
+    int getOutputXRuns() { return fAudio->getOutputXRuns(); }
+
 };
 
 void* __run (void* ptr)
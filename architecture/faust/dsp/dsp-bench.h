@@ -25,9 +25,14 @@
 #define __dsp_bench__
 
 #include <limits.h>
+#include <math.h>
 #include <sys/time.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <algorithm>
 #include <assert.h>
@@ -36,6 +41,8 @@
 #include <unistd.h>
 
 #include "faust/dsp/dsp.h"
+#include "faust/gui/UI.h"
+#include "faust/gui/DecoratorUI.h"
 
 // Handle 32/64 bits int size issues
 #ifdef __x86_64__
@@ -68,6 +75,35 @@ void FAUSTBENCH_LOG(VAL_TYPE val)
     }
 }
 
+/*
+    Statistics on the duration of the measured blocks
+*/
+
+struct bench_stats {
+    
+    int fCount;             // number of measured blocks
+    double fMedianUsec;     // median block duration in usec
+    double fLowUsec;        // 95% confidence interval of the median block duration
+    double fHighUsec;
+    double fP99Usec;        // 99th percentile of the block duration in usec
+    double fMaxUsec;        // worst block duration in usec
+    double fMBps;           // throughput in Megabytes/second (computed from the median block duration)
+    double fLowMBps;        // 95% confidence interval of the throughput
+    double fHighMBps;
+    double fDrift;          // relative difference between the median durations of the first and last quarter of the blocks
+    
+    bench_stats():fCount(0), fMedianUsec(0), fLowUsec(0), fHighUsec(0), fP99Usec(0), fMaxUsec(0),
+        fMBps(0), fLowMBps(0), fHighMBps(0), fDrift(0)
+    {}
+    
+    /**
+     * A drift of the block duration during the measure usually means that the CPU frequency changed
+     * (frequency scaling or thermal throttling), so that the measure is not reliable.
+     */
+    bool isStable(double tolerance = 0.05) { return fabs(fDrift) <= tolerance; }
+    
+};
+
 /*
     A class to do do timing measurements
 */
@@ -166,6 +202,15 @@ class time_bench {
             while (a != b) { r += *a++; n++; }
             return (n > 0) ? r/n : 0;
         }
+    
+        /**
+         * Compute the median value of a vector of measures (the vector is sorted)
+         */
+        uint64 medianValue(std::vector<uint64>& V)
+        {
+            sort(V.begin(), V.end());
+            return V[V.size() / 2];
+        }
   
     public:
     
@@ -263,19 +308,269 @@ class time_bench {
             << std::endl;
         }
     
+        /**
+         * Returns the duration (in clocks) of the last fCount blocks, in chronological order.
+         */
+        std::vector<uint64> getMeasures()
+        {
+            assert(fMeasure > fCount);
+            std::vector<uint64> V(fCount);
+            
+            for (int i = 0; i < fCount; i++) {
+                int index = (fMeasure + i) % fCount;
+                V[i] = fStops[index] - fStarts[index];
+            }
+            return V;
+        }
+    
+        /**
+         * Returns the median and 99th percentile block duration, the throughput and their 95% confidence intervals.
+         * The confidence interval of the median is computed with order statistics, so that no assumption
+         * is made on the distribution of the measures.
+         */
+        bench_stats getBenchStats(int bsize, int ichans, int ochans)
+        {
+            bench_stats stats;
+            std::vector<uint64> V = getMeasures();
+            
+            // Compare the first and last quarter of the blocks
+            std::vector<uint64> first(V.begin(), V.begin() + fCount / 4);
+            std::vector<uint64> last(V.end() - fCount / 4, V.end());
+            if (first.size() > 0) {
+                stats.fDrift = double(medianValue(last)) / double(medianValue(first)) - 1.;
+            }
+            
+            sort(V.begin(), V.end());
+            
+            int half = int(0.98 * sqrt(double(fCount)));
+            int low = std::max(0, fCount / 2 - half - 1);
+            int high = std::min(fCount - 1, fCount / 2 + half);
+            
+            stats.fCount = fCount;
+            stats.fMedianUsec = rdtsc2sec(V[fCount / 2]) * 1e6;
+            stats.fLowUsec = rdtsc2sec(V[low]) * 1e6;
+            stats.fHighUsec = rdtsc2sec(V[high]) * 1e6;
+            stats.fP99Usec = rdtsc2sec(V[std::min(fCount - 1, (fCount * 99) / 100)]) * 1e6;
+            stats.fMaxUsec = rdtsc2sec(V[fCount - 1]) * 1e6;
+            stats.fMBps = megapersec(bsize, ichans + ochans, V[fCount / 2]);
+            stats.fLowMBps = megapersec(bsize, ichans + ochans, V[high]);
+            stats.fHighMBps = megapersec(bsize, ichans + ochans, V[low]);
+            return stats;
+        }
+    
         bool isRunning() { return (fMeasure <= (fCount + fSkip)); }
     
         int getCount()
         {
             return fMeasure;
         }
+    
+        /**
+         * Returns the CPU frequency scaling governor ('performance', 'powersave'...),
+         * or an empty string if it cannot be read (non Linux systems). Measures are only reliable
+         * with the 'performance' governor.
+         */
+        static std::string getScalingGovernor()
+        {
+            std::string governor;
+            std::ifstream reader("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+            if (reader.is_open()) reader >> governor;
+            return governor;
+        }
 
 };
 
+/*
+    A lock-free latency histogram with HDR-style buckets : durations (in nanoseconds) are grouped
+    by power of two, each power of two being divided in 16 linear sub-buckets (so with a 6% precision).
+    Durations are added by a single (real-time) thread, and can be read from any other thread.
+*/
+
+class latency_histogram {
+    
+    public:
+    
+        static const int kSubBits = 4;
+        static const int kSubCount = 1 << kSubBits;
+        static const int kMaxBits = 40;    // durations are clipped to 2^40 ns (about 18 mn)
+        static const int kBuckets = (kMaxBits - kSubBits + 1) * kSubCount;
+    
+    protected:
+    
+        std::atomic<uint64> fBuckets[kBuckets];
+        std::atomic<uint64> fCount;
+        std::atomic<uint64> fMisses;        // number of durations above the deadline
+        std::atomic<uint64> fNearMisses;    // number of durations between 80% and 100% of the deadline
+        std::atomic<uint64> fMax;
+    
+        // Only one thread writes the counters, so no atomic read-modify-write is needed
+        static void increment(std::atomic<uint64>& counter)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    
+    public:
+    
+        latency_histogram() { reset(); }
+    
+        /**
+         * Returns the current time in nanoseconds
+         */
+        static uint64 now()
+        {
+            return (uint64)(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    
+        static int getBucket(uint64 ns)
+        {
+            if (ns < (uint64)kSubCount) return int(ns);
+            int bits = 63 - __builtin_clzll((unsigned long long)ns);
+            if (bits >= kMaxBits) return kBuckets - 1;
+            return (bits - kSubBits + 1) * kSubCount + int((ns >> (bits - kSubBits)) & (kSubCount - 1));
+        }
+    
+        /**
+         * Returns the lowest duration (in nanoseconds) of a bucket
+         */
+        static uint64 getBucketValue(int bucket)
+        {
+            if (bucket < kSubCount) return (uint64)bucket;
+            int bits = bucket / kSubCount + kSubBits - 1;
+            return (uint64)(kSubCount + bucket % kSubCount) << (bits - kSubBits);
+        }
+    
+        /**
+         * Add a duration, to be called by the real-time thread only.
+         *
+         * @param ns - the duration in nanoseconds
+         * @param deadline_ns - the deadline in nanoseconds
+         */
+        void add(uint64 ns, uint64 deadline_ns)
+        {
+            increment(fBuckets[getBucket(ns)]);
+            increment(fCount);
+            if (ns > deadline_ns) {
+                increment(fMisses);
+            } else if (ns * 5 > deadline_ns * 4) {
+                increment(fNearMisses);
+            }
+            if (ns > fMax.load(std::memory_order_relaxed)) {
+                fMax.store(ns, std::memory_order_relaxed);
+            }
+        }
+    
+        /**
+         * Reset the histogram. Values concurrently added by the real-time thread may be lost.
+         */
+        void reset()
+        {
+            for (int i = 0; i < kBuckets; i++) {
+                fBuckets[i].store(0, std::memory_order_relaxed);
+            }
+            fCount.store(0, std::memory_order_relaxed);
+            fMisses.store(0, std::memory_order_relaxed);
+            fNearMisses.store(0, std::memory_order_relaxed);
+            fMax.store(0, std::memory_order_relaxed);
+        }
+    
+        uint64 getCount() { return fCount.load(std::memory_order_relaxed); }
+        uint64 getMisses() { return fMisses.load(std::memory_order_relaxed); }
+        uint64 getNearMisses() { return fNearMisses.load(std::memory_order_relaxed); }
+        double getMaxUsec() { return double(fMax.load(std::memory_order_relaxed)) / 1e3; }
+    
+        /**
+         * Returns the given percentile (between 0 and 100) of the durations in microseconds,
+         * as the highest duration of the bucket containing it.
+         */
+        double getPercentileUsec(double percentile)
+        {
+            uint64 counts[kBuckets];
+            uint64 total = 0;
+            for (int i = 0; i < kBuckets; i++) {
+                counts[i] = fBuckets[i].load(std::memory_order_relaxed);
+                total += counts[i];
+            }
+            if (total == 0) return 0.;
+            
+            uint64 rank = std::max((uint64)1, (uint64)(ceil(percentile / 100. * double(total))));
+            uint64 sum = 0;
+            for (int i = 0; i < kBuckets - 1; i++) {
+                sum += counts[i];
+                if (sum >= rank) {
+                    return std::min(double(getBucketValue(i + 1) - 1) / 1e3, getMaxUsec());
+                }
+            }
+            return getMaxUsec();
+        }
+    
+        /**
+         * Returns the histogram as a JSON string : counters, usual percentiles
+         * and the [lowest duration in usec, count] of non empty buckets.
+         */
+        std::string getJSON()
+        {
+            std::stringstream json;
+            json << "{\"count\": " << getCount()
+                 << ", \"misses\": " << getMisses()
+                 << ", \"near_misses\": " << getNearMisses()
+                 << ", \"p50_us\": " << getPercentileUsec(50.)
+                 << ", \"p99_us\": " << getPercentileUsec(99.)
+                 << ", \"p999_us\": " << getPercentileUsec(99.9)
+                 << ", \"max_us\": " << getMaxUsec()
+                 << ", \"buckets\": [";
+            const char* sep = "";
+            for (int i = 0; i < kBuckets; i++) {
+                uint64 count = fBuckets[i].load(std::memory_order_relaxed);
+                if (count > 0) {
+                    json << sep << "[" << (double(getBucketValue(i)) / 1e3) << ", " << count << "]";
+                    sep = ", ";
+                }
+            }
+            json << "]}";
+            return json.str();
+        }
+    
+};
+
 /*
     A class to measure DSP CPU use.
 */
 
+/**
+ * Collects the 'profile' bargraphs of a DSP compiled with -pgi, to write them
+ * in the select profile format read by -pgu : one 'select_<key> <ratio>' line per select2.
+ */
+struct select_profile_ui : public GenericUI {
+
+    std::vector<std::pair<std::string, FAUSTFLOAT*> > fEntries;
+    bool fProfile;
+
+    select_profile_ui():fProfile(false) {}
+
+    void declare(FAUSTFLOAT* zone, const char* key, const char* val)
+    {
+        if (strcmp(key, "profile") == 0) fProfile = true;
+    }
+
+    void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
+    {
+        if (fProfile) fEntries.push_back(std::make_pair(std::string(label), zone));
+        fProfile = false;
+    }
+
+    bool write(const std::string& filename)
+    {
+        std::ofstream writer(filename.c_str());
+        if (!writer.is_open()) return false;
+        for (size_t i = 0; i < fEntries.size(); i++) {
+            FAUSTFLOAT ratio = *fEntries[i].second;
+            // The ratio is NaN until a block has been computed
+            if (ratio == ratio) writer << fEntries[i].first << " " << ratio << std::endl;
+        }
+        return true;
+    }
+};
+
 class measure_dsp : public decorator_dsp {
     
     protected:
@@ -290,9 +585,24 @@ class measure_dsp : public decorator_dsp {
         int fOutputIndex;
         int fCount;
     
+        // Per-callback latency, always measured
+        latency_histogram fHistogram;
+        int fSampleRate;
+        int fUpdate;
+    
+        // Zones of the latency bargraphs (see buildLatencyUI)
+        FAUSTFLOAT fLatency;
+        FAUSTFLOAT fP99Latency;
+        FAUSTFLOAT fMaxLatency;
+        FAUSTFLOAT fLoad;
+        FAUSTFLOAT fMisses;
+    
         void init()
         {
             fDSP->init(SAMPLE_RATE);
+            fSampleRate = SAMPLE_RATE;
+            fUpdate = 0;
+            fLatency = fP99Latency = fMaxLatency = fLoad = fMisses = FAUSTFLOAT(0);
             
             fInputIndex = 0;
             fOutputIndex = 0;
@@ -303,10 +613,11 @@ class measure_dsp : public decorator_dsp {
                 fAllInputs[i] = new FAUSTFLOAT[fBufferSize * NV];
                 fInputs[i] = fAllInputs[i];
                 // Write noise in inputs (to avoid 'speedup' effect due to null values)
-                int R0_0 = 0;
+                // (computed in unsigned arithmetic, since a signed overflow lets the compiler break the sequence)
+                unsigned int R0_0 = 0;
                 for (int j = 0; j < fBufferSize * NV; j++) {
-                    int R0temp0 = (12345 + (1103515245 * R0_0));
-                    fAllInputs[i][j] = FAUSTFLOAT(4.656613e-10f * R0temp0);
+                    unsigned int R0temp0 = (12345u + (1103515245u * R0_0));
+                    fAllInputs[i][j] = FAUSTFLOAT(4.656613e-10f * int(R0temp0));
                     R0_0 = R0temp0;
                 }
             }
@@ -405,6 +716,21 @@ class measure_dsp : public decorator_dsp {
             // DSP is deallocated by the decorator_dsp class.
         }
     
+        /**
+         *  Keep the sample rate, used to compute the real-time deadline of each block
+         */
+        virtual void init(int sample_rate)
+        {
+            fSampleRate = sample_rate;
+            decorator_dsp::init(sample_rate);
+        }
+    
+        virtual void instanceInit(int sample_rate)
+        {
+            fSampleRate = sample_rate;
+            decorator_dsp::instanceInit(sample_rate);
+        }
+    
         /**
          *  Measure the duration of the compute call
          */
@@ -412,8 +738,24 @@ class measure_dsp : public decorator_dsp {
         {
             AVOIDDENORMALS;
             fBench->startMeasure();
+            uint64 start = latency_histogram::now();
             fDSP->compute(count, inputs, outputs);
+            uint64 duration = latency_histogram::now() - start;
             fBench->stopMeasure();
+            
+            // Deadline is the duration of the block in real-time
+            uint64 deadline = ((uint64)count * 1000000000) / (uint64)fSampleRate;
+            fHistogram.add(duration, deadline);
+            
+            fLatency = FAUSTFLOAT(double(duration) / 1e3);
+            fLoad = FAUSTFLOAT(100. * double(duration) / double(std::max(deadline, (uint64)1)));
+            fMaxLatency = FAUSTFLOAT(fHistogram.getMaxUsec());
+            fMisses = FAUSTFLOAT(fHistogram.getMisses());
+            // The percentile needs to read all buckets, so it is not updated at each block
+            if (++fUpdate == 512) {
+                fUpdate = 0;
+                fP99Latency = FAUSTFLOAT(fHistogram.getPercentileUsec(99.));
+            }
         }
     
         virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
@@ -474,6 +816,14 @@ class measure_dsp : public decorator_dsp {
             return fBench->getStats(fBufferSize, fDSP->getNumInputs(), fDSP->getNumOutputs());
         }
     
+        /**
+         *  Returns the latency and throughput statistics of the last measure
+         */
+        bench_stats getBenchStats()
+        {
+            return fBench->getBenchStats(fBufferSize, fDSP->getNumInputs(), fDSP->getNumOutputs());
+        }
+    
         /**
          * Print the median value (in Megabytes/second) of fCount throughputs measurements
          */
@@ -491,6 +841,53 @@ class measure_dsp : public decorator_dsp {
     
         int getCount() { return fCount; }
     
+        /**
+         * Returns the per-callback latency histogram, which can be read from any thread
+         * while the DSP is running.
+         */
+        latency_histogram* getLatencyHistogram() { return &fHistogram; }
+    
+        /**
+         * Returns the per-callback latency histogram as a JSON string (see latency_histogram::getJSON)
+         */
+        std::string getLatencyJSON() { return fHistogram.getJSON(); }
+    
+        /**
+         * Build a 'latency' group of bargraphs with the last, 99th percentile and worst callback
+         * durations (in usec), the DSP load of the last callback (in % of the deadline) and the number
+         * of deadline misses. This is separated from buildUserInterface, so that the
+         * decorated DSP user interface is kept unchanged.
+         */
+        void buildLatencyUI(UI* ui_interface)
+        {
+            ui_interface->openVerticalBox("latency");
+            ui_interface->declare(&fLatency, "unit", "us");
+            ui_interface->addHorizontalBargraph("last", &fLatency, FAUSTFLOAT(0), FAUSTFLOAT(10000));
+            ui_interface->declare(&fP99Latency, "unit", "us");
+            ui_interface->addHorizontalBargraph("p99", &fP99Latency, FAUSTFLOAT(0), FAUSTFLOAT(10000));
+            ui_interface->declare(&fMaxLatency, "unit", "us");
+            ui_interface->addHorizontalBargraph("max", &fMaxLatency, FAUSTFLOAT(0), FAUSTFLOAT(10000));
+            ui_interface->declare(&fLoad, "unit", "%");
+            ui_interface->addHorizontalBargraph("load", &fLoad, FAUSTFLOAT(0), FAUSTFLOAT(100));
+            ui_interface->addHorizontalBargraph("misses", &fMisses, FAUSTFLOAT(0), FAUSTFLOAT(1e9));
+            ui_interface->closeBox();
+        }
+
+        /**
+         * Write the select profile of a DSP compiled with -pgi, from the ratios counted
+         * during the previous measures, to be given to the compiler with -pgu.
+         *
+         * @param filename - the profile filename
+         *
+         * @return true if the profile has been written.
+         */
+        bool writeSelectProfile(const std::string& filename)
+        {
+            select_profile_ui profile;
+            fDSP->buildUserInterface(&profile);
+            return profile.write(filename);
+        }
+    
 };
 
 #endif
@@ -27,6 +27,7 @@
 #define __dsp_optimizer__
 
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <sys/types.h>
 #include <pwd.h>
@@ -65,6 +66,10 @@ class dsp_optimizer {
     
         std::vector<std::vector <std::string> > fOptionsTable;
     
+        std::string fProfileKey;    // SHA key of the DSP, used to index the profile entries
+        std::string fSelectProfile; // select profile written by an instrumented run, given to -pgu
+        std::vector<std::pair<double, std::vector<std::string> > > fMeasures;  // measures done during the search
+    
         double bench(int run)
         {
             // First call with fCount = -1 will be used to estimate fCount by giving the wanted measure duration
@@ -227,6 +232,17 @@ class dsp_optimizer {
             std::cout << " : ";
         }
     
+        // Compile with the select profile, when collected
+        std::vector <std::string> addSelectProfile(const std::vector <std::string>& item)
+        {
+            std::vector <std::string> res_item = item;
+            if (fSelectProfile != "" && std::find(item.begin(), item.end(), "-pgu") == item.end()) {
+                res_item.push_back("-pgu");
+                res_item.push_back(fSelectProfile);
+            }
+            return res_item;
+        }
+    
         std::vector <std::string> addArgvItems(const std::vector <std::string>& item, int argc, const char* argv[])
         {
             std::vector <std::string> res_item = item;
@@ -236,27 +252,36 @@ class dsp_optimizer {
             return res_item;
         }
         
-        bool computeOne(const std::vector<std::string>& item, int run, double& res)
+        bool createFactory(const std::vector<std::string>& item)
         {
-            if (fTrace) printItem(item);
-            
-            int argc = 0;
-            const char* argv[64];
-            for (int i = 0; i < item.size(); i++) {
-                argv[argc++] = item[i].c_str();
+            std::vector<const char*> argv;
+            for (size_t i = 0; i < item.size(); i++) {
+                argv.push_back(item[i].c_str());
             }
-            argv[argc] = 0;  // NULL terminated argv
+            argv.push_back(0);  // NULL terminated argv
+            int argc = int(argv.size()) - 1;
             
             if (fInput == "") {
-                fFactory = createDSPFactoryFromFile(fFilename.c_str(), argc, argv, fTarget, fError, fOptLevel);
+                fFactory = createDSPFactoryFromFile(fFilename.c_str(), argc, &argv[0], fTarget, fError, fOptLevel);
             } else {
-                fFactory = createDSPFactoryFromString("FaustDSP", fInput, argc, argv, fTarget, fError, fOptLevel);
+                fFactory = createDSPFactoryFromString("FaustDSP", fInput, argc, &argv[0], fTarget, fError, fOptLevel);
             }
             
             if (!fFactory) {
                 std::cerr << "Cannot create factory : " << fError << std::endl;
                 return false;
             }
+            return true;
+        }
+    
+        bool computeOne(const std::vector<std::string>& item, int run, double& res)
+        {
+            if (fTrace) printItem(item);
+            
+            if (!createFactory(item)) return false;
+            
+            // The first compiled factory gives the key of the DSP in the profile
+            if (fProfileKey == "") fProfileKey = fFactory->getSHAKey();
             
             fDSP = fFactory->createDSPInstance();
             if (!fDSP) {
@@ -276,22 +301,108 @@ class dsp_optimizer {
         std::pair<double, std::vector<std::string> > findOptimizedParametersAux(const std::vector<std::vector <std::string> >& options)
         {
             std::vector<std::pair<int, double > > table_res;
+            std::vector<std::vector <std::string> > items;
             double res = 0.;
             
             for (int i = 0; i < options.size(); i++) {
-                if (computeOne(addArgvItems(options[i], fArgc, fArgv), fRun, res)) {
+                items.push_back(addSelectProfile(options[i]));
+                if (computeOne(addArgvItems(items[i], fArgc, fArgv), fRun, res)) {
                     table_res.push_back(std::make_pair(i, res));
+                    fMeasures.push_back(std::make_pair(res, items[i]));
                 } else {
                     std::cerr << "computeOne error..." << std::endl;
                 }
             }
             
             sort(table_res.begin(), table_res.end(), compareFun);
-            return std::make_pair(table_res[0].second, options[table_res[0].first]);
+            return std::make_pair(table_res[0].second, items[table_res[0].first]);
         }
 
+        /*
+            Run the DSP compiled with -pgi (in scalar mode, the select profile does not depend
+            on the code generation options) to count how often each select2 condition is true.
+        */
+        bool collectSelectProfile(const std::string& select_profile)
+        {
+            if (fTrace) std::cout << "Collect the select profile in '" << select_profile << "'" << std::endl;
+            std::vector<std::string> item = fOptionsTable[0];
+            item.push_back("-pgi");
+            if (!createFactory(addArgvItems(item, fArgc, fArgv))) return false;
+            
+            fDSP = fFactory->createDSPInstance();
+            if (!fDSP) {
+                std::cerr << "Cannot create instance..." << std::endl;
+                deleteDSPFactory(fFactory);
+                fFactory = 0;
+                return false;
+            }
+            
+            bool res;
+            {
+                measure_dsp mes(fDSP, fBufferSize, 1., false);
+                mes.measure();
+                res = mes.writeSelectProfile(select_profile);
+                // fDSP is deallocated by measure_dsp
+            }
+            deleteDSPFactory(fFactory);
+            fFactory = 0;
+            fDSP = 0;
+            
+            if (res) {
+                fSelectProfile = select_profile;
+            } else {
+                std::cerr << "Cannot write select profile '" << select_profile << "'" << std::endl;
+            }
+            return res;
+        }
+    
         static bool compareFun(std::pair<int, double> i, std::pair<int, double> j) { return (i.second > j.second); }
     
+        static bool compareMeasure(const std::pair<double, std::vector<std::string> >& i,
+                                   const std::pair<double, std::vector<std::string> >& j) { return (i.first > j.first); }
+    
+        /*
+            A profile is a text file with one measure per line : 'SHA_key score option1 option2...',
+            so that several DSPs can share the same profile.
+        */
+        void readProfile(const std::string& profile,
+                         std::vector<std::pair<double, std::vector<std::string> > >& entries,
+                         std::vector<std::string>& others)
+        {
+            std::ifstream reader(profile.c_str());
+            std::string line;
+            while (std::getline(reader, line)) {
+                std::stringstream stream(line);
+                std::string key, option;
+                double score;
+                if (!(stream >> key >> score)) continue;
+                if (key != fProfileKey) {
+                    others.push_back(line);
+                    continue;
+                }
+                std::vector<std::string> item;
+                while (stream >> option) item.push_back(option);
+                entries.push_back(std::make_pair(score, item));
+            }
+            sort(entries.begin(), entries.end(), compareMeasure);
+        }
+    
+        void writeProfile(const std::string& profile, const std::vector<std::string>& others)
+        {
+            std::ofstream writer(profile.c_str());
+            for (size_t i = 0; i < others.size(); i++) {
+                writer << others[i] << std::endl;
+            }
+            sort(fMeasures.begin(), fMeasures.end(), compareMeasure);
+            for (size_t i = 0; i < fMeasures.size(); i++) {
+                writer << fProfileKey << " " << fMeasures[i].first;
+                for (size_t j = 0; j < fMeasures[i].second.size(); j++) {
+                    writer << " " << fMeasures[i].second[j];
+                }
+                writer << std::endl;
+            }
+        }
+    
         bool init(const std::string& filename, const std::string input,
                   int argc, const char* argv[],
                   const std::string& target,
@@ -395,6 +506,61 @@ class dsp_optimizer {
             return findOptimizedParametersAux(options_table);
         }
     
+        /**
+         * Returns the best compilations parameters, guided by a profile file.
+         *
+         * When the profile already contains measures for this DSP, only the 'candidates' best
+         * ranked option sets are measured again, otherwise the complete search is done.
+         * The profile is then updated with the new measures.
+         *
+         * @param profile - the profile filename
+         * @param candidates - the number of profiled option sets to measure again
+         *
+         * @return the best result (in Megabytes/seconds), and compilation parameters in a vector.
+         */
+        std::pair<double, std::vector<std::string> > findOptimizedParameters(const std::string& profile, int candidates = 3)
+        {
+            std::vector<std::pair<double, std::vector<std::string> > > entries;
+            std::vector<std::string> others;
+            readProfile(profile, entries, others);
+            fMeasures.clear();
+            
+            std::pair<double, std::vector<std::string> > best;
+            if (entries.size() > 0) {
+                if (fTrace) std::cout << "Measure the " << candidates << " best profiled parameters" << std::endl;
+                std::vector<std::vector <std::string> > options_table;
+                for (int i = 0; i < int(entries.size()); i++) {
+                    if (i < candidates) {
+                        options_table.push_back(entries[i].second);
+                    } else {
+                        // Keep the remaining measures in the profile
+                        fMeasures.push_back(entries[i]);
+                    }
+                }
+                best = findOptimizedParametersAux(options_table);
+            } else {
+                best = findOptimizedParameters();
+            }
+            
+            writeProfile(profile, others);
+            return best;
+        }
+    
+        /**
+         * Profile the DSP before the search : a version compiled with -pgi is run to count how often
+         * each select2 condition is true, the counts are written in 'select_profile', and all measured
+         * option sets are then compiled with '-pgu select_profile', so that well predicted select2 are
+         * compiled with a branch and the other ones without.
+         *
+         * @param select_profile - the select profile filename
+         *
+         * @return true if the select profile has been written.
+         */
+        bool setSelectProfile(const std::string& select_profile)
+        {
+            return collectSelectProfile(select_profile);
+        }
+    
         /**
          * Returns the error (in case on compilation error).
          *
@@ -80,6 +80,15 @@ class interpreter_dsp : public dsp {
         void metadata(Meta* m);
         
         void compute(int count, FAUSTFLOAT** input, FAUSTFLOAT** output);
+        
+        /**
+         * Return the address and size in bytes of a field of the DSP structure (or a null pointer),
+         * to copy the internal state between instances of the same DSP compiled by other backends.
+         */
+        void* getFieldAddress(const std::string& name, int& size);
+        
+        /* Return the names of the DSP structure fields (empty when the factory was not compiled from the DSP source) */
+        std::vector<std::string> getFieldNames();
     
 };
 
@@ -249,6 +258,51 @@ interpreter_dsp_factory* readInterpreterDSPFactoryFromBitcodeFile(const std::str
  */
 void writeInterpreterDSPFactoryToBitcodeFile(interpreter_dsp_factory* factory, const std::string& bitcode_path);
 
+/**
+ * Create a Faust DSP factory from a binary FBC string. The binary format stores already optimized code blocks
+ * with a section table and a checksum, and is much faster to load than the textual bitcode. Note that the library
+ * keeps an internal cache of all allocated factories so that the same binary string will return the same
+ * (reference counted) factory pointer. You will have to explicitly use deleteInterpreterDSPFactory to properly
+ * decrement reference counter when the factory is no more needed.
+ *
+ * @param binary - the binary string
+ * @param error_msg - the error string to be filled
+ *
+ * @return the DSP factory on success, otherwise a null pointer.
+ */
+interpreter_dsp_factory* readInterpreterDSPFactoryFromBinary(const std::string& binary, std::string& error_msg);
+
+/**
+ * Write a Faust DSP factory into a binary FBC string.
+ *
+ * @param factory - the DSP factory
+ *
+ * @return the binary FBC as a string.
+ */
+std::string writeInterpreterDSPFactoryToBinary(interpreter_dsp_factory* factory);
+
+/**
+ * Create a Faust DSP factory from a binary FBC file. Note that the library keeps an internal cache of all
+ * allocated factories so that the same binary file will return the same (reference counted) factory pointer.
+ * You will have to explicitly use deleteInterpreterDSPFactory to properly decrement reference counter when
+ * the factory is no more needed.
+ *
+ * @param binary_path - the binary FBC file pathname
+ * @param error_msg - the error string to be filled
+ *
+ * @return the DSP factory on success, otherwise a null pointer.
+ */
+interpreter_dsp_factory* readInterpreterDSPFactoryFromBinaryFile(const std::string& binary_path, std::string& error_msg);
+
+/**
+ * Write a Faust DSP factory into a binary FBC file.
+ *
+ * @param factory - the DSP factory
+ * @param binary_path - the binary FBC file pathname
+ *
+ */
+void writeInterpreterDSPFactoryToBinaryFile(interpreter_dsp_factory* factory, const std::string& binary_path);
+
 /*!
  @}
  */
@@ -79,6 +79,15 @@ class llvm_dsp : public dsp {
         void metadata(Meta* m);
         
         void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs);
+        
+        /**
+         * Return the address and size in bytes of a field of the DSP structure (or a null pointer),
+         * to copy the internal state between instances of the same DSP compiled by other backends.
+         */
+        void* getFieldAddress(const std::string& name, int& size);
+        
+        /* Return the names of the DSP structure fields (empty when the factory was not compiled from the DSP source) */
+        std::vector<std::string> getFieldNames();
     
 };
 
@@ -109,6 +118,12 @@ class llvm_dsp_factory : public dsp_factory {
         /* Return factory expanded DSP code */
         std::string getDSPCode();
     
+        /* Return the time spent in JIT compilation (IR optimization and code generation) in ms */
+        double getJITTime();
+    
+        /* Return the size of the generated machine code in bytes */
+        int getCodeSize();
+    
         /* Create a new DSP instance, to be deleted with C++ 'delete' */
         llvm_dsp* createDSPInstance();
     
@@ -154,10 +169,13 @@ llvm_dsp_factory* getDSPFactoryFromSHAKey(const std::string& sha_key);
  * @param argv - the array of parameters (Warning : aux files generation options will be filtered (-svg, ...) --> use generateAuxFiles)
  * @param target - the LLVM machine target: like 'i386-apple-macosx10.6.0:opteron',
  *                 using an empty string takes the current machine settings,
- *                 and i386-apple-macosx10.6.0:generic kind of syntax for a generic processor
+ *                 and i386-apple-macosx10.6.0:generic kind of syntax for a generic processor.
+ *                 Target features and the preferred vector width (in bits) of the 'compute' method can be added,
+ *                 like 'x86_64-apple-macosx10.13.0:haswell:+avx2,-avx512f:256'
  * @param error_msg - the error string to be filled
  * @param opt_level - LLVM IR to IR optimization level (from -1 to 4, -1 means 'maximum possible value' 
- * since the maximum value may change with new LLVM versions)
+ * since the maximum value may change with new LLVM versions). 0 and 1 favour JIT compilation time,
+ * 4 and more add auto-vectorization to favour DSP throughput.
  *
  * @return a DSP factory on success, otherwise a null pointer.
  */ 
@@ -179,10 +197,13 @@ llvm_dsp_factory* createDSPFactoryFromFile(const std::string& filename,
  * @param argv - the array of parameters (Warning : aux files generation options will be filtered (-svg, ...) --> use generateAuxFiles)
  * @param target - the LLVM machine target: like 'i386-apple-macosx10.6.0:opteron',
  *                 using an empty string takes the current machine settings,
- *                 and i386-apple-macosx10.6.0:generic kind of syntax for a generic processor
+ *                 and i386-apple-macosx10.6.0:generic kind of syntax for a generic processor.
+ *                 Target features and the preferred vector width (in bits) of the 'compute' method can be added,
+ *                 like 'x86_64-apple-macosx10.13.0:haswell:+avx2,-avx512f:256'
  * @param error_msg - the error string to be filled
  * @param opt_level - LLVM IR to IR optimization level (from -1 to 4, -1 means 'maximum possible value' 
- * since the maximum value may change with new LLVM versions)
+ * since the maximum value may change with new LLVM versions). 0 and 1 favour JIT compilation time,
+ * 4 and more add auto-vectorization to favour DSP throughput.
  *
  * @return a DSP factory on success, otherwise a null pointer.
  */ 
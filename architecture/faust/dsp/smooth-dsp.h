@@ -0,0 +1,325 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __smooth_dsp__
+#define __smooth_dsp__
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/DecoratorUI.h"
+
+/**
+ * Smoothed signal processor : the changes of the designated zones are applied as
+ * ramps, by computing the decorated DSP by sub-blocks and moving the zones between them,
+ * so that the DSP code does not need 'si.smoo' on its parameters.
+ *
+ * Zones are designated with the [smooth:<ms>] (linear ramp) or [smooth:<ms> exp]
+ * (exponential ramp, reaching 99.9% of the change in <ms>) metadata, or with 'setSmoothing'
+ * (for instance with a zone given by APIUI::getParamZone).
+ *
+ * Static parameters only cost a comparison per block, and a block is only cut in
+ * sub-blocks while a parameter is moving. To smooth dated controls, the smooth_dsp has
+ * to be decorated by the timed_dsp: timed_dsp(smooth_dsp(DSP)).
+ */
+
+class smooth_dsp : public decorator_dsp {
+
+    public:
+
+        enum { kLinear = 0, kExponential = 1 };
+
+    protected:
+
+        // Collects the zones with a 'smooth' metadata
+        struct SmoothUI : public GenericUI
+        {
+            smooth_dsp* fSmooth;
+            double fTime;
+            int fType;
+
+            SmoothUI(smooth_dsp* smooth):fSmooth(smooth), fTime(0.), fType(kLinear) {}
+
+            void addZone(FAUSTFLOAT* zone)
+            {
+                if (fTime > 0.) fSmooth->setSmoothing(zone, fTime, fType);
+                fTime = 0.;
+                fType = kLinear;
+            }
+
+            void addButton(const char* label, FAUSTFLOAT* zone) { addZone(zone); }
+            void addCheckButton(const char* label, FAUSTFLOAT* zone) { addZone(zone); }
+            void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+            {
+                addZone(zone);
+            }
+            void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+            {
+                addZone(zone);
+            }
+            void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+            {
+                addZone(zone);
+            }
+            // Bargraphs are written by the DSP
+            void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fTime = 0.; }
+            void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fTime = 0.; }
+
+            void declare(FAUSTFLOAT* zone, const char* key, const char* val)
+            {
+                if (strcmp(key, "smooth") == 0) {
+                    fTime = atof(val);
+                    fType = (strstr(val, "exp")) ? kExponential : kLinear;
+                }
+            }
+        };
+
+        int fSubBlock;
+
+        // Smoothed zones
+        std::vector<FAUSTFLOAT*> fZones;
+        std::vector<double> fTime;          // ramp duration in ms
+        std::vector<int> fType;
+        std::vector<FAUSTFLOAT> fLast;      // last value written in the zone
+        std::vector<int> fSlot;             // index in the moving arrays, or -1
+
+        // Moving zones, in dense arrays updated by vectorizable loops
+        int fMoving;
+        std::vector<int> fMovingZone;
+        std::vector<double> fCurrent;
+        std::vector<double> fTarget;
+        std::vector<double> fIncrement;     // linear ramp step
+        std::vector<double> fCoef;          // exponential ramp coefficient
+        std::vector<int> fSteps;            // remaining sub-blocks
+
+        FAUSTFLOAT** fInputsSlice;
+        FAUSTFLOAT** fOutputsSlice;
+
+        void computeSlice(int offset, int slice, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            if (slice > 0) {
+                for (int chan = 0; chan < fDSP->getNumInputs(); chan++) {
+                    fInputsSlice[chan] = &(inputs[chan][offset]);
+                }
+                for (int chan = 0; chan < fDSP->getNumOutputs(); chan++) {
+                    fOutputsSlice[chan] = &(outputs[chan][offset]);
+                }
+                fDSP->compute(slice, fInputsSlice, fOutputsSlice);
+            }
+        }
+
+        // Start (or restart) the ramp of zone 'i' from its current value to 'target'
+        void startRamp(int i, FAUSTFLOAT target)
+        {
+            int slot = fSlot[i];
+            if (slot < 0) {
+                slot = fSlot[i] = fMoving++;
+                fMovingZone[slot] = i;
+                fCurrent[slot] = double(fLast[i]);
+            }
+            int steps = std::max(1, int(fTime[i] * 0.001 * double(getSampleRate()) / double(fSubBlock) + 0.5));
+            fTarget[slot] = double(target);
+            fSteps[slot] = steps;
+            if (fType[i] == kExponential) {
+                fIncrement[slot] = 0.;
+                fCoef[slot] = 1. - pow(0.001, 1. / double(steps));
+            } else {
+                fIncrement[slot] = (fTarget[slot] - fCurrent[slot]) / double(steps);
+                fCoef[slot] = 0.;
+            }
+            // Restore the current value, the zone will be moved by 'step'
+            *fZones[i] = fLast[i];
+        }
+
+        // Look for new values written in the smoothed zones since the last block
+        void checkZones()
+        {
+            for (size_t i = 0; i < fZones.size(); i++) {
+                FAUSTFLOAT v = *fZones[i];
+                if (v != fLast[i]) startRamp(int(i), v);
+            }
+        }
+
+        // Move all moving zones by one sub-block
+        void step()
+        {
+            // A value written during the previous sub-block (re)starts its ramp from the current value,
+            // otherwise the DSP would run on the raw new value until the end of the block
+            checkZones();
+            for (int j = 0; j < fMoving; j++) {
+                fCurrent[j] += fIncrement[j] + fCoef[j] * (fTarget[j] - fCurrent[j]);
+            }
+            for (int j = 0; j < fMoving; j++) {
+                if (--fSteps[j] == 0) fCurrent[j] = fTarget[j];
+            }
+            for (int j = 0; j < fMoving; j++) {
+                int i = fMovingZone[j];
+                // A value written since 'checkZones' is not overwritten, it is handled at the next sub-block
+                if (*fZones[i] == fLast[i]) {
+                    fLast[i] = *fZones[i] = FAUSTFLOAT(fCurrent[j]);
+                }
+            }
+        }
+
+        // Remove the zones that reached their target
+        void compact()
+        {
+            int k = 0;
+            for (int j = 0; j < fMoving; j++) {
+                int i = fMovingZone[j];
+                if (fSteps[j] > 0) {
+                    fMovingZone[k] = i;
+                    fCurrent[k] = fCurrent[j];
+                    fTarget[k] = fTarget[j];
+                    fIncrement[k] = fIncrement[j];
+                    fCoef[k] = fCoef[j];
+                    fSteps[k] = fSteps[j];
+                    fSlot[i] = k++;
+                } else {
+                    fSlot[i] = -1;
+                }
+            }
+            fMoving = k;
+        }
+
+        // Forget the ramps, the zones values are the new reference
+        void resync()
+        {
+            for (size_t i = 0; i < fZones.size(); i++) {
+                fLast[i] = *fZones[i];
+                fSlot[i] = -1;
+            }
+            fMoving = 0;
+        }
+
+    public:
+
+        /**
+         * Create a smoothed DSP.
+         *
+         * @param dsp - the decorated DSP
+         * @param sub_block - the number of frames between two zones updates while moving
+         */
+        smooth_dsp(dsp* dsp, int sub_block = 32):decorator_dsp(dsp), fSubBlock(std::max(1, sub_block)), fMoving(0)
+        {
+            fInputsSlice = new FAUSTFLOAT*[dsp->getNumInputs()];
+            fOutputsSlice = new FAUSTFLOAT*[dsp->getNumOutputs()];
+            SmoothUI smooth_ui(this);
+            fDSP->buildUserInterface(&smooth_ui);
+        }
+        virtual ~smooth_dsp()
+        {
+            delete [] fInputsSlice;
+            delete [] fOutputsSlice;
+        }
+
+        /**
+         * Smooth the changes of a zone (to be called before the audio is started).
+         *
+         * @param zone - the zone of a parameter of the decorated DSP
+         * @param time_ms - the ramp duration in ms, 0 to stop smoothing the zone
+         * @param type - kLinear or kExponential
+         */
+        void setSmoothing(FAUSTFLOAT* zone, double time_ms, int type = kLinear)
+        {
+            std::vector<FAUSTFLOAT*>::iterator it = std::find(fZones.begin(), fZones.end(), zone);
+            if (it != fZones.end()) {
+                size_t i = it - fZones.begin();
+                if (time_ms > 0.) {
+                    fTime[i] = time_ms;
+                    fType[i] = type;
+                    return;
+                }
+                fZones.erase(it);
+                fTime.erase(fTime.begin() + i);
+                fType.erase(fType.begin() + i);
+                fLast.erase(fLast.begin() + i);
+                fSlot.erase(fSlot.begin() + i);
+            } else if (time_ms > 0.) {
+                fZones.push_back(zone);
+                fTime.push_back(time_ms);
+                fType.push_back(type);
+                fLast.push_back(*zone);
+                fSlot.push_back(-1);
+            }
+            // The moving arrays are allocated here, never in 'compute'
+            fMovingZone.resize(fZones.size());
+            fCurrent.resize(fZones.size());
+            fTarget.resize(fZones.size());
+            fIncrement.resize(fZones.size());
+            fCoef.resize(fZones.size());
+            fSteps.resize(fZones.size());
+            resync();
+        }
+
+        virtual smooth_dsp* clone()
+        {
+            return new smooth_dsp(fDSP->clone(), fSubBlock);
+        }
+
+        virtual void init(int sample_rate)
+        {
+            fDSP->init(sample_rate);
+            resync();
+        }
+        virtual void instanceInit(int sample_rate)
+        {
+            fDSP->instanceInit(sample_rate);
+            resync();
+        }
+        virtual void instanceResetUserInterface()
+        {
+            fDSP->instanceResetUserInterface();
+            resync();
+        }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            checkZones();
+            if (fMoving == 0) {
+                fDSP->compute(count, inputs, outputs);
+                return;
+            }
+            int offset = 0;
+            while (offset < count && fMoving > 0) {
+                int slice = std::min(fSubBlock, count - offset);
+                step();
+                computeSlice(offset, slice, inputs, outputs);
+                offset += slice;
+                compact();
+            }
+            computeSlice(offset, count - offset, inputs, outputs);
+        }
+
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            compute(count, inputs, outputs);
+        }
+
+};
+
+#endif
@@ -0,0 +1,353 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __tiered_dsp__
+#define __tiered_dsp__
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/DecoratorUI.h"
+
+/**
+ * Collects the controller zones of a DSP in declaration order, so that
+ * two DSP compiled from the same source can be connected zone by zone.
+ */
+struct ZoneCollectorUI : public GenericUI {
+
+    std::vector<FAUSTFLOAT*> fInputZones;
+    std::vector<FAUSTFLOAT*> fOutputZones;
+    std::vector<Soundfile**> fSoundfileZones;
+
+    void addButton(const char* label, FAUSTFLOAT* zone) { fInputZones.push_back(zone); }
+    void addCheckButton(const char* label, FAUSTFLOAT* zone) { fInputZones.push_back(zone); }
+    void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+    {
+        fInputZones.push_back(zone);
+    }
+    void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+    {
+        fInputZones.push_back(zone);
+    }
+    void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+    {
+        fInputZones.push_back(zone);
+    }
+
+    void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fOutputZones.push_back(zone); }
+    void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max) { fOutputZones.push_back(zone); }
+
+    void addSoundfile(const char* label, const char* soundpath, Soundfile** sf_zone) { fSoundfileZones.push_back(sf_zone); }
+
+};
+
+/**
+ * A part of the internal state, copied from the first DSP to the fast one.
+ */
+struct state_block {
+    void* fFrom;
+    void* fTo;
+    size_t fSize;
+};
+
+/**
+ * Tiered DSP: starts processing with an immediately available DSP (typically an interpreter one),
+ * while a faster version of the same DSP (typically LLVM JIT compiled) is built elsewhere and given with 'setFastDSP'.
+ *
+ * When the internal state of the first DSP can be copied in the fast one (see 'state_block'), the fast DSP
+ * directly replaces the first one. Otherwise it is first run in parallel on the same inputs during 'warmup' frames
+ * (so that delay lines and recursive filters reach the same state), then a linear crossfade of 'fade' frames
+ * is done at the output, and only the fast DSP is used afterwards.
+ * The controllers of the first DSP stay the ones seen by the UI and are copied to the fast DSP at each block.
+ *
+ * The swap is done in 'compute', with no memory allocation in the audio thread. Once the swap has started,
+ * the 'init' methods are applied to the first DSP by the calling thread, and to the fast DSP by the next 'compute'.
+ */
+class tiered_dsp : public dsp {
+
+    private:
+
+        enum { kCompiling, kReady, kWarmup, kFast, kFailed };
+    
+        enum { kInit = 1, kInstanceInit = 2, kInstanceConstants = 4, kInstanceClear = 8 };
+
+        static const int kMaxBlock = 1024;
+
+        dsp* fFirstDSP;
+        dsp* fFastDSP;
+
+        std::function<void()> fRelease;
+        std::atomic<int> fState;
+        std::atomic<int> fSampleRate;
+    
+        // 'init' methods to be applied to the fast DSP by the audio thread
+        std::atomic<int> fPending;
+        std::atomic<int> fPendingSampleRate;
+
+        int fWarmup;
+        int fFade;
+        int fFrame;  // frames since the beginning of the warmup
+
+        ZoneCollectorUI fFirstZones;
+        ZoneCollectorUI fFastZones;
+    
+        std::vector<state_block> fStateBlocks;
+
+        // Inputs copy (input and output buffers may be the same) and fast DSP outputs during the transition
+        std::vector<std::vector<FAUSTFLOAT> > fInputBuffers;
+        std::vector<std::vector<FAUSTFLOAT> > fOutputBuffers;
+        std::vector<FAUSTFLOAT*> fInputs;
+        std::vector<FAUSTFLOAT*> fOutputs;
+        std::vector<FAUSTFLOAT*> fFirstOutputs;
+
+        void copyControls()
+        {
+            for (size_t i = 0; i < fFirstZones.fInputZones.size(); i++) {
+                *fFastZones.fInputZones[i] = *fFirstZones.fInputZones[i];
+            }
+            for (size_t i = 0; i < fFirstZones.fSoundfileZones.size(); i++) {
+                *fFastZones.fSoundfileZones[i] = *fFirstZones.fSoundfileZones[i];
+            }
+        }
+
+        void copyOutputControls()
+        {
+            for (size_t i = 0; i < fFirstZones.fOutputZones.size(); i++) {
+                *fFirstZones.fOutputZones[i] = *fFastZones.fOutputZones[i];
+            }
+        }
+    
+        void setPending(int method, int samplingRate)
+        {
+            fPendingSampleRate.store(samplingRate, std::memory_order_relaxed);
+            fPending.fetch_or(method, std::memory_order_release);
+        }
+    
+        void applyPending()
+        {
+            int pending = fPending.exchange(0, std::memory_order_acquire);
+            if (pending == 0) return;
+            int sample_rate = fPendingSampleRate.load(std::memory_order_relaxed);
+            if (pending & kInit) {
+                fFastDSP->init(sample_rate);
+            } else if (pending & kInstanceInit) {
+                fFastDSP->instanceInit(sample_rate);
+            } else {
+                if (pending & kInstanceConstants) fFastDSP->instanceConstants(sample_rate);
+                if (pending & kInstanceClear) fFastDSP->instanceClear();
+            }
+        }
+
+        int startSwap()
+        {
+            // The state copy or the warmup replaces the pending 'init' calls
+            fPending.store(0, std::memory_order_relaxed);
+            
+            // 'init' may have been called with another sample rate after the fast DSP was initialized
+            if (fFastDSP->getSampleRate() != fFirstDSP->getSampleRate()) {
+                fFastDSP->init(fFirstDSP->getSampleRate());
+            }
+            
+            if (fStateBlocks.size() > 0) {
+                for (size_t i = 0; i < fStateBlocks.size(); i++) {
+                    memcpy(fStateBlocks[i].fTo, fStateBlocks[i].fFrom, fStateBlocks[i].fSize);
+                }
+                fState.store(kFast, std::memory_order_release);
+                return kFast;
+            } else {
+                fFrame = 0;
+                fState.store(kWarmup, std::memory_order_release);
+                return kWarmup;
+            }
+        }
+
+        void computeTransition(int count, int offset, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (size_t chan = 0; chan < fInputs.size(); chan++) {
+                memcpy(fInputBuffers[chan].data(), inputs[chan] + offset, sizeof(FAUSTFLOAT) * count);
+                fInputs[chan] = fInputBuffers[chan].data();
+            }
+            for (size_t chan = 0; chan < fOutputs.size(); chan++) {
+                fFirstOutputs[chan] = outputs[chan] + offset;
+                fOutputs[chan] = fOutputBuffers[chan].data();
+            }
+
+            fFirstDSP->compute(count, fInputs.data(), fFirstOutputs.data());
+            fFastDSP->compute(count, fInputs.data(), fOutputs.data());
+
+            // Output the first DSP during the warmup, then crossfade
+            for (int frame = 0; frame < count; frame++, fFrame++) {
+                if (fFrame < fWarmup) continue;
+                FAUSTFLOAT gain = (fFrame < fWarmup + fFade) ? FAUSTFLOAT(fFrame - fWarmup) / FAUSTFLOAT(fFade) : FAUSTFLOAT(1);
+                for (size_t chan = 0; chan < fOutputs.size(); chan++) {
+                    fFirstOutputs[chan][frame] += gain * (fOutputs[chan][frame] - fFirstOutputs[chan][frame]);
+                }
+            }
+        }
+
+    public:
+
+        /**
+         * Create a tiered DSP.
+         *
+         * @param first_dsp - the DSP used until the fast one is ready, owned by the tiered DSP
+         * @param release - called at destruction time after the DSP have been deleted (to delete their factories...)
+         * @param warmup - the number of frames the fast DSP runs in parallel before being heard, without state copy
+         * @param fade - the number of frames of the crossfade, without state copy
+         */
+        tiered_dsp(dsp* first_dsp,
+                   std::function<void()> release = nullptr,
+                   int warmup = 4096,
+                   int fade = 512)
+        :fFirstDSP(first_dsp), fFastDSP(nullptr), fRelease(release),
+        fState(kCompiling), fSampleRate(44100), fPending(0), fPendingSampleRate(44100),
+        fWarmup(warmup), fFade(std::max(fade, 1)), fFrame(0)
+        {
+            fFirstDSP->buildUserInterface(&fFirstZones);
+        }
+
+        virtual ~tiered_dsp()
+        {
+            delete fFirstDSP;
+            delete fFastDSP;
+            if (fRelease) fRelease();
+        }
+    
+        /**
+         * Give the fast DSP, to be called once from a non real-time thread.
+         *
+         * @param fast_dsp - the fast DSP, owned by the tiered DSP (deleted if it does not match the first one)
+         * @param state - the parts of the internal state of the first DSP to be copied in the fast one,
+         * possibly empty to use the warmup and crossfade
+         *
+         * @return true if the fast DSP will be used.
+         */
+        bool setFastDSP(dsp* fast_dsp, const std::vector<state_block>& state = std::vector<state_block>())
+        {
+            fast_dsp->buildUserInterface(&fFastZones);
+            if (fast_dsp->getNumInputs() != fFirstDSP->getNumInputs()
+                || fast_dsp->getNumOutputs() != fFirstDSP->getNumOutputs()
+                || fFastZones.fInputZones.size() != fFirstZones.fInputZones.size()
+                || fFastZones.fOutputZones.size() != fFirstZones.fOutputZones.size()
+                || fFastZones.fSoundfileZones.size() != fFirstZones.fSoundfileZones.size()) {
+                std::cerr << "tiered_dsp : fast DSP does not match the first one" << std::endl;
+                delete fast_dsp;
+                setFailed();
+                return false;
+            }
+
+            fast_dsp->init(fSampleRate);
+
+            fInputBuffers.resize(fast_dsp->getNumInputs(), std::vector<FAUSTFLOAT>(kMaxBlock));
+            fOutputBuffers.resize(fast_dsp->getNumOutputs(), std::vector<FAUSTFLOAT>(kMaxBlock));
+            fInputs.resize(fast_dsp->getNumInputs());
+            fOutputs.resize(fast_dsp->getNumOutputs());
+            fFirstOutputs.resize(fast_dsp->getNumOutputs());
+            fStateBlocks = state;
+
+            fFastDSP = fast_dsp;
+            fState.store(kReady, std::memory_order_release);
+            return true;
+        }
+    
+        // To be called when the fast DSP cannot be built
+        void setFailed() { fState.store(kFailed, std::memory_order_release); }
+
+        // Whether the fast DSP is the only one running
+        bool isFast() { return fState.load(std::memory_order_acquire) == kFast; }
+
+        // Whether the fast DSP could not be built
+        bool isFailed() { return fState.load(std::memory_order_acquire) == kFailed; }
+
+        virtual int getNumInputs() { return fFirstDSP->getNumInputs(); }
+        virtual int getNumOutputs() { return fFirstDSP->getNumOutputs(); }
+        virtual void buildUserInterface(UI* ui_interface) { fFirstDSP->buildUserInterface(ui_interface); }
+        virtual int getSampleRate() { return fFirstDSP->getSampleRate(); }
+
+        virtual void init(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fFirstDSP->init(samplingRate);
+            setPending(kInit, samplingRate);
+        }
+        virtual void instanceInit(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fFirstDSP->instanceInit(samplingRate);
+            setPending(kInstanceInit, samplingRate);
+        }
+        virtual void instanceConstants(int samplingRate)
+        {
+            fSampleRate = samplingRate;
+            fFirstDSP->instanceConstants(samplingRate);
+            setPending(kInstanceConstants, samplingRate);
+        }
+        virtual void instanceResetUserInterface() { fFirstDSP->instanceResetUserInterface(); }
+        virtual void instanceClear()
+        {
+            fFirstDSP->instanceClear();
+            setPending(kInstanceClear, fSampleRate);
+        }
+
+        // The clone is the currently running DSP, without tiering
+        virtual dsp* clone() { return (isFast()) ? fFastDSP->clone() : fFirstDSP->clone(); }
+
+        virtual void metadata(Meta* m) { fFirstDSP->metadata(m); }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            int state = fState.load(std::memory_order_acquire);
+            if (state == kReady) {
+                state = startSwap();
+            } else if (state == kWarmup || state == kFast) {
+                applyPending();
+            }
+
+            if (state == kFast) {
+                copyControls();
+                fFastDSP->compute(count, inputs, outputs);
+                copyOutputControls();
+            } else if (state == kWarmup) {
+                copyControls();
+                for (int offset = 0; offset < count; offset += kMaxBlock) {
+                    computeTransition(std::min(kMaxBlock, count - offset), offset, inputs, outputs);
+                }
+                if (fFrame >= fWarmup + fFade) {
+                    fState.store(kFast, std::memory_order_release);
+                }
+            } else {
+                fFirstDSP->compute(count, inputs, outputs);
+            }
+        }
+
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) { compute(count, inputs, outputs); }
+
+};
+
+#endif
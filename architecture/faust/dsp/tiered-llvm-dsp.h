@@ -0,0 +1,234 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __tiered_llvm_dsp__
+#define __tiered_llvm_dsp__
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "faust/dsp/interpreter-dsp.h"
+#include "faust/dsp/llvm-dsp.h"
+#include "faust/dsp/libfaust.h"
+#include "faust/dsp/tiered-dsp.h"
+
+/**
+ * Tiered DSP running the interpreter DSP until the LLVM DSP compiled by the asynchronous
+ * compilation service (see submitDSPCompilation) is ready. The internal state is copied from
+ * the interpreter heaps to the LLVM DSP structure, field by field.
+ */
+class tiered_llvm_dsp : public tiered_dsp {
+
+    private:
+    
+        // Shared with the compilation callback, which may be called after the DSP is deleted
+        struct link {
+            std::mutex fMutex;
+            tiered_llvm_dsp* fDSP;
+            interpreter_dsp* fFirstDSP;
+            interpreter_dsp_factory* fInterpFactory;
+            llvm_dsp_factory* fLLVMFactory;
+            std::shared_ptr<dsp_compile_handle> fHandle;
+            
+            link(interpreter_dsp* first_dsp, interpreter_dsp_factory* factory)
+            :fDSP(nullptr), fFirstDSP(first_dsp), fInterpFactory(factory), fLLVMFactory(nullptr)
+            {}
+            
+            // Called once the compilation is finished, on the compilation thread or the creation one
+            void finish()
+            {
+                std::lock_guard<std::mutex> lock(fMutex);
+                if (!fHandle) return;
+                // Also breaks the cycle between the handle and this callback
+                std::shared_ptr<dsp_compile_handle> handle = fHandle;
+                fHandle = nullptr;
+                if (!fDSP) return;
+                
+                if (handle->getState() != kCompileDone) {
+                    std::cerr << "tiered_llvm_dsp : " << handle->getErrorMessage();
+                    fDSP->setFailed();
+                    return;
+                }
+                
+                // A reference of its own, the handle factory may be shared with other identical compilations
+                fLLVMFactory = getDSPFactoryFromSHAKey(handle->getFactory()->getSHAKey());
+                llvm_dsp* fast_dsp = (fLLVMFactory) ? fLLVMFactory->createDSPInstance() : nullptr;
+                if (!fast_dsp) {
+                    fDSP->setFailed();
+                    return;
+                }
+                std::vector<state_block> state;
+                mapState(fFirstDSP, fast_dsp, state);
+                fDSP->setFastDSP(fast_dsp, state);
+            }
+            
+            // Release the factories, once the DSP are deleted
+            void release()
+            {
+                if (fLLVMFactory) deleteDSPFactory(fLLVMFactory);
+                deleteInterpreterDSPFactory(fInterpFactory);
+            }
+        };
+    
+        std::shared_ptr<link> fLink;
+    
+        // All fields of the LLVM DSP structure have to be found with the same size in the interpreter heaps
+        static void mapState(interpreter_dsp* first_dsp, llvm_dsp* fast_dsp, std::vector<state_block>& state)
+        {
+            std::vector<std::string> names = fast_dsp->getFieldNames();
+            for (size_t i = 0; i < names.size(); i++) {
+                int first_size = 0, fast_size = 0;
+                void* first_field = first_dsp->getFieldAddress(names[i], first_size);
+                void* fast_field = fast_dsp->getFieldAddress(names[i], fast_size);
+                if (!first_field || !fast_field || first_size != fast_size) {
+                    state.clear();
+                    return;
+                }
+                state_block block = { first_field, fast_field, size_t(fast_size) };
+                state.push_back(block);
+            }
+        }
+    
+        tiered_llvm_dsp(std::shared_ptr<link> link, int warmup, int fade)
+        :tiered_dsp(link->fFirstDSP, [link]() { link->release(); }, warmup, fade), fLink(link)
+        {}
+    
+    public:
+    
+        virtual ~tiered_llvm_dsp()
+        {
+            std::shared_ptr<dsp_compile_handle> handle;
+            {
+                std::lock_guard<std::mutex> lock(fLink->fMutex);
+                fLink->fDSP = nullptr;
+                handle = fLink->fHandle;
+                fLink->fHandle = nullptr;
+            }
+            // A running compilation is stopped at its next stage (outside the lock, since it calls 'finish')
+            if (handle) handle->cancel();
+        }
+    
+        friend tiered_llvm_dsp* createTieredDSPFromString(const std::string& name_app,
+                                                          const std::string& dsp_content,
+                                                          int argc, const char* argv[],
+                                                          const std::string& target,
+                                                          std::string& error_msg,
+                                                          int opt_level,
+                                                          int warmup,
+                                                          int fade);
+    
+};
+
+/**
+ * Create a tiered DSP from a DSP source code as a string : an interpreter DSP is created
+ * and can be used immediately, and the LLVM DSP is compiled by the asynchronous compilation
+ * service (see submitDSPCompilation), then replaces the interpreter one (see tiered_dsp).
+ *
+ * @param name_app - the name of the Faust program
+ * @param dsp_content - the Faust program as a string
+ * @param argc - the number of parameters in argv array
+ * @param argv - the array of parameters
+ * @param target - the LLVM machine target (using empty string will take current machine settings)
+ * @param error_msg - the error string to be filled
+ * @param opt_level - LLVM IR to IR optimization level (from -1 to 4, -1 means 'maximum possible value'
+ * since the maximum value may change with new LLVM versions)
+ * @param warmup - the number of frames the LLVM DSP runs in parallel before being heard, when the state cannot be copied
+ * @param fade - the number of frames of the crossfade, when the state cannot be copied
+ *
+ * @return a tiered DSP on success (the interpreter DSP could be created), otherwise a null pointer.
+ */
+inline tiered_llvm_dsp* createTieredDSPFromString(const std::string& name_app,
+                                                  const std::string& dsp_content,
+                                                  int argc, const char* argv[],
+                                                  const std::string& target,
+                                                  std::string& error_msg,
+                                                  int opt_level = -1,
+                                                  int warmup = 4096,
+                                                  int fade = 512)
+{
+    interpreter_dsp_factory* interp_factory = createInterpreterDSPFactoryFromString(name_app, dsp_content, argc, argv, error_msg);
+    if (!interp_factory) return nullptr;
+
+    interpreter_dsp* interp_dsp = interp_factory->createDSPInstance();
+    if (!interp_dsp) {
+        deleteInterpreterDSPFactory(interp_factory);
+        return nullptr;
+    }
+
+    std::shared_ptr<tiered_llvm_dsp::link> link = std::make_shared<tiered_llvm_dsp::link>(interp_dsp, interp_factory);
+    tiered_llvm_dsp* tiered = new tiered_llvm_dsp(link, warmup, fade);
+
+    // The reference of the compiled factory is kept by the compilation handle, and released with it
+    std::shared_ptr<llvm_dsp_factory> compiled;
+    auto compile = [=](const std::string& name, const std::string& content, int argc1, const char* argv1[], std::string& llvm_error_msg) mutable -> dsp_factory* {
+        llvm_dsp_factory* factory = createDSPFactoryFromString(name, content, argc1, argv1, target, llvm_error_msg, opt_level);
+        compiled.reset(factory, [](llvm_dsp_factory* factory) { if (factory) deleteDSPFactory(factory); });
+        return factory;
+    };
+    
+    auto progress = [link](const std::string& stage, float value) {
+        if (stage == "done" || stage == "failed" || stage == "cancelled") link->finish();
+    };
+
+    std::shared_ptr<dsp_compile_handle> handle;
+    {
+        // The callback waits for the handle to be known
+        std::lock_guard<std::mutex> lock(link->fMutex);
+        link->fDSP = tiered;
+        handle = link->fHandle = submitDSPCompilation(name_app, dsp_content, argc, argv,
+                                                      "llvm " + target + " " + std::to_string(opt_level),
+                                                      compile, 0, progress);
+    }
+    // An identical compilation may have been finished before the callback was added
+    if (handle->getState() >= kCompileDone) link->finish();
+    return tiered;
+}
+
+/**
+ * Create a tiered DSP from a DSP source code as a file (see createTieredDSPFromString).
+ *
+ * @return a tiered DSP on success (the interpreter DSP could be created), otherwise a null pointer.
+ */
+inline tiered_llvm_dsp* createTieredDSPFromFile(const std::string& filename,
+                                                int argc, const char* argv[],
+                                                const std::string& target,
+                                                std::string& error_msg,
+                                                int opt_level = -1,
+                                                int warmup = 4096,
+                                                int fade = 512)
+{
+    std::ifstream reader(filename.c_str());
+    if (!reader.is_open()) {
+        error_msg = "ERROR : unable to open file " + filename + "\n";
+        return nullptr;
+    }
+    std::stringstream content;
+    content << reader.rdbuf();
+    std::string base = filename.substr(filename.find_last_of('/') + 1);
+    std::string name_app = base.substr(0, base.find_last_of('.'));
+    return createTieredDSPFromString(name_app, content.str(), argc, argv, target, error_msg, opt_level, warmup, fade);
+}
+
+#endif
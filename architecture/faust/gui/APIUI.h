@@ -33,6 +33,7 @@
 #include "faust/gui/meta.h"
 #include "faust/gui/UI.h"
 #include "faust/gui/PathBuilder.h"
+#include "faust/gui/PathTable.h"
 #include "faust/gui/ValueConverter.h"
 
 class APIUI : public PathBuilder, public Meta, public UI
@@ -50,6 +51,8 @@ class APIUI : public PathBuilder, public Meta, public UI
         std::vector<std::string> fLabels;
         std::map<std::string, int> fPathMap;
         std::map<std::string, int> fLabelMap;
+        PathTable fPathTable;
+        PathTable fLabelTable;
         std::vector<ValueConverter*> fConversion;
         std::vector<FAUSTFLOAT*> fZone;
         std::vector<FAUSTFLOAT> fInit;
@@ -87,6 +90,8 @@ class APIUI : public PathBuilder, public Meta, public UI
                                 ItemType type)
         {
             std::string path = buildPath(label);
+            fPathTable.add(path, fNumParameters);
+            fLabelTable.add(label, fNumParameters);
             fPathMap[path] = fLabelMap[label] = fNumParameters++;
             fPaths.push_back(path);
             fLabels.push_back(label);
@@ -96,6 +101,8 @@ class APIUI : public PathBuilder, public Meta, public UI
             fMax.push_back(max);
             fStep.push_back(step);
             fItemType.push_back(type);
+            // Item outside of any box
+            if (fControlsLevel.empty()) buildIndex();
             
             // handle scale metadata
             switch (fCurrentScale) {
@@ -273,7 +280,12 @@ class APIUI : public PathBuilder, public Meta, public UI
         virtual void openTabBox(const char* label)          { fControlsLevel.push_back(label); }
         virtual void openHorizontalBox(const char* label)   { fControlsLevel.push_back(label); }
         virtual void openVerticalBox(const char* label)     { fControlsLevel.push_back(label); }
-        virtual void closeBox()                             { fControlsLevel.pop_back(); }
+        virtual void closeBox()
+        {
+            fControlsLevel.pop_back();
+            // The UI is complete
+            if (fControlsLevel.empty()) buildIndex();
+        }
 
         // -- active widgets
 
@@ -353,15 +365,17 @@ class APIUI : public PathBuilder, public Meta, public UI
 		// Simple API part
 		//-------------------------------------------------------------------------------
 		int getParamsCount() { return fNumParameters; }
+        // Build the path and label lookup tables (allocates memory): called when the UI is complete
+        void buildIndex()
+        {
+            fPathTable.build();
+            fLabelTable.build();
+        }
+        // The index is a stable handle for the other methods: resolve it once, outside of the audio thread
         int getParamIndex(const char* path)
         {
-            if (fPathMap.find(path) != fPathMap.end()) {
-                return fPathMap[path];
-            } else if (fLabelMap.find(path) != fLabelMap.end()) {
-                return fLabelMap[path];
-            } else {
-                return -1;
-            }
+            int p = fPathTable.find(path);
+            return (p >= 0) ? p : fLabelTable.find(path);
         }
         const char* getParamAddress(int p) { return fPaths[p].c_str(); }
         const char* getParamLabel(int p) { return fLabels[p].c_str(); }
@@ -389,6 +403,20 @@ class APIUI : public PathBuilder, public Meta, public UI
         FAUSTFLOAT getParamValue(int p) { return *fZone[p]; }
         void setParamValue(int p, FAUSTFLOAT v) { *fZone[p] = v; }
 
+        // Bulk access, usable in the audio thread (negative indexes are ignored)
+        void getParamValues(const int* params, FAUSTFLOAT* values, int count)
+        {
+            for (int i = 0; i < count; i++) {
+                values[i] = (params[i] >= 0) ? *fZone[params[i]] : FAUSTFLOAT(0);
+            }
+        }
+        void setParamValues(const int* params, const FAUSTFLOAT* values, int count)
+        {
+            for (int i = 0; i < count; i++) {
+                if (params[i] >= 0) *fZone[params[i]] = values[i];
+            }
+        }
+
         double getParamRatio(int p) { return fConversion[p]->faust2ui(*fZone[p]); }
         void setParamRatio(int p, double r) { *fZone[p] = fConversion[p]->ui2faust(r); }
 
@@ -0,0 +1,350 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef __ControlBus__
+#define __ControlBus__
+
+#include <float.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/gui/GUI.h"
+#include "faust/gui/DecoratorUI.h"
+#include "faust/gui/ring-buffer.h"
+
+/**
+ * ControlBus : delivers the control changes of the GUIs (OSC, HTTP, MIDI...) to the audio thread.
+ *
+ * - each connected GUI gets its own single producer/single consumer queue, where its
+ *   uiItem::modifyZone calls push (zone index, value, date) messages without any allocation
+ * - the audio thread (see controlbus_dsp) reads the queues at the beginning of each block and
+ *   writes the zones, either immediately or at the frame given by the message date
+ * - the zones written by the audio thread (and the bargraphs that changed during the block) are
+ *   marked in a bitset, so that updateAllGuis only reflects the changed zones
+ *
+ * The GUIs have to be connected before the audio is started, and the bus has to outlive them.
+ */
+
+class ControlBus : public GenericUI
+{
+
+    public:
+
+        struct Control {
+            int fIndex;
+            FAUSTFLOAT fValue;
+            double fDate;
+        };
+
+    private:
+
+        // The queue of one producer thread
+        struct Sender : public ControlSender {
+
+            ControlBus* fBus;
+            ringbuffer_t* fQueue;
+            std::atomic<int> fDropped;      // incremented by the producer, read by any thread
+
+            Sender(ControlBus* bus, int size):fBus(bus), fDropped(0)
+            {
+                fQueue = ringbuffer_create(size * sizeof(Control));
+            }
+            virtual ~Sender()
+            {
+                ringbuffer_free(fQueue);
+            }
+
+            virtual bool send(FAUSTFLOAT* zone, FAUSTFLOAT value, double date = 0.)
+            {
+                std::map<FAUSTFLOAT*, int>::const_iterator it = fBus->fIndex.find(zone);
+                if (it == fBus->fIndex.end()) return false;
+                if (ringbuffer_write_space(fQueue) < sizeof(Control)) {
+                    fDropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                Control control = { it->second, value, date };
+                ringbuffer_write(fQueue, (const char*)&control, sizeof(Control));
+                return true;
+            }
+        };
+
+        std::vector<FAUSTFLOAT*> fZones;
+        std::map<FAUSTFLOAT*, int> fIndex;
+        std::vector<int> fPassive;                  // indexes of the bargraphs
+        std::vector<FAUSTFLOAT> fPassiveValues;     // and their values at the end of the previous block
+        std::vector<Sender*> fSenders;
+        std::vector<Control> fDated;                // controls waiting for their date (audio thread only)
+        std::atomic<uint32_t>* fChanged;            // changed zones bitset
+        std::vector<FAUSTFLOAT*> fChangedZones;
+        int fQueueSize;
+
+        void addZone(FAUSTFLOAT* zone, bool passive)
+        {
+            if (fIndex.find(zone) != fIndex.end()) return;
+            fIndex[zone] = int(fZones.size());
+            if (passive) {
+                fPassive.push_back(int(fZones.size()));
+                fPassiveValues.push_back(*zone);
+            }
+            fZones.push_back(zone);
+        }
+
+        void setChanged(int index)
+        {
+            fChanged[index >> 5].fetch_or(uint32_t(1) << (index & 31), std::memory_order_release);
+        }
+
+    public:
+
+        /**
+         * Create a bus for the zones of a DSP.
+         *
+         * @param DSP - the DSP whose zones are controlled
+         * @param queue_size - the number of controls each GUI can send during a block
+         * @param dated_size - the maximum number of dated controls waiting to be applied
+         */
+        ControlBus(dsp* DSP, int queue_size = 1024, int dated_size = 1024):fQueueSize(queue_size)
+        {
+            DSP->buildUserInterface(this);
+            int words = int(fZones.size() + 31) / 32;
+            fChanged = new std::atomic<uint32_t>[words];
+            for (int i = 0; i < words; i++) fChanged[i] = 0;
+            fChangedZones.resize(fZones.size());
+            fDated.reserve(dated_size);
+        }
+
+        virtual ~ControlBus()
+        {
+            for (size_t i = 0; i < fSenders.size(); i++) {
+                delete fSenders[i];
+            }
+            delete [] fChanged;
+        }
+
+        // Create the queue of a new producer, has to be called before the audio is started
+        ControlSender* createSender()
+        {
+            Sender* sender = new Sender(this, fQueueSize);
+            fSenders.push_back(sender);
+            return sender;
+        }
+
+        // Deliver the zone changes of a GUI through the bus
+        void connect(GUI* gui) { gui->setControlSender(createSender()); }
+
+        // Number of controls dropped because a queue was full (then directly written in the zone)
+        int getDropped()
+        {
+            int dropped = 0;
+            for (size_t i = 0; i < fSenders.size(); i++) {
+                dropped += fSenders[i]->fDropped.load(std::memory_order_relaxed);
+            }
+            return dropped;
+        }
+
+        // -- audio thread
+
+        /**
+         * Read the queues : the controls dated before 'date' are applied, the other
+         * ones are kept until they are returned by nextControl.
+         */
+        void receive(double date = DBL_MAX)
+        {
+            size_t j = 0;
+            for (size_t i = 0; i < fDated.size(); i++) {
+                if (fDated[i].fDate <= date) {
+                    apply(fDated[i]);
+                } else {
+                    fDated[j++] = fDated[i];
+                }
+            }
+            fDated.resize(j);
+
+            for (size_t i = 0; i < fSenders.size(); i++) {
+                ringbuffer_t* queue = fSenders[i]->fQueue;
+                Control control;
+                while (ringbuffer_read_space(queue) >= sizeof(Control)) {
+                    ringbuffer_read(queue, (char*)&control, sizeof(Control));
+                    if (control.fDate <= date || fDated.size() == fDated.capacity()) {
+                        apply(control);
+                    } else {
+                        fDated.push_back(control);
+                    }
+                }
+            }
+        }
+
+        // Remove and return the first waiting control dated before 'date'
+        bool nextControl(double date, Control& res)
+        {
+            int next = -1;
+            for (size_t i = 0; i < fDated.size(); i++) {
+                if (fDated[i].fDate < date && (next < 0 || fDated[i].fDate < fDated[next].fDate)) {
+                    next = int(i);
+                }
+            }
+            if (next < 0) return false;
+            res = fDated[next];
+            fDated.erase(fDated.begin() + next);
+            return true;
+        }
+
+        void apply(const Control& control)
+        {
+            *fZones[control.fIndex] = control.fValue;
+            setChanged(control.fIndex);
+        }
+
+        // Mark the bargraphs changed by the last computed block
+        void checkPassiveZones()
+        {
+            for (size_t i = 0; i < fPassive.size(); i++) {
+                FAUSTFLOAT v = *fZones[fPassive[i]];
+                if (v != fPassiveValues[i]) {
+                    fPassiveValues[i] = v;
+                    setChanged(fPassive[i]);
+                }
+            }
+        }
+
+        // -- GUI thread
+
+        // Reflect the zones changed since the previous call in all GUIs
+        void updateAllGuis()
+        {
+            int count = 0;
+            int words = int(fZones.size() + 31) / 32;
+            for (int w = 0; w < words; w++) {
+                uint32_t bits = fChanged[w].exchange(0, std::memory_order_acquire);
+                for (int b = 0; bits; b++, bits >>= 1) {
+                    if (bits & 1) fChangedZones[count++] = fZones[w * 32 + b];
+                }
+            }
+            if (count > 0) GUI::updateAllGuis(&fChangedZones[0], count);
+        }
+
+        // -- zones collection
+
+        virtual void addButton(const char* label, FAUSTFLOAT* zone) { addZone(zone, false); }
+        virtual void addCheckButton(const char* label, FAUSTFLOAT* zone) { addZone(zone, false); }
+        virtual void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            addZone(zone, false);
+        }
+        virtual void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            addZone(zone, false);
+        }
+        virtual void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step)
+        {
+            addZone(zone, false);
+        }
+        virtual void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
+        {
+            addZone(zone, true);
+        }
+        virtual void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT min, FAUSTFLOAT max)
+        {
+            addZone(zone, true);
+        }
+
+};
+
+/**
+ * Applies the controls of a ControlBus to the decorated DSP : at the beginning of the
+ * block with 'compute(count, inputs, outputs)', or at the frame given by their date
+ * with 'compute(date_usec, count, inputs, outputs)' by computing the block by slices.
+ */
+
+class controlbus_dsp : public decorator_dsp {
+
+    protected:
+
+        ControlBus* fBus;
+        FAUSTFLOAT** fInputsSlice;
+        FAUSTFLOAT** fOutputsSlice;
+
+        void computeSlice(int offset, int slice, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            if (slice > 0) {
+                for (int chan = 0; chan < fDSP->getNumInputs(); chan++) {
+                    fInputsSlice[chan] = &(inputs[chan][offset]);
+                }
+                for (int chan = 0; chan < fDSP->getNumOutputs(); chan++) {
+                    fOutputsSlice[chan] = &(outputs[chan][offset]);
+                }
+                fDSP->compute(slice, fInputsSlice, fOutputsSlice);
+            }
+        }
+
+    public:
+
+        // The bus is not owned by the DSP
+        controlbus_dsp(dsp* dsp, ControlBus* bus):decorator_dsp(dsp), fBus(bus)
+        {
+            fInputsSlice = new FAUSTFLOAT*[dsp->getNumInputs()];
+            fOutputsSlice = new FAUSTFLOAT*[dsp->getNumOutputs()];
+        }
+        virtual ~controlbus_dsp()
+        {
+            delete [] fInputsSlice;
+            delete [] fOutputsSlice;
+        }
+
+        virtual controlbus_dsp* clone()
+        {
+            return new controlbus_dsp(fDSP->clone(), fBus);
+        }
+
+        virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            fBus->receive();
+            fDSP->compute(count, inputs, outputs);
+            fBus->checkPassiveZones();
+        }
+
+        virtual void compute(double date_usec, int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            double usec2frames = double(getSampleRate()) / 1000000.;
+            double end_usec = date_usec + double(count) / usec2frames;
+            int offset = 0;
+            ControlBus::Control control;
+
+            fBus->receive(date_usec);
+            while (fBus->nextControl(end_usec, control)) {
+                int frame = std::min(std::max(int((control.fDate - date_usec) * usec2frames + 0.5), offset), count);
+                computeSlice(offset, frame - offset, inputs, outputs);
+                offset = frame;
+                fBus->apply(control);
+            }
+            computeSlice(offset, count - offset, inputs, outputs);
+            fBus->checkPassiveZones();
+        }
+
+};
+
+#endif
@@ -79,6 +79,25 @@ struct clist : public std::list<uiItemBase*>
 
 static void createUiCallbackItem(GUI* ui, FAUSTFLOAT* zone, uiCallback foo, void* data);
 
+/**
+ * Delivers zone changes to the audio thread instead of directly writing
+ * them in the zone (see ControlBus.h).
+ *
+ * With a sender set, a zone keeps its old value until the audio thread has read the
+ * queue, so the legacy GUI::updateAllGuis() can reflect the old value in the GUIs.
+ * The GUI run loops should then call ControlBus::updateAllGuis() instead, which
+ * reflects the zones written by the audio thread.
+ */
+
+struct ControlSender
+{
+    virtual ~ControlSender() {}
+    
+    // date is in usec, 0 to apply the value at the beginning of the next block.
+    // Returns false if the value could not be sent (unknown zone, or full queue)
+    virtual bool send(FAUSTFLOAT* zone, FAUSTFLOAT value, double date = 0.) = 0;
+};
+
 typedef std::map<FAUSTFLOAT*, clist*> zmap;
 
 typedef std::map<FAUSTFLOAT*, ringbuffer_t*> ztimedmap;
@@ -91,10 +110,11 @@ class GUI : public UI
         static std::list<GUI*> fGuiList;
         zmap fZoneMap;
         bool fStopped;
+        ControlSender* fControlSender;
         
      public:
             
-        GUI():fStopped(false)
+        GUI():fStopped(false), fControlSender(0)
         {	
             fGuiList.push_back(this);
         }
@@ -134,8 +154,10 @@ class GUI : public UI
         
         void updateZone(FAUSTFLOAT* z)
         {
+            zmap::iterator m = fZoneMap.find(z);
+            if (m == fZoneMap.end()) return;
             FAUSTFLOAT v = *z;
-            clist* l = fZoneMap[z];
+            clist* l = m->second;
             for (clist::iterator c = l->begin(); c != l->end(); c++) {
                 if ((*c)->cache() != v) (*c)->reflectZone();
             }
@@ -149,6 +171,21 @@ class GUI : public UI
             }
         }
     
+        // Only reflect the given zones (typically the ones changed since the last call)
+        static void updateAllGuis(FAUSTFLOAT** zones, int count)
+        {
+            std::list<GUI*>::iterator g;
+            for (g = fGuiList.begin(); g != fGuiList.end(); g++) {
+                for (int i = 0; i < count; i++) {
+                    (*g)->updateZone(zones[i]);
+                }
+            }
+        }
+    
+        // When set, the zones changed by this GUI are delivered through the sender
+        void setControlSender(ControlSender* sender) { fControlSender = sender; }
+        ControlSender* getControlSender() { return fControlSender; }
+    
         void addCallback(FAUSTFLOAT* zone, uiCallback foo, void* data)
         {
             createUiCallbackItem(this, zone, foo, data);
@@ -253,8 +290,12 @@ class uiItem : public uiTypedItem<FAUSTFLOAT> {
         { 
             fCache = v;
             if (*fZone != v) {
-                *fZone = v;
-                fGUI->updateZone(fZone);
+                ControlSender* sender = fGUI->getControlSender();
+                // Written by the audio thread, and reflected after, when sent
+                if (!sender || !sender->send(fZone, v)) {
+                    *fZone = v;
+                    fGUI->updateZone(fZone);
+                }
             }
         }
 
@@ -385,7 +426,10 @@ class uiGroupItem : public uiItem
             // Update all zones of the same group
             std::vector<FAUSTFLOAT*>::iterator it;
             for (it = fZoneMap.begin(); it != fZoneMap.end(); it++) {
-                (*(*it)) = v;
+                ControlSender* sender = fGUI->getControlSender();
+                if (!sender || !sender->send(*it, v)) {
+                    (*(*it)) = v;
+                }
             }
         }
         
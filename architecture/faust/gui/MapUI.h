@@ -30,10 +30,13 @@
 
 #include "faust/gui/UI.h"
 #include "faust/gui/PathBuilder.h"
+#include "faust/gui/PathTable.h"
 
 /*******************************************************************************
  * MapUI : Faust User Interface
  * This class creates a map of complete hierarchical path and zones for each UI items.
+ * Items can also be accessed by index (in path order), resolved once with getParamIndex.
+ * The index is built when the UI is complete (when its top level box is closed).
  ******************************************************************************/
 
 class MapUI : public UI, public PathBuilder
@@ -47,10 +50,49 @@ class MapUI : public UI, public PathBuilder
         // Label zone map
         std::map<std::string, FAUSTFLOAT*> fLabelZoneMap;
     
+        // Indexed access, built from the maps by buildIndex
+        std::vector<std::string> fPaths;
+        std::vector<FAUSTFLOAT*> fZones;
+        PathTable fPathTable;
+        PathTable fLabelTable;
+    
+        void addZone(const char* label, FAUSTFLOAT* zone)
+        {
+            fPathZoneMap[buildPath(label)] = zone;
+            fLabelZoneMap[label] = zone;
+            // Item outside of any box
+            if (fControlsLevel.empty()) buildIndex();
+        }
+    
     public:
         
         MapUI() {};
         virtual ~MapUI() {};
+    
+        // Build the index from the maps (allocates memory): called when the UI is complete,
+        // and to be called (outside of the audio thread) by subclasses changing the maps
+        void buildIndex()
+        {
+            std::map<FAUSTFLOAT*, int> zone_index;
+            std::map<std::string, FAUSTFLOAT*>::iterator it;
+            fPaths.clear();
+            fZones.clear();
+            fPathTable = PathTable();
+            fLabelTable = PathTable();
+            for (it = fPathZoneMap.begin(); it != fPathZoneMap.end(); it++) {
+                zone_index[(*it).second] = int(fZones.size());
+                fPathTable.add((*it).first, int(fZones.size()));
+                fPaths.push_back((*it).first);
+                fZones.push_back((*it).second);
+            }
+            for (it = fLabelZoneMap.begin(); it != fLabelZoneMap.end(); it++) {
+                if (zone_index.find((*it).second) != zone_index.end()) {
+                    fLabelTable.add((*it).first, zone_index[(*it).second]);
+                }
+            }
+            fPathTable.build();
+            fLabelTable.build();
+        }
         
         // -- widget's layouts
         void openTabBox(const char* label)
@@ -68,45 +110,39 @@ class MapUI : public UI, public PathBuilder
         void closeBox()
         {
             fControlsLevel.pop_back();
+            if (fControlsLevel.empty()) buildIndex();
         }
         
         // -- active widgets
         void addButton(const char* label, FAUSTFLOAT* zone)
         {
-            fPathZoneMap[buildPath(label)] = zone;
-            fLabelZoneMap[label] = zone;
+            addZone(label, zone);
         }
         void addCheckButton(const char* label, FAUSTFLOAT* zone)
         {
-            fPathZoneMap[buildPath(label)] = zone;
-            fLabelZoneMap[label] = zone;
+            addZone(label, zone);
         }
         void addVerticalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT fmin, FAUSTFLOAT fmax, FAUSTFLOAT step)
         {
-            fPathZoneMap[buildPath(label)] = zone;
-            fLabelZoneMap[label] = zone;
+            addZone(label, zone);
         }
         void addHorizontalSlider(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT fmin, FAUSTFLOAT fmax, FAUSTFLOAT step)
         {
-            fPathZoneMap[buildPath(label)] = zone;
-            fLabelZoneMap[label] = zone;
+            addZone(label, zone);
         }
         void addNumEntry(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT init, FAUSTFLOAT fmin, FAUSTFLOAT fmax, FAUSTFLOAT step)
         {
-            fPathZoneMap[buildPath(label)] = zone;
-            fLabelZoneMap[label] = zone;
+            addZone(label, zone);
         }
         
         // -- passive widgets
         void addHorizontalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT fmin, FAUSTFLOAT fmax)
         {
-            fPathZoneMap[buildPath(label)] = zone;
-            fLabelZoneMap[label] = zone;
+            addZone(label, zone);
         }
         void addVerticalBargraph(const char* label, FAUSTFLOAT* zone, FAUSTFLOAT fmin, FAUSTFLOAT fmax)
         {
-            fPathZoneMap[buildPath(label)] = zone;
-            fLabelZoneMap[label] = zone;
+            addZone(label, zone);
         }
     
         // -- soundfiles
@@ -116,38 +152,51 @@ class MapUI : public UI, public PathBuilder
         void declare(FAUSTFLOAT* zone, const char* key, const char* val)
         {}
         
+        // Return the index of a path (or label), or -1 if not found.
+        // The index is a stable handle for the other methods: resolve it once, outside of the audio thread
+        int getParamIndex(const std::string& path)
+        {
+            int index = fPathTable.find(path);
+            return (index >= 0) ? index : fLabelTable.find(path);
+        }
+        
         // set/get
         void setParamValue(const std::string& path, FAUSTFLOAT value)
         {
-            if (fPathZoneMap.find(path) != fPathZoneMap.end()) {
-                *fPathZoneMap[path] = value;
-            } else if (fLabelZoneMap.find(path) != fLabelZoneMap.end()) {
-                *fLabelZoneMap[path] = value;
-            }
+            int index = getParamIndex(path);
+            if (index >= 0) *fZones[index] = value;
         }
         
         FAUSTFLOAT getParamValue(const std::string& path)
         {
-            if (fPathZoneMap.find(path) != fPathZoneMap.end()) {
-                return *fPathZoneMap[path];
-            } else if (fLabelZoneMap.find(path) != fLabelZoneMap.end()) {
-                return *fLabelZoneMap[path];
-            } else {
-                return FAUSTFLOAT(0);
+            int index = getParamIndex(path);
+            return (index >= 0) ? *fZones[index] : FAUSTFLOAT(0);
+        }
+    
+        // set/get by index, usable in the audio thread (negative indexes are ignored)
+        FAUSTFLOAT* getParamZone(int index) { return fZones[index]; }
+        void setParamValue(int index, FAUSTFLOAT value) { *fZones[index] = value; }
+        FAUSTFLOAT getParamValue(int index) { return *fZones[index]; }
+    
+        void setParamValues(const int* indexes, const FAUSTFLOAT* values, int count)
+        {
+            for (int i = 0; i < count; i++) {
+                if (indexes[i] >= 0) *fZones[indexes[i]] = values[i];
+            }
+        }
+        void getParamValues(const int* indexes, FAUSTFLOAT* values, int count)
+        {
+            for (int i = 0; i < count; i++) {
+                values[i] = (indexes[i] >= 0) ? *fZones[indexes[i]] : FAUSTFLOAT(0);
             }
         }
     
         // map access 
-        std::map<std::string, FAUSTFLOAT*>& getMap() { return fPathZoneMap; }
+        const std::map<std::string, FAUSTFLOAT*>& getMap() { return fPathZoneMap; }
         
         int getParamsCount() { return int(fPathZoneMap.size()); }
         
-        std::string getParamAddress(int index)
-        { 
-            std::map<std::string, FAUSTFLOAT*>::iterator it = fPathZoneMap.begin();
-            while (index-- > 0 && it++ != fPathZoneMap.end()) {}
-            return (*it).first;
-        }
+        std::string getParamAddress(int index) { return fPaths[index]; }
     
         std::string getParamAddress(FAUSTFLOAT* zone)
         {
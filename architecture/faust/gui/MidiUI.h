@@ -461,6 +461,32 @@ class uiMidiKeyPress : public uiMidiItem
         
 };
 
+/**
+ * Associates each MIDI number (ctrl, key, pgm...) with its MIDI aware UI items: an array
+ * indexed by the number, so that an incoming event is dispatched without any lookup.
+ */
+template <typename ITEM>
+struct uiMidiTable
+{
+    std::vector<ITEM*> fItems[128];
+    
+    // Numbers outside [0..127] cannot be received and are not indexed
+    void add(unsigned int num, ITEM* item)
+    {
+        if (num < 128) fItems[num].push_back(item);
+    }
+    
+    void modifyZone(int num, FAUSTFLOAT v)
+    {
+        if (num >= 0 && num < 128) {
+            std::vector<ITEM*>& items = fItems[num];
+            for (size_t i = 0; i < items.size(); i++) {
+                items[i]->modifyZone(v);
+            }
+        }
+    }
+};
+
 class MapUI;
 
 /******************************************************************************************
@@ -469,7 +495,7 @@ class MapUI;
  * Currently ctrl, keyon/keyoff, keypress, pgm, chanpress, pitchwheel/pitchbend
  * start/stop/clock meta data are handled.
  *
- * Maps associating MIDI event ID (like each ctrl number) with all MIDI aware UI items
+ * Tables associating MIDI event ID (like each ctrl number) with all MIDI aware UI items
  * are defined and progressively filled when decoding MIDI related metadata.
  * MIDI aware UI items are used in both directions:
  *  - modifying their internal state when receving MIDI input events
@@ -481,13 +507,13 @@ class MidiUI : public GUI, public midi
 
     protected:
     
-        std::map <int, std::vector<uiMidiCtrlChange*> > fCtrlChangeTable;
-        std::map <int, std::vector<uiMidiProgChange*> > fProgChangeTable;
-        std::map <int, std::vector<uiMidiChanPress*> >  fChanPressTable;
-        std::map <int, std::vector<uiMidiKeyOn*> >      fKeyOnTable;
-        std::map <int, std::vector<uiMidiKeyOff*> >     fKeyOffTable;
-        std::map <int, std::vector<uiMidiKeyOn*> >      fKeyTable;
-        std::map <int, std::vector<uiMidiKeyPress*> >   fKeyPressTable;
+        uiMidiTable<uiMidiCtrlChange>   fCtrlChangeTable;
+        uiMidiTable<uiMidiProgChange>   fProgChangeTable;
+        uiMidiTable<uiMidiChanPress>    fChanPressTable;
+        uiMidiTable<uiMidiKeyOn>        fKeyOnTable;
+        uiMidiTable<uiMidiKeyOff>       fKeyOffTable;
+        uiMidiTable<uiMidiKeyOn>        fKeyTable;
+        uiMidiTable<uiMidiKeyPress>     fKeyPressTable;
         std::vector<uiMidiPitchWheel*>                  fPitchWheelTable;
         
         std::vector<uiMidiStart*>   fStartTable;
@@ -506,19 +532,19 @@ class MidiUI : public GUI, public midi
                     unsigned num;
                     if (fMetaAux[i].first == "midi") {
                         if (gsscanf(fMetaAux[i].second.c_str(), "ctrl %u", &num) == 1) {
-                            fCtrlChangeTable[num].push_back(new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input));
+                            fCtrlChangeTable.add(num, new uiMidiCtrlChange(fMidiHandler, num, this, zone, min, max, input));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keyon %u", &num) == 1) {
-                            fKeyOnTable[num].push_back(new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input));
+                            fKeyOnTable.add(num, new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keyoff %u", &num) == 1) {
-                            fKeyOffTable[num].push_back(new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input));
+                            fKeyOffTable.add(num, new uiMidiKeyOff(fMidiHandler, num, this, zone, min, max, input));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "key %u", &num) == 1) {
-                            fKeyTable[num].push_back(new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input));
+                            fKeyTable.add(num, new uiMidiKeyOn(fMidiHandler, num, this, zone, min, max, input));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "keypress %u", &num) == 1) {
-                            fKeyPressTable[num].push_back(new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input));
+                            fKeyPressTable.add(num, new uiMidiKeyPress(fMidiHandler, num, this, zone, min, max, input));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "pgm %u", &num) == 1) {
-                            fProgChangeTable[num].push_back(new uiMidiProgChange(fMidiHandler, num, this, zone, input));
+                            fProgChangeTable.add(num, new uiMidiProgChange(fMidiHandler, num, this, zone, input));
                         } else if (gsscanf(fMetaAux[i].second.c_str(), "chanpress %u", &num) == 1) {
-                            fChanPressTable[num].push_back(new uiMidiChanPress(fMidiHandler, num, this, zone, input));
+                            fChanPressTable.add(num, new uiMidiChanPress(fMidiHandler, num, this, zone, input));
                         } else if (strcmp(fMetaAux[i].second.c_str(), "pitchwheel") == 0 
                             || strcmp(fMetaAux[i].second.c_str(), "pitchbend") == 0) {
                             fPitchWheelTable.push_back(new uiMidiPitchWheel(fMidiHandler, this, zone, input));
@@ -606,51 +632,27 @@ class MidiUI : public GUI, public midi
         
         MapUI* keyOn(double date, int channel, int note, int velocity)
         {
-            if (fKeyOnTable.find(note) != fKeyOnTable.end()) {
-                for (unsigned int i = 0; i < fKeyOnTable[note].size(); i++) {
-                    fKeyOnTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                }
-            }
+            fKeyOnTable.modifyZone(note, FAUSTFLOAT(velocity));
             // If note is in fKeyTable, handle it as a keyOn
-            if (fKeyTable.find(note) != fKeyTable.end()) {
-                for (unsigned int i = 0; i < fKeyTable[note].size(); i++) {
-                    fKeyTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                }
-            }
+            fKeyTable.modifyZone(note, FAUSTFLOAT(velocity));
             return 0;
         }
         
         void keyOff(double date, int channel, int note, int velocity)
         {
-            if (fKeyOffTable.find(note) != fKeyOffTable.end()) {
-                for (unsigned int i = 0; i < fKeyOffTable[note].size(); i++) {
-                    fKeyOffTable[note][i]->modifyZone(FAUSTFLOAT(velocity));
-                }
-            }
+            fKeyOffTable.modifyZone(note, FAUSTFLOAT(velocity));
             // If note is in fKeyTable, handle it as a keyOff with a 0 velocity
-            if (fKeyTable.find(note) != fKeyTable.end()) {
-                for (unsigned int i = 0; i < fKeyTable[note].size(); i++) {
-                    fKeyTable[note][i]->modifyZone(0);
-                }
-            }
+            fKeyTable.modifyZone(note, FAUSTFLOAT(0));
         }
            
         void ctrlChange(double date, int channel, int ctrl, int value)
         {
-            if (fCtrlChangeTable.find(ctrl) != fCtrlChangeTable.end()) {
-                for (unsigned int i = 0; i < fCtrlChangeTable[ctrl].size(); i++) {
-                    fCtrlChangeTable[ctrl][i]->modifyZone(FAUSTFLOAT(value));
-                }
-            } 
+            fCtrlChangeTable.modifyZone(ctrl, FAUSTFLOAT(value));
         }
         
         void progChange(double date, int channel, int pgm)
         {
-            if (fProgChangeTable.find(pgm) != fProgChangeTable.end()) {
-                for (unsigned int i = 0; i < fProgChangeTable[pgm].size(); i++) {
-                    fProgChangeTable[pgm][i]->modifyZone(FAUSTFLOAT(1));
-                }
-            } 
+            fProgChangeTable.modifyZone(pgm, FAUSTFLOAT(1));
         }
         
         void pitchWheel(double date, int channel, int wheel) 
@@ -662,20 +664,12 @@ class MidiUI : public GUI, public midi
         
         void keyPress(double date, int channel, int pitch, int press) 
         {
-            if (fKeyPressTable.find(pitch) != fKeyPressTable.end()) {
-                for (unsigned int i = 0; i < fKeyPressTable[pitch].size(); i++) {
-                    fKeyPressTable[pitch][i]->modifyZone(FAUSTFLOAT(press));
-                }
-            } 
+            fKeyPressTable.modifyZone(pitch, FAUSTFLOAT(press));
         }
         
         void chanPress(double date, int channel, int press)
         {
-            if (fChanPressTable.find(press) != fChanPressTable.end()) {
-                for (unsigned int i = 0; i < fChanPressTable[press].size(); i++) {
-                    fChanPressTable[press][i]->modifyZone(FAUSTFLOAT(1));
-                }
-            } 
+            fChanPressTable.modifyZone(press, FAUSTFLOAT(1));
         }
         
         void ctrlChange14bits(double date, int channel, int ctrl, int value) {}
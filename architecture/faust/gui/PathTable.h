@@ -0,0 +1,149 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+ EXCEPTION : As a special exception, you may create a larger work
+ that contains this FAUST architecture section and distribute
+ that work under terms of your choice, so long as this FAUST
+ architecture section is not modified.
+ ************************************************************************/
+
+#ifndef FAUST_PATHTABLE_H
+#define FAUST_PATHTABLE_H
+
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/*******************************************************************************
+ * PathTable : perfect hash table associating paths (or labels) with an index.
+ *
+ * The table is built with the 'hash and displace' method once all paths are added
+ * (with an explicit 'build', outside of the audio thread): each key of a first level bucket
+ * is moved by the bucket displacement to a free slot, so that a lookup costs
+ * two hashes and a single string comparison.
+ ******************************************************************************/
+
+class PathTable
+{
+
+    private:
+
+        std::map<std::string, int> fEntries;    // the last added value of a key is kept
+        std::vector<std::string> fKeys;         // key of each slot
+        std::vector<int> fValues;               // value of each slot, -1 if free
+        std::vector<unsigned int> fDisplace;    // displacement of each bucket
+        bool fBuilt;
+
+        static unsigned int hash(const char* key, size_t len, unsigned int seed)
+        {
+            // FNV-1a
+            unsigned int h = 2166136261u ^ (seed * 0x9E3779B9u);
+            for (size_t i = 0; i < len; i++) {
+                h ^= (unsigned char)key[i];
+                h *= 16777619u;
+            }
+            return h ^ (h >> 15);
+        }
+
+        bool build(size_t size)
+        {
+            size_t buckets = std::max<size_t>(1, fEntries.size());
+            std::vector<std::vector<const std::string*> > bucket_keys(buckets);
+            std::map<std::string, int>::iterator it;
+            for (it = fEntries.begin(); it != fEntries.end(); it++) {
+                bucket_keys[hash(it->first.c_str(), it->first.size(), 0) % buckets].push_back(&it->first);
+            }
+
+            // Place the largest buckets first
+            std::vector<std::pair<size_t, size_t> > order;
+            for (size_t b = 0; b < buckets; b++) {
+                order.push_back(std::make_pair(bucket_keys[b].size(), b));
+            }
+            std::sort(order.rbegin(), order.rend());
+
+            fKeys.assign(size, "");
+            fValues.assign(size, -1);
+            fDisplace.assign(buckets, 0);
+            std::vector<size_t> slots;
+
+            for (size_t o = 0; o < order.size() && order[o].first > 0; o++) {
+                std::vector<const std::string*>& keys = bucket_keys[order[o].second];
+                bool placed = false;
+                for (unsigned int d = 1; d < (1u << 16) && !placed; d++) {
+                    slots.clear();
+                    placed = true;
+                    for (size_t k = 0; k < keys.size() && placed; k++) {
+                        size_t slot = hash(keys[k]->c_str(), keys[k]->size(), d) % size;
+                        placed = (fValues[slot] < 0) && (std::find(slots.begin(), slots.end(), slot) == slots.end());
+                        slots.push_back(slot);
+                    }
+                    if (placed) {
+                        fDisplace[order[o].second] = d;
+                        for (size_t k = 0; k < keys.size(); k++) {
+                            fKeys[slots[k]] = *keys[k];
+                            fValues[slots[k]] = fEntries[*keys[k]];
+                        }
+                    }
+                }
+                if (!placed) return false;
+            }
+            return true;
+        }
+
+    public:
+
+        PathTable():fBuilt(true) {}
+
+        void add(const std::string& key, int value)
+        {
+            fEntries[key] = value;
+            fBuilt = false;
+        }
+
+        // Build the table once all keys are added (allocates memory)
+        void build()
+        {
+            if (fBuilt) return;
+            // A 0.5 load factor is found in a few tries, the table is enlarged otherwise
+            size_t size = std::max<size_t>(1, 2 * fEntries.size());
+            while (!build(size)) size *= 2;
+            fBuilt = true;
+        }
+
+        // Return the value of a key, or -1 if not found (keys added after the last 'build' are found with a slower lookup)
+        int find(const char* key) const
+        {
+            if (!fBuilt) return find(std::string(key));
+            if (fEntries.empty()) return -1;
+            size_t len = strlen(key);
+            unsigned int d = fDisplace[hash(key, len, 0) % fDisplace.size()];
+            size_t slot = hash(key, len, d) % fValues.size();
+            return (fValues[slot] >= 0 && fKeys[slot].size() == len && memcmp(fKeys[slot].c_str(), key, len) == 0) ? fValues[slot] : -1;
+        }
+        int find(const std::string& key) const
+        {
+            if (fBuilt) return find(key.c_str());
+            std::map<std::string, int>::const_iterator it = fEntries.find(key);
+            return (it != fEntries.end()) ? it->second : -1;
+        }
+
+        size_t size() const { return fEntries.size(); }
+};
+
+#endif  // FAUST_PATHTABLE_H
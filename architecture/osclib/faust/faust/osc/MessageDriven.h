@@ -24,6 +24,7 @@
 #ifndef __MessageDriven__
 #define __MessageDriven__
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -48,16 +49,32 @@ typedef class SMARTP<MessageDriven>	SMessageDriven;
 	
 	The principle of the dispatch is the following:
 	- first the processMessage() method should be called on the top level node
-	- next processMessage call propose 
+	- next processMessage looks for the destination nodes of the message address and calls their accept method
+
+	The destination nodes are found in a table of the full OSC addresses of the tree, built on first use.
+	Only the addresses containing regular expression characters are matched node by node (the way
+	propose does), and their destination nodes are cached.
 */
 class MessageDriven : public MessageProcessor, public smartable
 {
+	typedef std::map<std::string, std::vector<MessageDriven*> > TDispatchMap;
+
 	std::string						fName;			///< the node name
 	std::string						fOSCPrefix;		///< the node OSC address prefix (OSCAddress = fOSCPrefix + '/' + fName)
 	std::vector<SMessageDriven>		fSubNodes;		///< the subnodes of the current node
 
+	TDispatchMap					fAddresses;		///< the destination nodes of each OSC address of the tree
+	TDispatchMap					fPatterns;		///< the destination nodes of the OSC address patterns already received
+	unsigned long					fVersion;		///< the tree version when the dispatch tables were built
+
+	static unsigned long			gTreeVersion;	///< incremented when a node is added, to invalidate the dispatch tables
+
+	const std::vector<MessageDriven*>& destinations(const std::string& address);
+	void	collect(const std::string& prefix, TDispatchMap& addresses);
+	void	collect(const OSCRegexp* regexp, const std::string& addrTail, std::vector<MessageDriven*>& dest);
+
 	protected:
-				 MessageDriven(const char *name, const char *oscprefix) : fName (name), fOSCPrefix(oscprefix) {}
+				 MessageDriven(const char *name, const char *oscprefix) : fName (name), fOSCPrefix(oscprefix), fVersion(0) {}
 		virtual ~MessageDriven() {}
 
 	public:
@@ -81,8 +98,12 @@ class MessageDriven : public MessageProcessor, public smartable
 			- it calls \c accept when \c addrTail is empty 
 			- or it \c propose the message to its subnodes when \c addrTail is not empty. 
 			  In this case a new \c regexp is computed with the head of \c addrTail and a new \c addrTail as well.
+
+			The method is not virtual: processMessage does not call it but uses the dispatch tables,
+			which select the destination nodes the same way, by their names only. The message
+			handling of a node has to be specialized in \c accept.
 		*/
-		virtual void	propose(const Message* msg, const OSCRegexp* regexp, const std::string addrTail);
+		void			propose(const Message* msg, const OSCRegexp* regexp, const std::string addrTail);
 
 		/*!
 			\brief accept an OSC message. 
@@ -117,7 +138,7 @@ class MessageDriven : public MessageProcessor, public smartable
 		*/
 		virtual void	get (unsigned long ipdest, const std::string & what) const {}
 
-		void			add(SMessageDriven node)	{ fSubNodes.push_back (node); }
+		void			add(SMessageDriven node)	{ fSubNodes.push_back (node); gTreeVersion++; }
 		const char*		getName() const				{ return fName.c_str(); }
 		std::string		getOSCAddress() const;
 		int				size() const				{ return (int)fSubNodes.size (); }
@@ -36,15 +36,77 @@ namespace oscfaust
 
 static const char * kGetMsg = "get";
 
+// the characters of the OSC address patterns, and of the regular expressions they are translated to
+static const char * kPatternChars = "*?[]{},().+|^$\\";
+
+// maximum number of cached address patterns
+#define kMaxPatterns	1024
+
+unsigned long MessageDriven::gTreeVersion = 1;
+
 //--------------------------------------------------------------------------
 void MessageDriven::processMessage(const Message* msg)
 {
-	const string addr = msg->address();
+	const vector<MessageDriven*>& dest = destinations(msg->address());
+	for (size_t i = 0; i < dest.size(); i++) {
+		dest[i]->accept(msg);
+	}
+}
+
+//--------------------------------------------------------------------------
+// the destination nodes of an OSC address: a plain address is looked up in the
+// table of the tree addresses, a pattern is matched once then cached
+const vector<MessageDriven*>& MessageDriven::destinations(const string& address)
+{
+	static const vector<MessageDriven*> kNoDestination;
+
+	if (fVersion != gTreeVersion) {			// the tree has changed: rebuild the addresses table
+		fAddresses.clear();
+		fPatterns.clear();
+		collect("", fAddresses);
+		fVersion = gTreeVersion;
+	}
 
-	// create a regular expression
-	OSCRegexp r(OSCAddress::addressFirst(addr).c_str());
-	// and call propose with this regexp and with the dest osc address tail
-	propose(msg, &r, OSCAddress::addressTail(addr));
+	if ((address[0] == '/') && (address.find_first_of(kPatternChars) == string::npos)) {
+		TDispatchMap::const_iterator i = fAddresses.find(address);
+		return (i != fAddresses.end()) ? i->second : kNoDestination;
+	}
+
+	TDispatchMap::const_iterator i = fPatterns.find(address);
+	if (i != fPatterns.end()) return i->second;
+
+	if (fPatterns.size() >= kMaxPatterns) fPatterns.clear();
+	vector<MessageDriven*>& dest = fPatterns[address];
+	OSCRegexp r(OSCAddress::addressFirst(address).c_str());
+	collect(&r, OSCAddress::addressTail(address), dest);
+	return dest;
+}
+
+//--------------------------------------------------------------------------
+// collects the OSC addresses of the subtree
+void MessageDriven::collect(const string& prefix, TDispatchMap& addresses)
+{
+	string address = prefix + "/" + fName;
+	addresses[address].push_back(this);
+	for (vector<SMessageDriven>::iterator i = fSubNodes.begin(); i != fSubNodes.end(); i++) {
+		(*i)->collect(address, addresses);
+	}
+}
+
+//--------------------------------------------------------------------------
+// collects the nodes matching an address pattern, in the same order than propose
+void MessageDriven::collect(const OSCRegexp* r, const string& addrTail, vector<MessageDriven*>& dest)
+{
+	if (r->match(getName())) {
+		if (addrTail.empty()) {
+			dest.push_back(this);
+		} else {
+			OSCRegexp rtail (OSCAddress::addressFirst(addrTail).c_str());
+			for (vector<SMessageDriven>::iterator i = fSubNodes.begin(); i != fSubNodes.end(); i++) {
+				(*i)->collect(&rtail, OSCAddress::addressTail(addrTail), dest);
+			}
+		}
+	}
 }
 
 //--------------------------------------------------------------------------
@@ -151,7 +151,9 @@ void RootNode::get(unsigned long ipdest) const		///< handler for the 'get' messa
 //--------------------------------------------------------------------------
 void RootNode::processAlias(const string& address, float val)
 {
- 	vector<aliastarget> targets = fAliases[address];	// retrieve the address aliases
+	TAliasMap::const_iterator it = fAliases.find(address);
+	if (it == fAliases.end()) return;
+ 	vector<aliastarget> targets = it->second;			// retrieve the address aliases
 	size_t n = targets.size();							// that could point to an arbitraty number of targets
 	for (size_t i = 0; i < n; i++) {					// for each target
 		Message m(targets[i].fTarget, address);			// create a new message with the target address and the alias
@@ -182,6 +184,10 @@ void RootNode::processMessage(const Message* msg)
 {
 	const string& addr = msg->address();
 	float v; int iv;
+	if (fAliases.empty()) {				// no alias is defined
+		MessageDriven::processMessage(msg);
+		return;
+	}
 	if (msg->size() == 1) {             // there is a single parameter
 		if (msg->param(0, v))           // check the parameter float value
 			processAlias(addr, v);		// and try to process as an alias
@@ -31,7 +31,9 @@
 #include <string.h>
 #include <semaphore.h>
 #include <sys/types.h>
+#ifdef __APPLE__
 #include <sys/sysctl.h>
+#endif
 #include <sys/stat.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -0,0 +1,447 @@
+/************************************************************************
+
+	IMPORTANT NOTE : this file contains two clearly delimited sections :
+	the ARCHITECTURE section (in two parts) and the USER section. Each section
+	is governed by its own copyright and license. Please check individually
+	each section for license and copyright information.
+*************************************************************************/
+
+/*******************BEGIN ARCHITECTURE SECTION (part 1/2)****************/
+
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+************************************************************************
+************************************************************************/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sndfile.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+#include "faust/gui/console.h"
+#include "faust/dsp/dsp.h"
+#include "faust/misc.h"
+
+#ifndef FAUSTFLOAT
+#define FAUSTFLOAT float
+#endif
+
+#define READ_SAMPLE sf_readf_float
+//#define READ_SAMPLE sf_readf_double
+
+#define WRITE_SAMPLE sf_writef_float
+//#define WRITE_SAMPLE sf_writef_double
+
+/******************************************************************************
+*******************************************************************************
+
+VECTOR INTRINSICS
+
+*******************************************************************************
+*******************************************************************************/
+
+<<includeIntrinsic>>
+
+/********************END ARCHITECTURE SECTION (part 1/2)****************/
+
+/**************************BEGIN USER SECTION **************************/
+
+<<includeclass>>
+
+/***************************END USER SECTION ***************************/
+
+/*******************BEGIN ARCHITECTURE SECTION (part 2/2)***************/
+
+/*
+ Offline batch renderer : all input files given on the command line are processed
+ concurrently by a pool of workers, each one owning a clone of the DSP. Files are
+ processed by large blocks, and the reading of the next block and the writing of
+ the previous one are done on a separated thread while the current block is computed
+ (double buffering). The throughput of each file is reported as a realtime factor.
+
+ Usage : prog [--jobs <n>] [--block-size <frames>] [--continue <frames>]
+              [--output-dir <dir>] [DSP parameters] input_soundfile...
+
+ Output files are written in the output directory with the input file name, or next
+ to the input files with a '-out' suffix when no output directory is given.
+*/
+
+mydsp DSP;
+
+#define kBlockFrames 65536
+
+using namespace std;
+
+class Separator
+{
+  int fNumFrames;
+  int fNumInputs;
+  int fNumOutputs;
+
+  FAUSTFLOAT* fInput;
+  FAUSTFLOAT* fOutputs[256];
+
+public:
+
+  Separator(int numFrames, int numInputs, int numOutputs)
+  {
+    fNumFrames 	= numFrames;
+    fNumInputs 	= numInputs;
+    fNumOutputs = max(numInputs, numOutputs);
+
+    // allocate interleaved input channel
+    fInput = (FAUSTFLOAT*) calloc(fNumFrames * fNumInputs, sizeof(FAUSTFLOAT));
+
+    // allocate separate output channels
+    for (int i = 0; i < fNumOutputs; i++) {
+      fOutputs[i] = (FAUSTFLOAT*) calloc (fNumFrames, sizeof(FAUSTFLOAT));
+    }
+  }
+
+  ~Separator()
+  {
+    // free interleaved input channel
+    free(fInput);
+
+    // free separate output channels
+    for (int i = 0; i < fNumOutputs; i++) {
+      free(fOutputs[i]);
+    }
+  }
+
+  FAUSTFLOAT* input() { return fInput; }
+
+  FAUSTFLOAT** outputs() { return fOutputs; }
+
+  void separate(int count)
+  {
+    for (int c = 0; c < fNumInputs; c++) {
+      FAUSTFLOAT* output = fOutputs[c];
+      for (int s = 0; s < count; s++) {
+        output[s] = fInput[c + s*fNumInputs];
+      }
+    }
+  }
+};
+
+class Interleaver
+{
+  int fNumFrames;
+  int fNumChans;
+
+  FAUSTFLOAT* fInputs[256];
+  FAUSTFLOAT* fOutput;
+
+public:
+
+  Interleaver(int numFrames, int numChans)
+  {
+    fNumFrames = numFrames;
+    fNumChans = numChans;
+
+    // allocate separate input channels
+    for (int i = 0; i < fNumChans; i++) {
+      fInputs[i] = (FAUSTFLOAT*) calloc (fNumFrames, sizeof(FAUSTFLOAT));
+    }
+
+    // allocate interleaved output channel
+    fOutput = (FAUSTFLOAT*) calloc(fNumFrames * fNumChans, sizeof(FAUSTFLOAT));
+  }
+
+  ~Interleaver()
+  {
+    // free separate input channels
+    for (int i = 0; i < fNumChans; i++) {
+      free(fInputs[i]);
+    }
+
+    // free interleaved output channel
+    free(fOutput);
+  }
+
+  FAUSTFLOAT** inputs() { return fInputs; }
+
+  FAUSTFLOAT* output() { return fOutput; }
+
+  void interleave(int count)
+  {
+    for (int c = 0; c < fNumChans; c++) {
+      FAUSTFLOAT* input = fInputs[c];
+      for (int s = 0; s < count; s++) {
+        fOutput[c + s*fNumChans] = max(min(input[s], FAUSTFLOAT(1.0)), FAUSTFLOAT(-1.0));
+      }
+    }
+  }
+};
+
+// loptrm : Scan command-line arguments and remove and return long int value when found
+long loptrm(int *argcP, char *argv[], const char* longname, const char* shortname, long def)
+{
+  int argc = *argcP;
+  for (int i=2; i<argc; i++) {
+    if (strcmp(argv[i-1], shortname) == 0 || strcmp(argv[i-1], longname) == 0) {
+      int optval = atoi(argv[i]);
+      for (int j=i-1; j<argc-2; j++) {  // make it go away for sake of "faust/gui/console.h"
+        argv[j] = argv[j+2];
+      }
+      *argcP -= 2;
+      return optval;
+    }
+  }
+  return def;
+}
+
+// soptrm : Scan command-line arguments and remove and return string value when found
+const char* soptrm(int *argcP, char *argv[], const char* longname, const char* shortname, const char* def)
+{
+  int argc = *argcP;
+  for (int i=2; i<argc; i++) {
+    if (strcmp(argv[i-1], shortname) == 0 || strcmp(argv[i-1], longname) == 0) {
+      const char* optval = argv[i];
+      for (int j=i-1; j<argc-2; j++) {  // make it go away for sake of "faust/gui/console.h"
+        argv[j] = argv[j+2];
+      }
+      *argcP -= 2;
+      return optval;
+    }
+  }
+  return def;
+}
+
+static double getSeconds()
+{
+  return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static string outputFile(const string& input, const char* output_dir)
+{
+  if (output_dir) {
+    return string(output_dir) + "/" + input.substr(input.find_last_of('/') + 1);
+  }
+  size_t dot = input.find_last_of('.');
+  size_t slash = input.find_last_of('/');
+  if (dot == string::npos || (slash != string::npos && dot < slash)) {
+    return input + "-out";
+  } else {
+    return input.substr(0, dot) + "-out" + input.substr(dot);
+  }
+}
+
+/**
+ * A worker, rendering files with its own DSP instance
+ */
+class Renderer
+{
+  dsp* fDSP;
+  CMDUI* fInterface;
+  int fBlockSize;
+  int fAppend;
+
+public:
+
+  Renderer(dsp* DSP, int argc, char* argv[], int block_size, int nAppend)
+    : fDSP(DSP), fBlockSize(block_size), fAppend(nAppend)
+  {
+    fInterface = new CMDUI(argc, argv);
+    fDSP->buildUserInterface(fInterface);
+  }
+
+  ~Renderer()
+  {
+    delete fInterface;
+  }
+
+  /**
+   * Render one file, returns the duration of the rendered audio and the time it took (in seconds)
+   */
+  bool render(const string& in_name, const string& out_name, double& duration, double& elapsed, string& error)
+  {
+    SF_INFO in_info;
+    in_info.format = 0;
+    SNDFILE* in_sf = sf_open(in_name.c_str(), SFM_READ, &in_info);
+    if (in_sf == NULL) {
+      error = sf_strerror(NULL);
+      return false;
+    }
+
+    SF_INFO out_info = in_info;
+    out_info.channels = fDSP->getNumOutputs();
+    SNDFILE* out_sf = sf_open(out_name.c_str(), SFM_WRITE, &out_info);
+    if (out_sf == NULL) {
+      error = sf_strerror(NULL);
+      sf_close(in_sf);
+      return false;
+    }
+
+    double start = getSeconds();
+
+    // init signal processor
+    fDSP->init(in_info.samplerate);
+    fInterface->process_init();
+
+    // two sets of buffers : one is computed while the other one is written and refilled
+    Separator sep0(fBlockSize, in_info.channels, fDSP->getNumInputs());
+    Separator sep1(fBlockSize, in_info.channels, fDSP->getNumInputs());
+    Interleaver ilv0(fBlockSize, fDSP->getNumOutputs());
+    Interleaver ilv1(fBlockSize, fDSP->getNumOutputs());
+    Separator* sep[2] = { &sep0, &sep1 };
+    Interleaver* ilv[2] = { &ilv0, &ilv1 };
+
+    long frames = 0;
+    int cur = 0;
+    int prev_nbf = 0;
+    int nbf = READ_SAMPLE(in_sf, sep[cur]->input(), fBlockSize);
+
+    while (nbf > 0) {
+      // write the previous block and read the next one while computing the current one
+      int next = 1 - cur;
+      bool last = (nbf < fBlockSize);
+      future<int> io = async(launch::async, [=]() {
+        if (prev_nbf > 0) WRITE_SAMPLE(out_sf, ilv[next]->output(), prev_nbf);
+        return last ? 0 : int(READ_SAMPLE(in_sf, sep[next]->input(), fBlockSize));
+      });
+
+      sep[cur]->separate(nbf);
+      fDSP->compute(nbf, sep[cur]->outputs(), ilv[cur]->inputs());
+      ilv[cur]->interleave(nbf);
+      frames += nbf;
+
+      prev_nbf = nbf;
+      nbf = io.get();
+      cur = next;
+    }
+    if (prev_nbf > 0) {
+      WRITE_SAMPLE(out_sf, ilv[1 - cur]->output(), prev_nbf);
+    }
+
+    sf_close(in_sf);
+
+    // compute tail, if any
+    for (int remain = fAppend; remain > 0; remain -= fBlockSize) {
+      int count = min(remain, fBlockSize);
+      FAUSTFLOAT** inputs = sep0.outputs();
+      for (int c = 0; c < fDSP->getNumInputs(); c++) {
+        memset(inputs[c], 0, sizeof(FAUSTFLOAT) * count);
+      }
+      fDSP->compute(count, inputs, ilv0.inputs());
+      ilv0.interleave(count);
+      WRITE_SAMPLE(out_sf, ilv0.output(), count);
+      frames += count;
+    }
+
+    sf_close(out_sf);
+
+    elapsed = getSeconds() - start;
+    duration = double(frames) / double(in_info.samplerate);
+    return true;
+  }
+};
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    fprintf(stderr, "*** USAGE: %s [--jobs <n>] [--block-size <frames>] [--continue <frames>] [--output-dir <dir>] input_soundfile...\n", argv[0]);
+    exit(1);
+  }
+
+  int nAppend = loptrm(&argc, argv, "--continue", "-c", 0);
+  int jobs = loptrm(&argc, argv, "--jobs", "-j", max(1, int(thread::hardware_concurrency())));
+  int block_size = loptrm(&argc, argv, "--block-size", "-bs", kBlockFrames);
+  const char* output_dir = soptrm(&argc, argv, "--output-dir", "-od", NULL);
+
+  CMDUI* interface = new CMDUI(argc, argv);
+  DSP.buildUserInterface(interface);
+  interface->process_command();
+
+  int nfiles = int(interface->files());
+  if (nfiles == 0) {
+    fprintf(stderr, "*** No input file.\n");
+    exit(1);
+  }
+  jobs = max(1, min(jobs, nfiles));
+
+  // one DSP clone per worker (the first one uses the global DSP)
+  vector<dsp*> dsps;
+  vector<Renderer*> renderers;
+  for (int i = 0; i < jobs; i++) {
+    dsps.push_back((i == 0) ? static_cast<dsp*>(&DSP) : DSP.clone());
+    renderers.push_back(new Renderer(dsps[i], argc, argv, block_size, nAppend));
+  }
+
+  atomic<int> next_file(0);
+  atomic<int> failed(0);
+  double total_duration = 0;
+  mutex print_mutex;
+  double start = getSeconds();
+
+  auto work = [&](Renderer* renderer) {
+    for (int f = next_file++; f < nfiles; f = next_file++) {
+      string in_name = interface->file(f);
+      string out_name = outputFile(in_name, output_dir);
+      double duration = 0, elapsed = 0;
+      string error;
+      bool res = renderer->render(in_name, out_name, duration, elapsed, error);
+      lock_guard<mutex> lock(print_mutex);
+      if (res) {
+        total_duration += duration;
+        printf("%s -> %s : %.2f s in %.3f s (realtime factor %.1f)\n",
+               in_name.c_str(), out_name.c_str(), duration, elapsed, duration / max(elapsed, 1e-9));
+      } else {
+        failed++;
+        fprintf(stderr, "*** %s : %s\n", in_name.c_str(), error.c_str());
+      }
+    }
+  };
+
+  vector<thread> workers;
+  for (int i = 1; i < jobs; i++) {
+    workers.push_back(thread(work, renderers[i]));
+  }
+  work(renderers[0]);
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+
+  double elapsed = getSeconds() - start;
+  printf("%d files, %d jobs : %.2f s in %.3f s (realtime factor %.1f)\n",
+         nfiles, jobs, total_duration, elapsed, total_duration / max(elapsed, 1e-9));
+
+  for (int i = 0; i < jobs; i++) {
+    delete renderers[i];
+    if (i > 0) delete dsps[i];
+  }
+  delete interface;
+  return (failed > 0) ? 1 : 0;
+}
+
+/********************END ARCHITECTURE SECTION (part 2/2)****************/
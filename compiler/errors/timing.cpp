@@ -20,73 +20,174 @@
  ************************************************************************/
 
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #ifndef _WIN32
-#include <sys/time.h>
+#include <sys/resource.h>
 #endif
 #include "Text.hh"
 #include "compatibility.hh"
 #include "global.hh"
 #include "timing.hh"
+#include "tree.hh"
 
 // Timing can be used outside of the scope of 'gGlobal'
 bool     gTimingSwitch;
+string   gTimingTraceFile;
 int      gTimingIndex;
 double   gStartTime[1024];
 double   gEndTime[1024];
 ostream* gTimingLog = 0;
 
-#ifndef _WIN32
+// Counters at the start of each running phase
+static size_t gStartTrees[1024];
+static size_t gStartLookups[1024];
+
+// Ended phases, kept for the trace file
+struct TimingEvent {
+    string fName;
+    double fStart;     // in sec, from the first phase start
+    double fDuration;  // in sec
+    size_t fTrees;     // trees created during the phase
+    size_t fLookups;   // property lookups done during the phase
+    long   fPeakRSS;   // peak resident set size at the end of the phase, in KB
+};
+
+static vector<TimingEvent> gTimingEvents;
+static double              gTimingOrigin = -1;
+
 double mysecond()
 {
-    struct timeval  tp;
-    struct timezone tzp;
-    gettimeofday(&tp, &tzp);
-    return ((double)tp.tv_sec + (double)tp.tv_usec * 1.e-6);
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-#else
-double mysecond()
+static long getPeakRSS()
 {
+#ifndef _WIN32
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return long(usage.ru_maxrss / 1024);  // in bytes on OSX
+#else
+    return long(usage.ru_maxrss);
+#endif
+#else
     return 0;
-}
 #endif
+}
+
+static string escapeJSON(const string& str)
+{
+    string res;
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '"' || str[i] == '\\') res += '\\';
+        res += str[i];
+    }
+    return res;
+}
+
+void initTiming()
+{
+    gTimingSwitch    = false;
+    gTimingTraceFile = "";
+    gTimingIndex     = 0;
+    gTimingOrigin    = -1;
+    gTimingEvents.clear();
+    CTree::gCountLookups    = false;
+    CTree::gTreeCount       = 0;
+    CTree::gPropertyLookups = 0;
+}
+
+// Write all ended phases in Chrome trace format (chrome://tracing or https://ui.perfetto.dev)
+void writeTimingTrace()
+{
+    if (gTimingTraceFile == "") return;
+
+    ofstream out(gTimingTraceFile.c_str());
+    if (!out.is_open()) {
+        cerr << "WARNING : timing trace file '" << gTimingTraceFile << "' cannot be opened" << endl;
+        return;
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"otherData\": {\"trees\": " << CTree::gTreeCount
+        << ", \"property_lookups\": " << CTree::gPropertyLookups << ", \"peak_rss_kb\": " << getPeakRSS() << "},";
+    out << "\n\"traceEvents\": [";
+    for (size_t i = 0; i < gTimingEvents.size(); i++) {
+        const TimingEvent& event = gTimingEvents[i];
+        long               ts    = long(event.fStart * 1e6);
+        long               end   = long((event.fStart + event.fDuration) * 1e6);
+        out << ((i == 0) ? "\n" : ",\n");
+        out << "{\"name\": \"" << escapeJSON(event.fName) << "\", \"cat\": \"faust\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+            << "\"ts\": " << ts << ", \"dur\": " << (end - ts) << ", \"args\": {\"trees\": " << event.fTrees
+            << ", \"property_lookups\": " << event.fLookups << ", \"peak_rss_kb\": " << event.fPeakRSS << "}},\n";
+        // Memory counter track
+        out << "{\"name\": \"peak_rss_kb\", \"ph\": \"C\", \"pid\": 1, \"ts\": " << end
+            << ", \"args\": {\"value\": " << event.fPeakRSS << "}}";
+    }
+    out << "\n]}" << endl;
+}
+
+static bool isTimingActive()
+{
+    return gTimingSwitch || (gTimingTraceFile != "");
+}
 
 void startTiming(const char* msg)
 {
     // timing
-    gTimingLog = (getenv("FAUST_TIMING")) ? new ofstream("FAUST_TIMING_LOG", ios::app) : NULL;
+    if (!gTimingLog && getenv("FAUST_TIMING")) {
+        gTimingLog = new ofstream("FAUST_TIMING_LOG", ios::app);
+    }
     if (gTimingLog) {
         *gTimingLog << endl;
     }
 
-    if (gTimingSwitch) {
+    if (isTimingActive()) {
         faustassert(gTimingIndex < 1023);
-        if (gTimingLog) {
-            tab(gTimingIndex, *gTimingLog);
-            *gTimingLog << "start " << msg << endl;
-        } else {
-            tab(gTimingIndex, cerr);
-            cerr << "start " << msg << endl;
+        if (gTimingSwitch) {
+            if (gTimingLog) {
+                tab(gTimingIndex, *gTimingLog);
+                *gTimingLog << "start " << msg << endl;
+            } else {
+                tab(gTimingIndex, cerr);
+                cerr << "start " << msg << endl;
+            }
         }
-        gStartTime[gTimingIndex++] = mysecond();
+        CTree::gCountLookups        = true;
+        gStartTrees[gTimingIndex]   = CTree::gTreeCount;
+        gStartLookups[gTimingIndex] = CTree::gPropertyLookups;
+        gStartTime[gTimingIndex++]  = mysecond();
+        if (gTimingOrigin < 0) gTimingOrigin = gStartTime[gTimingIndex - 1];
     }
 }
 
 void endTiming(const char* msg)
 {
-    if (gTimingSwitch) {
+    if (isTimingActive()) {
         faustassert(gTimingIndex > 0);
         gEndTime[--gTimingIndex] = mysecond();
-        if (gTimingLog) {
-            *gTimingLog << msg << "\t" << gEndTime[gTimingIndex] - gStartTime[gTimingIndex] << endl;
-            gTimingLog->flush();
-        } else {
-            tab(gTimingIndex, cerr);
-            cerr << "end " << msg << " (duration : " << gEndTime[gTimingIndex] - gStartTime[gTimingIndex] << ")"
-                 << endl;
+        if (gTimingSwitch) {
+            if (gTimingLog) {
+                *gTimingLog << msg << "\t" << gEndTime[gTimingIndex] - gStartTime[gTimingIndex] << endl;
+                gTimingLog->flush();
+            } else {
+                tab(gTimingIndex, cerr);
+                cerr << "end " << msg << " (duration : " << gEndTime[gTimingIndex] - gStartTime[gTimingIndex] << ")"
+                     << endl;
+            }
+        }
+        if (gTimingTraceFile != "") {
+            TimingEvent event;
+            event.fName     = msg;
+            event.fStart    = gStartTime[gTimingIndex] - gTimingOrigin;
+            event.fDuration = gEndTime[gTimingIndex] - gStartTime[gTimingIndex];
+            event.fTrees    = CTree::gTreeCount - gStartTrees[gTimingIndex];
+            event.fLookups  = CTree::gPropertyLookups - gStartLookups[gTimingIndex];
+            event.fPeakRSS  = getPeakRSS();
+            gTimingEvents.push_back(event);
         }
     }
 }
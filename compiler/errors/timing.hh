@@ -28,4 +28,11 @@
 void startTiming(const char* msg);
 void endTiming(const char* msg);
 
+// reset the timing state at the start of each compilation (timing is kept outside of 'gGlobal')
+void initTiming();
+
+// write the ended phases in the trace file (-tt option), at the end of the compilation
+// (and again after the JIT compilation of an LLVM factory)
+void writeTimingTrace();
+
 #endif
@@ -19,6 +19,8 @@
  ************************************************************************
  ************************************************************************/
 
+#include <stdint.h>
+
 #include "environment.hh"
 #include "boxes.hh"
 #include "errormsg.hh"
@@ -37,15 +39,163 @@
 // different
 //-----------------------------------------------------------------------------
 
+//-----------------------flattened environment index---------------------------
+//
+// To make the lookup independent of the number of layers, each layer also
+// has an index of all the definitions visible from it : a persistent hash
+// trie (hash array mapped trie) where a new layer starts with the index of
+// its parent, and adding a definition only copies the path to its leaf, the
+// rest of the trie being shared with the parent. Each indexed definition
+// keeps the layer where it is stored, and the number of barriers below this
+// layer, so that searchIdDef can stop at the first barrier.
+//-----------------------------------------------------------------------------
+
+struct EnvDef {
+    Tree fId;
+    Tree fDef;
+    Tree fLayer;     // the layer where the definition is stored
+    int  fBarriers;  // the number of barriers below this layer
+};
+
+static const int kEnvTrieBits = 5;
+
+// A trie node : a definition or a sub-trie for each used slot of the bitmap,
+// or a list of definitions with the same full hash (when all the hash bits are used)
+struct EnvTrie : public Garbageable {
+    unsigned int     fBitmap;
+    vector<EnvTrie*> fChildren;  // null for a definition slot
+    vector<EnvDef>   fDefs;
+
+    EnvTrie() : fBitmap(0) {}
+};
+
+struct EnvIndex : public Garbageable {
+    EnvTrie* fRoot;
+    int      fBarriers;  // the number of barriers in the environment
+
+    EnvIndex() : fRoot(nullptr), fBarriers(0) {}
+};
+
+static uint64_t envHash(Tree id)
+{
+    // Mix the tree hash key so that all its bits are used by the trie
+    uint64_t h = uint64_t(id->hashkey());
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static int popCount(unsigned int bits)
+{
+    int n = 0;
+    for (; bits; bits &= bits - 1) n++;
+    return n;
+}
+
+/**
+ * Return a new trie with the definition added (or replaced), sharing all the untouched nodes with the old one.
+ */
+static EnvTrie* envTrieAdd(EnvTrie* trie, const EnvDef& def, uint64_t hash, int shift)
+{
+    EnvTrie* res = (trie) ? new EnvTrie(*trie) : new EnvTrie();
+
+    if (shift >= 64) {
+        // All hash bits are used : list of definitions
+        for (size_t i = 0; i < res->fDefs.size(); i++) {
+            if (res->fDefs[i].fId == def.fId) {
+                res->fDefs[i] = def;
+                return res;
+            }
+        }
+        res->fDefs.push_back(def);
+        res->fChildren.push_back(nullptr);
+        return res;
+    }
+
+    unsigned int bit = 1u << ((hash >> shift) & ((1 << kEnvTrieBits) - 1));
+    int          pos = popCount(res->fBitmap & (bit - 1));
+
+    if (!(res->fBitmap & bit)) {
+        res->fBitmap |= bit;
+        res->fChildren.insert(res->fChildren.begin() + pos, nullptr);
+        res->fDefs.insert(res->fDefs.begin() + pos, def);
+    } else if (res->fChildren[pos]) {
+        res->fChildren[pos] = envTrieAdd(res->fChildren[pos], def, hash, shift + kEnvTrieBits);
+    } else if (res->fDefs[pos].fId == def.fId) {
+        res->fDefs[pos] = def;
+    } else {
+        // Two definitions in the same slot : move them in a sub-trie
+        EnvTrie* sub = envTrieAdd(nullptr, res->fDefs[pos], envHash(res->fDefs[pos].fId), shift + kEnvTrieBits);
+        res->fChildren[pos] = envTrieAdd(sub, def, hash, shift + kEnvTrieBits);
+    }
+    return res;
+}
+
+static const EnvDef* envTrieFind(EnvTrie* trie, Tree id)
+{
+    uint64_t hash = envHash(id);
+    for (int shift = 0; trie; shift += kEnvTrieBits) {
+        if (shift >= 64) {
+            for (size_t i = 0; i < trie->fDefs.size(); i++) {
+                if (trie->fDefs[i].fId == id) return &trie->fDefs[i];
+            }
+            return nullptr;
+        }
+        unsigned int bit = 1u << ((hash >> shift) & ((1 << kEnvTrieBits) - 1));
+        if (!(trie->fBitmap & bit)) return nullptr;
+        int pos = popCount(trie->fBitmap & (bit - 1));
+        if (!trie->fChildren[pos]) {
+            return (trie->fDefs[pos].fId == id) ? &trie->fDefs[pos] : nullptr;
+        }
+        trie = trie->fChildren[pos];
+    }
+    return nullptr;
+}
+
+/**
+ * Get the index of an environment : the one kept by a layer,
+ * or the one of its parent for a barrier.
+ */
+static EnvIndex getEnvIndex(Tree lenv)
+{
+    if (isNil(lenv)) {
+        return EnvIndex();
+    } else if (lenv->node() == Node(gGlobal->BARRIER)) {
+        EnvIndex index = getEnvIndex(lenv->branch(0));
+        index.fBarriers++;
+        return index;
+    } else {
+        return *static_cast<EnvIndex*>(lenv->branch(1)->node().getPointer());
+    }
+}
+
 /**
  * Push a new (unique) empty layer (where multiple definitions can be stored)
- * on top of an existing environment.
+ * on top of an existing environment. The layer keeps its own index, starting
+ * as the one of the old environment : the index pointer also makes the layer
+ * unique, without growing the symbol table.
  * @param lenv the old environment
  * @return the new environment
  */
 static Tree pushNewLayer(Tree lenv)
 {
-    return tree(unique("ENV_LAYER"), lenv);
+    EnvIndex* index = new EnvIndex(getEnvIndex(lenv));
+    return tree(gGlobal->ENVLAYER, lenv, tree(Node(index)));
+}
+
+/**
+ * Store a definition in a layer and in its index.
+ * @param id the symbol id to be defined
+ * @param def the definition to be binded to the symbol id
+ * @param lenv the layer
+ */
+static void setLayerDef(Tree id, Tree def, Tree lenv)
+{
+    setProperty(lenv, id, def);
+    EnvIndex* index = static_cast<EnvIndex*>(lenv->branch(1)->node().getPointer());
+    EnvDef    edef  = {id, def, lenv, index->fBarriers};
+    index->fRoot    = envTrieAdd(index->fRoot, edef, envHash(id), 0);
 }
 
 /**
@@ -96,7 +246,7 @@ static void addLayerDef(Tree id, Tree def, Tree lenv)
             throw faustexception(error.str());
         }
     }
-    setProperty(lenv, id, def);
+    setLayerDef(id, def, lenv);
 }
 
 /**
@@ -148,13 +298,37 @@ Tree pushMultiClosureDefs(Tree ldefs, Tree visited, Tree lenv)
  */
 bool searchIdDef(Tree id, Tree& def, Tree lenv)
 {
-    // search the environment until a definition is found
-    // or a barrier (or nil) is reached
+    // the closest definition, if not separated from the environment by a barrier
+    if (isEnvBarrier(lenv)) return false;
+    EnvIndex      index = getEnvIndex(lenv);
+    const EnvDef* edef  = envTrieFind(index.fRoot, id);
+    if (edef && edef->fBarriers == index.fBarriers) {
+        def = edef->fDef;
+        return true;
+    } else {
+        return false;
+    }
+}
 
-    while (!isEnvBarrier(lenv) && !getProperty(lenv, id, def)) {
-        lenv = lenv->branch(0);
+/**
+ * Search the environment (including after barriers) for the definition
+ * of a symbol ID, with a cost independent of the number of layers.
+ * @param id the symbol ID to search
+ * @param def where to store the definition if any
+ * @param layer where to store the layer of the definition if any
+ * @param lenv the environment
+ * @return true if a definition was found
+ */
+bool findIdDef(Tree id, Tree& def, Tree& layer, Tree lenv)
+{
+    const EnvDef* edef = envTrieFind(getEnvIndex(lenv).fRoot, id);
+    if (edef) {
+        def   = edef->fDef;
+        layer = edef->fLayer;
+        return true;
+    } else {
+        return false;
     }
-    return !isEnvBarrier(lenv);
 }
 
 /**
@@ -190,7 +364,7 @@ Tree copyEnvReplaceDefs(Tree anEnv, Tree ldefs, Tree visited, Tree curEnv)
     updateClosures(clos, anEnv, copyEnv);      // update the closures replacing oldEnv with newEnv
 
     for (unsigned int i = 0; i < clos.size(); i++) {  // transfers the updated definitions to the new environment
-        setProperty(copyEnv, ids[i], clos[i]);
+        setLayerDef(ids[i], clos[i], copyEnv);
     }
 
     while (!isNil(ldefs)) {  // replace the old definitions with the new ones
@@ -201,7 +375,7 @@ Tree copyEnvReplaceDefs(Tree anEnv, Tree ldefs, Tree visited, Tree curEnv)
         stringstream s;
         s << boxpp(id);
         if (!isBoxCase(rhs)) setDefNameProperty(cl, s.str());
-        setProperty(copyEnv, id, cl);
+        setLayerDef(id, cl, copyEnv);
         ldefs = tl(ldefs);
     }
     return copyEnv;
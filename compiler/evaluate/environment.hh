@@ -28,6 +28,8 @@ Tree pushValueDef(Tree id, Tree def, Tree lenv);
 
 bool searchIdDef(Tree id, Tree& def, Tree lenv);
 
+bool findIdDef(Tree id, Tree& def, Tree& layer, Tree lenv);
+
 Tree pushMultiClosureDefs(Tree ldefs, Tree visited, Tree lenv);
 
 Tree copyEnvReplaceDefs(Tree anEnv, Tree ldefs, Tree visited, Tree curEnv);
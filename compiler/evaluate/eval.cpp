@@ -1184,16 +1184,12 @@ static Tree larg2par(Tree larg)
  */
 static Tree evalIdDef(Tree id, Tree visited, Tree lenv)
 {
-    Tree def  = NULL;
-    Tree name = NULL;
+    Tree def   = NULL;
+    Tree name  = NULL;
+    Tree layer = NULL;
 
-    // search the environment env for a definition of symbol id
-    while (!isNil(lenv) && !getProperty(lenv, id, def)) {
-        lenv = lenv->branch(0);
-    }
-
-    // check that the definition exists
-    if (isNil(lenv)) {
+    // search the environment env for a definition of symbol id, and check that the definition exists
+    if (!findIdDef(id, def, layer, lenv)) {
         if (hasDefProp(id)) {
             stringstream error;
             error << "ERROR : " << *id << " is defined here : " << getDefFileProp(id) << ":" << getDefLineProp(id)
@@ -1206,7 +1202,7 @@ static Tree evalIdDef(Tree id, Tree visited, Tree lenv)
 
     // cerr << "Id definition is " << *def << endl;
     // check that it is not a recursive definition
-    Tree p = cons(id, lenv);
+    Tree p = cons(id, layer);
     // set the definition name property
     faustassert(def);
     if (!getDefNameProperty(def, name)) {
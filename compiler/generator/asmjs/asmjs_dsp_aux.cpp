@@ -52,6 +52,8 @@ EXPORT asmjs_dsp_factory* createAsmDSPFactoryFromFile(const string& filename, in
 EXPORT asmjs_dsp_factory* createAsmDSPFactoryFromString(const string& name_app, const string& dsp_content, int argc,
                                                         const char* argv[], string& error_msg)
 {
+    LOCK_API
+
     string expanded_dsp_content = "";
     string sha_key              = "";
 
@@ -73,8 +75,7 @@ EXPORT asmjs_dsp_factory* createAsmDSPFactoryFromString(const string& name_app,
         compileFaustFactory(argc1, argv1, name_app.c_str(), dsp_content.c_str(), error_msg, true);
     if (dsp_factory_aux) {
         asmjs_dsp_factory* factory = new asmjs_dsp_factory(dsp_factory_aux);
-        gAsmjsFactoryTable.setFactory(factory);
-        factory->setSHAKey(sha_key);
+        gAsmjsFactoryTable.setFactory(factory, sha_key);
         factory->setDSPCode(expanded_dsp_content);
         return factory;
     } else {
@@ -84,6 +85,7 @@ EXPORT asmjs_dsp_factory* createAsmDSPFactoryFromString(const string& name_app,
 
 EXPORT bool deleteAsmjsDSPFactory(asmjs_dsp_factory* factory)
 {
+    LOCK_API
     return (factory) ? gAsmjsFactoryTable.deleteDSPFactory(factory) : false;
 }
 
@@ -28,6 +28,7 @@
 #include "global.hh"
 #include "recursivness.hh"
 #include "text_instructions.hh"
+#include "timing.hh"
 #include "type_manager.hh"
 
 using namespace std;
@@ -670,6 +671,17 @@ void CodeContainer::processFIR(void)
     fDeclarationInstructions->fCode.sort(sortArrayDeclarations);
     fDeclarationInstructions->fCode.sort(sortTypeDeclarations);
     */
+
+    // Possibly reorder struct fields by access location (DSP loops, control code, init)
+    if (gGlobal->gStructLayoutSwitch) {
+        startTiming("StructLayout");
+        StructVarCounter hot;
+        transformDAG(&hot);
+        StructVarCounter control;
+        fComputeBlockInstructions->accept(&control);
+        fDeclarationInstructions = StructLayout::getCode(fDeclarationInstructions, hot.fAccess, control.fAccess);
+        endTiming("StructLayout");
+    }
 }
 
 BlockInst* CodeContainer::flattenFIR(void)
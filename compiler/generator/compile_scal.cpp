@@ -116,7 +116,9 @@ Tree ScalarCompiler::prepare(Tree LS)
     Tree L2b = SK.mapself(L2);
     endTiming("Constant propagation");
 
+    startTiming("privatise");
     Tree L3 = privatise(L2b);  // Un-share tables with multiple writers
+    endTiming("privatise");
 
     conditionAnnotation(L3);
     // conditionStatistics(L3);        // count condition occurences
@@ -127,19 +129,25 @@ Tree ScalarCompiler::prepare(Tree LS)
         throw faustexception("Dump normal form finished...\n");
     }
 
+    startTiming("recursivnessAnnotation");
     recursivnessAnnotation(L3);  // Annotate L3 with recursivness information
+    endTiming("recursivnessAnnotation");
 
     startTiming("typeAnnotation");
     typeAnnotation(L3, true);  // Annotate L3 with type information
     endTiming("typeAnnotation");
 
+    startTiming("sharingAnalysis");
     sharingAnalysis(L3);  // annotate L3 with sharing count
+    endTiming("sharingAnalysis");
 
+    startTiming("occurrences analysis");
     if (fOccMarkup != 0) {
         delete fOccMarkup;
     }
     fOccMarkup = new old_OccMarkup(fConditionProperty);
     fOccMarkup->mark(L3);  // annotate L3 with occurences analysis
+    endTiming("occurrences analysis");
 
     endTiming("ScalarCompiler::prepare");
 
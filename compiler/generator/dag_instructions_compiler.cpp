@@ -120,7 +120,9 @@ void DAGInstructionsCompiler::compileMultiSignal(Tree L)
     }
 
     // Apply FIR to FIR transformations
+    startTiming("processFIR");
     fContainer->processFIR();
+    endTiming("processFIR");
 
     // Generate JSON
     if (gGlobal->gPrintJSONSwitch) {
@@ -314,6 +316,12 @@ ValueInst* DAGInstructionsCompiler::generateCacheCode(Tree sig, ValueInst* exp)
                 if (d < gGlobal->gMaxCopyDelay) {
                     // return subst("$0[i]", vname);
                     return InstBuilder::genLoadArrayVar(vname, var_access, getCurrentLoopIndex());
+                } else if (isWrapFreeDelay(d)) {
+                    // we use a wrap-free ring buffer
+                    string vname_idx = vname + "_idx";
+                    // return subst("$0[$0_idx+i]", vname);
+                    FIRIndex index1 = getCurrentLoopIndex() + InstBuilder::genLoadStructVar(vname_idx);
+                    return InstBuilder::genLoadArrayStructVar(vname, index1);
                 } else {
                     // we use a ring buffer
                     string vname_idx = vname + "_idx";
@@ -452,6 +460,27 @@ ValueInst* DAGInstructionsCompiler::generateFixDelay(Tree sig, Tree exp, Tree de
             FIRIndex index = getCurrentLoopIndex() - CS(delay);
             return generateCacheCode(sig, InstBuilder::genLoadArrayStackVar(vname, index));
         }
+    } else if (isWrapFreeDelay(mxd)) {
+        // long delay : we use a wrap-free ring buffer, reads are never masked
+        string vname_idx = vname + "_idx";
+
+        if (isSigInt(delay, &d)) {
+            if (d == 0) {
+                // return subst("$0[$0_idx+i]", vname);
+                FIRIndex index1 = getCurrentLoopIndex() + InstBuilder::genLoadStructVar(vname_idx);
+                return generateCacheCode(sig, InstBuilder::genLoadArrayStructVar(vname, index1));
+            } else {
+                // return subst("$0[$0_idx+i-$1]", vname, T(d));
+                FIRIndex index1 = getCurrentLoopIndex() + InstBuilder::genLoadStructVar(vname_idx);
+                FIRIndex index2 = index1 - InstBuilder::genInt32NumInst(d);
+                return generateCacheCode(sig, InstBuilder::genLoadArrayStructVar(vname, index2));
+            }
+        } else {
+            // return subst("$0[$0_idx+i-$1]", vname, CS(delay));
+            FIRIndex index1 = getCurrentLoopIndex() + InstBuilder::genLoadStructVar(vname_idx);
+            FIRIndex index2 = index1 - CS(delay);
+            return generateCacheCode(sig, InstBuilder::genLoadArrayStructVar(vname, index2));
+        }
     } else {
         // long delay : we use a ring buffer of size 2^x
         int    N         = pow2limit(mxd + gGlobal->gVecSize);
@@ -566,6 +595,47 @@ void DAGInstructionsCompiler::generateDlineLoop(Typed::VarType ctype, const stri
         // Set desired variable access
         var_access = Address::kStack;
 
+    } else if (isWrapFreeDelay(delay)) {
+        // Implementation of a wrap-free ring-buffer delayline : the 'delay' last samples are kept in front of
+        // the current block, so that reads and writes never need index masking. When the remaining room
+        // is too small for a new block, the history is moved back at the beginning of the buffer.
+        int size = 2 * delay + gGlobal->gVecSize;
+
+        // create names for temporary and permanent storage
+        string idx      = subst("$0_idx", vname);
+        string idx_save = subst("$0_idx_save", vname);
+
+        // allocate permanent storage for delayed samples
+        pushClearMethod(generateInitArray(vname, ctype, size));
+        pushDeclare(InstBuilder::genDecStructVar(idx, InstBuilder::genBasicTyped(Typed::kInt32)));
+        pushDeclare(InstBuilder::genDecStructVar(idx_save, InstBuilder::genBasicTyped(Typed::kInt32)));
+
+        // init permanent memory
+        pushClearMethod(InstBuilder::genStoreStructVar(idx, InstBuilder::genInt32NumInst(delay)));
+        pushClearMethod(InstBuilder::genStoreStructVar(idx_save, InstBuilder::genInt32NumInst(0)));
+
+        // -- update index
+        FIRIndex index1 = FIRIndex(InstBuilder::genLoadStructVar(idx)) + InstBuilder::genLoadStructVar(idx_save);
+        pushComputePreDSPMethod(InstBuilder::genStoreStructVar(idx, index1));
+
+        // -- move history back when the block does not fit anymore
+        FIRIndex   index2 = FIRIndex(InstBuilder::genLoadStructVar(idx)) + InstBuilder::genLoadLoopVar("vsize");
+        BlockInst* block  = InstBuilder::genBlockInst();
+        block->pushBackInst(generateWrapFreeShift(vname, idx, delay));
+        block->pushBackInst(InstBuilder::genStoreStructVar(idx, InstBuilder::genInt32NumInst(delay)));
+        pushComputePreDSPMethod(
+            InstBuilder::genIfInst(InstBuilder::genGreaterThan(index2, InstBuilder::genInt32NumInst(size)), block));
+
+        // -- compute the new samples
+        FIRIndex index3 = getCurrentLoopIndex() + InstBuilder::genLoadStructVar(idx);
+        pushComputeDSPMethod(InstBuilder::genStoreArrayStructVar(vname, index3, exp));
+
+        // -- save index
+        pushComputePostDSPMethod(InstBuilder::genStoreStructVar(idx_save, InstBuilder::genLoadLoopVar("vsize")));
+
+        // Set desired variable access
+        var_access = Address::kStruct;
+
     } else {
         // Implementation of a ring-buffer delayline, the size should be large enough and aligned on a power of two
         delay = pow2limit(delay + gGlobal->gVecSize);
@@ -623,6 +693,25 @@ StatementInst* DAGInstructionsCompiler::generateCopyBackArray(const string& vnam
     return loop;
 }
 
+StatementInst* DAGInstructionsCompiler::generateWrapFreeShift(const string& vname, const string& vname_idx, int delay)
+{
+    string index = gGlobal->getFreshID("j");
+
+    // Generates history move loop
+    DeclareVarInst* loop_decl =
+        InstBuilder::genDecLoopVar(index, InstBuilder::genBasicTyped(Typed::kInt32), InstBuilder::genInt32NumInst(0));
+    ValueInst*    loop_end       = InstBuilder::genLessThan(loop_decl->load(), InstBuilder::genInt32NumInst(delay));
+    StoreVarInst* loop_increment = loop_decl->store(InstBuilder::genAdd(loop_decl->load(), 1));
+
+    ForLoopInst* loop = InstBuilder::genForLoopInst(loop_decl, loop_end, loop_increment);
+
+    FIRIndex   load_index = FIRIndex(InstBuilder::genLoadStructVar(vname_idx)) - delay + loop_decl->load();
+    ValueInst* load_value = InstBuilder::genLoadArrayStructVar(vname, load_index);
+
+    loop->pushFrontInst(InstBuilder::genStoreArrayStructVar(vname, loop_decl->load(), load_value));
+    return loop;
+}
+
 ValueInst* DAGInstructionsCompiler::generateWaveform(Tree sig)
 {
     string vname;
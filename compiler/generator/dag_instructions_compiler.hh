@@ -55,9 +55,16 @@ class DAGInstructionsCompiler : public InstructionsCompiler {
                                          Address::AccessType& var_access);
 
     StatementInst* generateCopyBackArray(const string& vname_to, const string& vname_from, int size);
+    StatementInst* generateWrapFreeShift(const string& vname, const string& vname_idx, int delay);
 
     // private helper functions
     bool needSeparateLoop(Tree sig);
+
+    // long delay lines accessed without index masking
+    bool isWrapFreeDelay(int delay)
+    {
+        return (gGlobal->gWrapFreeDelay > 0) && (delay >= gGlobal->gWrapFreeDelay);
+    }
 };
 
 #endif
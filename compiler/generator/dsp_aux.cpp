@@ -42,6 +42,9 @@ using namespace std;
 // Used by LLVM backend (for now)
 Soundfile* dynamic_defaultsound = new Soundfile(64);
 
+// Global API access lock
+TLockAble* gDSPFactoriesLock = nullptr;
+
 // Look for 'key' in 'options' and modify the parameter 'position' if found
 static bool parseKey(vector<string> options, const string& key, int& position)
 {
@@ -122,17 +125,21 @@ static vector<string> reorganizeCompilationOptionsAux(vector<string>& options)
     //------STEP3 - Add options depending on -vec/-scal option
     if (vectorize || addKeyIfExisting(options, newoptions, "-vec", "", position)) {
         addKeyIfExisting(options, newoptions, "-dfs", "", position);
+        addKeyIfExisting(options, newoptions, "-fl", "", position);
         addKeyIfExisting(options, newoptions, "-vls", "", position);
         addKeyIfExisting(options, newoptions, "-fun", "", position);
         addKeyIfExisting(options, newoptions, "-g", "", position);
         addKeyValueIfExisting(options, newoptions, "-vs", "32");
         addKeyValueIfExisting(options, newoptions, "-lv", "0");
+        addKeyValueIfExisting(options, newoptions, "-wfd", "0");
+        addKeyValueIfExisting(options, newoptions, "-la", "0");
     } else {
         addKeyIfExisting(options, newoptions, "-scal", "-scal", position);
         addKeyIfExisting(options, newoptions, "-inpl", "", position);
     }
 
     addKeyValueIfExisting(options, newoptions, "-mcd", "16");
+    addKeyIfExisting(options, newoptions, "-sl", "", position);
     addKeyValueIfExisting(options, newoptions, "-cn", "");
     addKeyValueIfExisting(options, newoptions, "-ftz", "0");
 
@@ -214,6 +221,24 @@ string reorganizeCompilationOptions(int argc, const char* argv[])
 
 // External C++ libfaust API
 
+EXPORT bool startMTDSPFactories()
+{
+    try {
+        if (!gDSPFactoriesLock) {
+            gDSPFactoriesLock = new TLockAble();
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+EXPORT void stopMTDSPFactories()
+{
+    delete gDSPFactoriesLock;
+    gDSPFactoriesLock = nullptr;
+}
+
 EXPORT string expandDSPFromFile(const string& filename, int argc, const char* argv[], string& sha_key,
                                 string& error_msg)
 {
@@ -228,6 +253,8 @@ Same DSP code and same normalized compilation options will generate the same SHA
 EXPORT string expandDSPFromString(const string& name_app, const string& dsp_content, int argc, const char* argv[],
                                   string& sha_key, string& error_msg)
 {
+    LOCK_API
+
     if (dsp_content == "") {
         error_msg = "Unable to read file";
         return "";
@@ -269,6 +296,8 @@ EXPORT bool generateAuxFilesFromFile(const string& filename, int argc, const cha
 EXPORT bool generateAuxFilesFromString(const string& name_app, const string& dsp_content, int argc, const char* argv[],
                                        string& error_msg)
 {
+    LOCK_API
+
     if (dsp_content == "") {
         error_msg = "Unable to read file";
         return false;
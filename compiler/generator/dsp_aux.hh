@@ -27,8 +27,11 @@
 #include <list>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "TMutex.h"
 #include "exception.hh"
 #include "faust/dsp/dsp.h"
 
@@ -167,32 +170,92 @@ class faust_smartptr {
     }
 };
 
+//----------------------------------------------------------------
+// Compiler wide lock, taken by all factory entry points since the
+// compiler state (gGlobal) and the factory tables are shared
+// (null until startMTDSPFactories is called, so no locking at all
+// when the API is used from a single thread)
+//----------------------------------------------------------------
+
+extern TLockAble* gDSPFactoriesLock;
+
+#define LOCK_API TLock lock(gDSPFactoriesLock);
+
 //----------------------------------------------------------------
 // Smart DSP factory table
 //----------------------------------------------------------------
 
 template <class T>
-struct dsp_factory_table : public std::map<T, std::list<dsp*> > {
-    typedef typename std::map<T, std::list<dsp*> >::iterator factory_iterator;
+struct dsp_factory_table : public std::map<T, std::unordered_set<dsp*> > {
+    typedef typename std::map<T, std::unordered_set<dsp*> >::iterator factory_iterator;
+
+    // SHA key index on the table entries (map iterators stay valid until the entry is erased)
+    std::unordered_map<std::string, factory_iterator> fSHAIndex;
 
     dsp_factory_table() {}
     virtual ~dsp_factory_table() {}
 
-    bool getFactory(const std::string& sha_key, factory_iterator& res)
+    typedef typename std::unordered_map<std::string, factory_iterator>::iterator       index_iterator;
+    typedef typename std::unordered_map<std::string, factory_iterator>::const_iterator index_const_iterator;
+
+    // Index the entry with its factory SHA key, the first indexed factory is kept for a given key
+    void addIndex(factory_iterator it)
     {
-        factory_iterator it;
+        std::string sha_key = (*it).first->getSHAKey();
+        if (sha_key == "") return;
+        std::pair<index_iterator, bool> res = fSHAIndex.insert(std::make_pair(sha_key, it));
+        if (!res.second && (*res.first).second != it) {
+            std::cerr << "WARNING : setFactory SHA key already used by another factory!" << std::endl;
+        }
+    }
 
-        for (it = this->begin(); it != this->end(); it++) {
-            if ((*it).first->getSHAKey() == sha_key) {
-                res = it;
-                return true;
+    // Remove the entry from the index, and possibly index another factory with the same SHA key
+    void removeIndex(factory_iterator it)
+    {
+        std::string    sha_key = (*it).first->getSHAKey();
+        index_iterator index   = fSHAIndex.find(sha_key);
+        if (index != fSHAIndex.end() && (*index).second == it) {
+            fSHAIndex.erase(index);
+            for (factory_iterator it1 = this->begin(); it1 != this->end(); it1++) {
+                if (it1 != it && (*it1).first->getSHAKey() == sha_key) {
+                    fSHAIndex.insert(std::make_pair(sha_key, it1));
+                    break;
+                }
             }
+        } else {
+            // The factory SHA key has been changed outside of the table
+            for (index = fSHAIndex.begin(); index != fSHAIndex.end(); index++) {
+                if ((*index).second == it) {
+                    fSHAIndex.erase(index);
+                    break;
+                }
+            }
+        }
+    }
+
+    bool getFactory(const std::string& sha_key, factory_iterator& res) const
+    {
+        index_const_iterator it = fSHAIndex.find(sha_key);
+
+        // The factory SHA key may have been changed outside of the table
+        if (it != fSHAIndex.end() && (*it).second->first->getSHAKey() == sha_key) {
+            res = (*it).second;
+            return true;
+        } else {
+            return false;
         }
+    }
 
-        return false;
+    void setFactory(T factory)
+    {
+        addIndex(this->insert(std::make_pair(factory, std::unordered_set<dsp*>())).first);
     }
 
-    void setFactory(T factory) { this->insert(std::pair<T, std::list<dsp*> >(factory, std::list<dsp*>())); }
+    void setFactory(T factory, const std::string& sha_key)
+    {
+        factory->setSHAKey(sha_key);
+        setFactory(factory);
+    }
 
     bool addDSP(T factory, dsp* dsp)
     {
@@ -200,7 +263,7 @@ struct dsp_factory_table : public std::map<T, std::list<dsp*> > {
         factory_iterator it = this->find(factory);
 
         if (it != this->end()) {
-            (*it).second.push_back(dsp);
+            (*it).second.insert(dsp);
             return true;
         } else {
             std::cerr << "WARNING : addDSP factory not found!" << std::endl;
@@ -215,7 +278,7 @@ struct dsp_factory_table : public std::map<T, std::list<dsp*> > {
         faustassert(it != this->end());
 
         if (it != this->end()) {
-            (*it).second.remove(dsp);
+            (*it).second.erase(dsp);
             return true;
         } else {
             std::cerr << "WARNING : removeDSP factory not found!" << std::endl;
@@ -254,15 +317,16 @@ struct dsp_factory_table : public std::map<T, std::list<dsp*> > {
         factory_iterator it;
 
         if ((it = this->find(factory)) != this->end()) {
-            std::list<dsp*> dsp_list = (*it).second;
+            std::unordered_set<dsp*> dsp_list = (*it).second;
             if (factory->refs() == 2) {  // Function argument + the one in table...
                 // Possibly delete remaining DSP
-                std::list<dsp*>::iterator it;
-                for (it = dsp_list.begin(); it != dsp_list.end(); it++) {
-                    delete (*it);
+                std::unordered_set<dsp*>::iterator dsp_it;
+                for (dsp_it = dsp_list.begin(); dsp_it != dsp_list.end(); dsp_it++) {
+                    delete (*dsp_it);
                 }
                 // Last use, remove from the global table, pointer will be deleted
-                this->erase(factory);
+                removeIndex(it);
+                this->erase(it);
                 return true;
             } else {
                 factory->removeReference();
@@ -285,6 +349,7 @@ struct dsp_factory_table : public std::map<T, std::list<dsp*> > {
             }
         }
         // Then clear the table thus finally deleting all ref = 1 smart pointers
+        fSHAIndex.clear();
         this->clear();
     }
 };
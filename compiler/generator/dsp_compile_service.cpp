@@ -0,0 +1,363 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+
+#ifndef EMCC
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#endif
+
+#include "dsp_compile_service.hh"
+#include "exception.hh"
+#include "export.hh"
+#include "libfaust.h"
+
+#ifndef EMCC
+
+using namespace std;
+
+struct dsp_compile_job : public dsp_compile_handle {
+    string           fName;
+    string           fContent;
+    vector<string>   fArgs;
+    string           fSHAKey;
+    string           fTag;
+    dsp_compile_fun  fCompile;
+    int              fPriority;
+    long             fOrder;
+    atomic<int>      fState;
+    atomic<bool>     fCancelled;
+    dsp_factory*     fFactory;
+    string           fErrorMsg;
+    mutex            fMutex;
+    condition_variable       fFinished;
+    vector<dsp_progress_fun> fProgress;
+
+    dsp_compile_job(const string& name_app, const string& dsp_content, int argc, const char* argv[],
+                    const string& sha_key, const string& tag, dsp_compile_fun compile, int priority, long order)
+        : fName(name_app),
+          fContent(dsp_content),
+          fArgs(argv, argv + argc),
+          fSHAKey(sha_key),
+          fTag(tag),
+          fCompile(compile),
+          fPriority(priority),
+          fOrder(order),
+          fState(kCompilePending),
+          fCancelled(false),
+          fFactory(nullptr)
+    {
+    }
+
+    void addProgress(dsp_progress_fun progress)
+    {
+        if (progress) {
+            lock_guard<mutex> lock(fMutex);
+            fProgress.push_back(progress);
+        }
+    }
+
+    void notify(const string& stage, float progress)
+    {
+        vector<dsp_progress_fun> callbacks;
+        {
+            lock_guard<mutex> lock(fMutex);
+            callbacks = fProgress;
+        }
+        for (size_t i = 0; i < callbacks.size(); i++) {
+            callbacks[i](stage, progress);
+        }
+    }
+
+    void finish(dsp_compile_state state, dsp_factory* factory, const string& error_msg)
+    {
+        {
+            lock_guard<mutex> lock(fMutex);
+            fFactory  = factory;
+            fErrorMsg = error_msg;
+            fState    = state;
+        }
+        fFinished.notify_all();
+        notify((state == kCompileDone) ? "done" : ((state == kCompileFailed) ? "failed" : "cancelled"), 1.f);
+    }
+
+    dsp_compile_state getState() { return dsp_compile_state(int(fState)); }
+
+    dsp_compile_state wait()
+    {
+        unique_lock<mutex> lock(fMutex);
+        fFinished.wait(lock, [this] { return fState >= kCompileDone; });
+        return dsp_compile_state(int(fState));
+    }
+
+    void cancel();
+
+    dsp_factory* getFactory()
+    {
+        lock_guard<mutex> lock(fMutex);
+        return fFactory;
+    }
+
+    string getErrorMessage()
+    {
+        lock_guard<mutex> lock(fMutex);
+        return fErrorMsg;
+    }
+
+    string getSHAKey() { return fSHAKey; }
+};
+
+// Compilation running on the current thread, if any
+static thread_local dsp_compile_job* gCurrentJob = nullptr;
+
+class dsp_compile_service {
+   private:
+    mutex                               fMutex;
+    condition_variable                  fCond;
+    bool                                fStop;
+    long                                fOrder;
+    list<shared_ptr<dsp_compile_job> >  fPending;
+    shared_ptr<dsp_compile_job>         fRunning;
+    thread                              fWorker;
+
+    static bool isBefore(const shared_ptr<dsp_compile_job>& job1, const shared_ptr<dsp_compile_job>& job2)
+    {
+        // Lower priority first, then the most recent one first, so that 'max_element' gives the next job
+        return (job1->fPriority < job2->fPriority) ||
+               ((job1->fPriority == job2->fPriority) && (job1->fOrder > job2->fOrder));
+    }
+
+    void compile(shared_ptr<dsp_compile_job> job)
+    {
+        vector<const char*> argv;
+        for (size_t i = 0; i < job->fArgs.size(); i++) {
+            argv.push_back(job->fArgs[i].c_str());
+        }
+        argv.push_back(nullptr);
+
+        string       error_msg;
+        dsp_factory* factory = nullptr;
+        gCurrentJob          = job.get();
+        try {
+            factory = job->fCompile(job->fName, job->fContent, int(job->fArgs.size()), argv.data(), error_msg);
+        } catch (faustexception& e) {
+            error_msg = e.Message();
+        }
+        gCurrentJob = nullptr;
+
+        // A compilation cancelled after its last stage still gives a factory
+        if (factory) {
+            job->finish(kCompileDone, factory, "");
+        } else if (job->fCancelled) {
+            job->finish(kCompileCancelled, nullptr, error_msg);
+        } else {
+            job->finish(kCompileFailed, nullptr, error_msg);
+        }
+    }
+
+    void run()
+    {
+        while (true) {
+            shared_ptr<dsp_compile_job> job;
+            {
+                unique_lock<mutex> lock(fMutex);
+                fCond.wait(lock, [this] { return fStop || !fPending.empty(); });
+                if (fStop) return;
+                auto next = max_element(fPending.begin(), fPending.end(), isBefore);
+                job       = *next;
+                fPending.erase(next);
+                job->fState = kCompileRunning;
+                fRunning    = job;
+            }
+            compile(job);
+            {
+                lock_guard<mutex> lock(fMutex);
+                fRunning = nullptr;
+            }
+        }
+    }
+
+    // To be called with fMutex locked, returns the job to be finished as cancelled if it was pending
+    shared_ptr<dsp_compile_job> cancelAux(dsp_compile_job* job)
+    {
+        job->fCancelled = true;
+        for (auto it = fPending.begin(); it != fPending.end(); it++) {
+            if (it->get() == job) {
+                shared_ptr<dsp_compile_job> pending = *it;
+                fPending.erase(it);
+                return pending;
+            }
+        }
+        return nullptr;
+    }
+
+   public:
+    dsp_compile_service() : fStop(false), fOrder(0) { fWorker = thread(&dsp_compile_service::run, this); }
+
+    virtual ~dsp_compile_service()
+    {
+        cancelAll();
+        {
+            lock_guard<mutex> lock(fMutex);
+            fStop = true;
+        }
+        fCond.notify_one();
+        fWorker.join();
+    }
+
+    shared_ptr<dsp_compile_handle> submit(const string& name_app, const string& dsp_content, int argc,
+                                          const char* argv[], const string& backend, dsp_compile_fun compile,
+                                          int priority, dsp_progress_fun progress, const string& tag)
+    {
+        stringstream request;
+        request << backend << '\n' << name_app << '\n';
+        for (int i = 0; i < argc; i++) {
+            request << argv[i] << ' ';
+        }
+        request << '\n' << dsp_content;
+        string sha_key = generateSHA1(request.str());
+
+        // fMutex only protects the queue : the compilations done on the worker thread are serialized
+        // with the factory functions called on other threads by the compiler lock
+        startMTDSPFactories();
+
+        vector<shared_ptr<dsp_compile_job> > cancelled;
+        shared_ptr<dsp_compile_job>          job;
+        {
+            lock_guard<mutex> lock(fMutex);
+
+            vector<shared_ptr<dsp_compile_job> > in_flight(fPending.begin(), fPending.end());
+            if (fRunning) in_flight.push_back(fRunning);
+
+            for (size_t i = 0; i < in_flight.size(); i++) {
+                shared_ptr<dsp_compile_job> other = in_flight[i];
+                if (other->fCancelled) continue;
+                if (other->fSHAKey == sha_key) {
+                    // Identical request : share the handle, with the highest priority
+                    job            = other;
+                    job->fPriority = max(job->fPriority, priority);
+                } else if (tag != "" && other->fTag == tag) {
+                    // Stale version
+                    shared_ptr<dsp_compile_job> pending = cancelAux(other.get());
+                    if (pending) cancelled.push_back(pending);
+                }
+            }
+
+            if (!job) {
+                job = make_shared<dsp_compile_job>(name_app, dsp_content, argc, argv, sha_key, tag, compile, priority,
+                                                   fOrder++);
+                fPending.push_back(job);
+            }
+            job->addProgress(progress);
+        }
+
+        fCond.notify_one();
+        for (size_t i = 0; i < cancelled.size(); i++) {
+            cancelled[i]->finish(kCompileCancelled, nullptr, "ERROR : compilation cancelled\n");
+        }
+        return job;
+    }
+
+    void cancel(dsp_compile_job* job)
+    {
+        shared_ptr<dsp_compile_job> pending;
+        {
+            lock_guard<mutex> lock(fMutex);
+            pending = cancelAux(job);
+        }
+        if (pending) pending->finish(kCompileCancelled, nullptr, "ERROR : compilation cancelled\n");
+    }
+
+    void cancelAll()
+    {
+        list<shared_ptr<dsp_compile_job> > pending;
+        {
+            lock_guard<mutex> lock(fMutex);
+            if (fRunning) fRunning->fCancelled = true;
+            for (auto it = fPending.begin(); it != fPending.end(); it++) {
+                (*it)->fCancelled = true;
+            }
+            pending.swap(fPending);
+        }
+        for (auto it = pending.begin(); it != pending.end(); it++) {
+            (*it)->finish(kCompileCancelled, nullptr, "ERROR : compilation cancelled\n");
+        }
+    }
+};
+
+static dsp_compile_service& getCompileService()
+{
+    static dsp_compile_service service;
+    return service;
+}
+
+void dsp_compile_job::cancel()
+{
+    getCompileService().cancel(this);
+}
+
+void checkCompileCancelled()
+{
+    if (gCurrentJob && gCurrentJob->fCancelled) {
+        throw faustexception("ERROR : compilation cancelled\n");
+    }
+}
+
+void compileStage(const char* stage, float progress)
+{
+    if (gCurrentJob) {
+        gCurrentJob->notify(stage, progress);
+        checkCompileCancelled();
+    }
+}
+
+// External C++ libfaust API
+
+EXPORT shared_ptr<dsp_compile_handle> submitDSPCompilation(const string& name_app, const string& dsp_content, int argc,
+                                                          const char* argv[], const string& backend,
+                                                          dsp_compile_fun compile, int priority,
+                                                          dsp_progress_fun progress, const string& tag)
+{
+    return getCompileService().submit(name_app, dsp_content, argc, argv, backend, compile, priority, progress, tag);
+}
+
+EXPORT void cancelAllDSPCompilations()
+{
+    getCompileService().cancelAll();
+}
+
+#else
+
+void checkCompileCancelled()
+{
+}
+
+void compileStage(const char* stage, float progress)
+{
+}
+
+#endif
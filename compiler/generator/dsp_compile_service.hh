@@ -0,0 +1,33 @@
+/************************************************************************
+ ************************************************************************
+ Copyright (C) 2003-2017 GRAME, Centre National de Creation Musicale
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation; either version 2.1 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef DSP_COMPILE_SERVICE_H
+#define DSP_COMPILE_SERVICE_H
+
+// Hooks called by the compilation pipeline (see submitDSPCompilation in libfaust.h)
+
+// Throw a faustexception if the compilation running on the calling thread has been cancelled
+void checkCompileCancelled();
+
+// Report the start of a compilation stage, then check cancellation
+void compileStage(const char* stage, float progress);
+
+#endif
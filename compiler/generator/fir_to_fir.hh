@@ -706,4 +706,378 @@ struct LoopVariableRenamer : public BasicCloneVisitor {
     BlockInst* getCode(BlockInst* src) { return dynamic_cast<BlockInst*>(src->clone(this)); }
 };
 
+/*
+ Fuse consecutive vectorizable loops of the DAG (only separated by labels, that is without any pre or post code),
+ then replace the stack arrays that are only accessed at the current index inside fused loops by local scalars:
+
+ for (int i = 0; (i < vsize); i = (i + 1)) { fZec0[i] = a; }
+ for (int i = 0; (i < vsize); i = (i + 1)) { output0[i] = (fZec0[i] * b); }
+
+ ==>
+
+ for (int i = 0; (i < vsize); i = (i + 1)) { float fZec0 = a; output0[i] = (fZec0 * b); }
+
+ Loops are already topologically sorted, and a vectorizable loop only reads its input vectors at the current index,
+ so appending the code of a loop to the previous one keeps the semantic.
+*/
+
+// Fuse consecutive vectorizable loops
+struct LoopFuser : public DispatchVisitor {
+    int fFusedLoops;
+
+    LoopFuser() : fFusedLoops(0) {}
+
+    static string dumpValue(ValueInst* value)
+    {
+        std::stringstream out;
+        FIRInstVisitor    fir_visitor(&out);
+        value->accept(&fir_visitor);
+        return out.str();
+    }
+
+    static string dumpStatement(StatementInst* inst)
+    {
+        std::stringstream out;
+        FIRInstVisitor    fir_visitor(&out);
+        inst->accept(&fir_visitor);
+        return out.str();
+    }
+
+    // Loops are compatible if they have the same index and the same bounds
+    static bool isCompatible(ForLoopInst* loop1, ForLoopInst* loop2)
+    {
+        return !loop1->fIsRecursive && !loop2->fIsRecursive && (loop1->getLoopVarName() != "") &&
+               (loop1->getLoopVarName() == loop2->getLoopVarName()) &&
+               (dumpValue(loop1->fEnd) == dumpValue(loop2->fEnd)) &&
+               (dumpStatement(loop1->fIncrement) == dumpStatement(loop2->fIncrement));
+    }
+
+    virtual void visit(BlockInst* inst)
+    {
+        // Possibly fuse loops in sub-blocks first
+        DispatchVisitor::visit(inst);
+
+        ForLoopInst*                         cur_loop = nullptr;
+        list<list<StatementInst*>::iterator> labels;
+        list<StatementInst*>::iterator       it = inst->fCode.begin();
+
+        while (it != inst->fCode.end()) {
+            ForLoopInst* loop = dynamic_cast<ForLoopInst*>(*it);
+            if (dynamic_cast<LabelInst*>(*it)) {
+                labels.push_back(it++);
+            } else if (loop && cur_loop && isCompatible(cur_loop, loop)) {
+                // Append the loop code and remove the loop with its labels
+                cur_loop->fCode->fCode.insert(cur_loop->fCode->fCode.end(), loop->fCode->fCode.begin(),
+                                              loop->fCode->fCode.end());
+                for (auto& label : labels) {
+                    inst->fCode.erase(label);
+                }
+                labels.clear();
+                it = inst->fCode.erase(it);
+                fFusedLoops++;
+            } else {
+                cur_loop = loop;
+                labels.clear();
+                it++;
+            }
+        }
+    }
+};
+
+// Check that the stack arrays are only accessed at the current index in vectorizable loops, and first written there
+struct LoopArrayChecker : public DispatchVisitor {
+    std::map<string, bool> fArrays;  // Stack arrays (true if they can be replaced by scalars)
+    std::set<string>       fAccessed;
+    ForLoopInst*           fLoop;
+
+    using DispatchVisitor::visit;
+
+    LoopArrayChecker() : fLoop(nullptr) {}
+
+    void setInvalid(const string& name)
+    {
+        if (fArrays.find(name) != fArrays.end()) {
+            fArrays[name] = false;
+        }
+    }
+
+    bool isLoopIndex(ValueInst* index)
+    {
+        LoadVarInst* load = dynamic_cast<LoadVarInst*>(index);
+        return load && fLoop && dynamic_cast<NamedAddress*>(load->fAddress) &&
+               (load->fAddress->getAccess() == Address::kLoop) &&
+               (load->fAddress->getName() == fLoop->getLoopVarName());
+    }
+
+    // Returns the name of the stack array accessed by 'address' at the current loop index, or ""
+    string getLoopArray(Address* address)
+    {
+        IndexedAddress* indexed = dynamic_cast<IndexedAddress*>(address);
+        if (indexed && (indexed->getAccess() & Address::kStack) && isLoopIndex(indexed->fIndex)) {
+            return indexed->getName();
+        } else {
+            return "";
+        }
+    }
+
+    virtual void visit(DeclareVarInst* inst)
+    {
+        ArrayTyped* array_typed = dynamic_cast<ArrayTyped*>(inst->fType);
+        if (!fLoop && array_typed && !inst->fValue && (inst->fAddress->getAccess() == Address::kStack)) {
+            fArrays[inst->fAddress->getName()] = true;
+        } else {
+            DispatchVisitor::visit(inst);
+        }
+    }
+
+    virtual void visit(StoreVarInst* inst)
+    {
+        string name = getLoopArray(inst->fAddress);
+        if (name != "") {
+            // Write access : value first, then the array is known in the loop
+            static_cast<IndexedAddress*>(inst->fAddress)->fIndex->accept(this);
+            inst->fValue->accept(this);
+            fAccessed.insert(name);
+        } else {
+            DispatchVisitor::visit(inst);
+        }
+    }
+
+    virtual void visit(IndexedAddress* address)
+    {
+        string name = getLoopArray(address);
+        if (name != "") {
+            // Read access : the array must have been written before in the same loop
+            if (fAccessed.find(name) == fAccessed.end()) {
+                setInvalid(name);
+            }
+            address->fIndex->accept(this);
+        } else {
+            DispatchVisitor::visit(address);
+        }
+    }
+
+    // Any other access (whole array, other index, outside loops...)
+    virtual void visit(NamedAddress* address) { setInvalid(address->getName()); }
+
+    virtual void visit(LoadVarAddressInst* inst)
+    {
+        setInvalid(inst->fAddress->getName());
+        DispatchVisitor::visit(inst);
+    }
+
+    virtual void visit(TeeVarInst* inst)
+    {
+        setInvalid(inst->fAddress->getName());
+        DispatchVisitor::visit(inst);
+    }
+
+    virtual void visit(ForLoopInst* inst)
+    {
+        ForLoopInst*     loop     = fLoop;
+        std::set<string> accessed = fAccessed;
+        fLoop                     = (inst->fIsRecursive) ? nullptr : inst;
+        fAccessed.clear();
+        inst->fInit->accept(this);
+        inst->fEnd->accept(this);
+        inst->fIncrement->accept(this);
+        inst->fCode->accept(this);
+        fLoop     = loop;
+        fAccessed = accessed;
+    }
+
+    virtual void visit(IfInst* inst)
+    {
+        // Writes in branches are not guaranteed : each branch only sees the writes done before the 'if'
+        std::set<string> accessed = fAccessed;
+        inst->fCond->accept(this);
+        inst->fThen->accept(this);
+        fAccessed = accessed;
+        inst->fElse->accept(this);
+        fAccessed = accessed;
+    }
+};
+
+// Replace the checked stack arrays by scalars declared at the beginning of the loops
+// (a first write may be in a branch, and the scalar then used after it)
+struct LoopArrayScalarizer : public BasicCloneVisitor {
+    std::map<string, Typed*> fArrays;  // Scalarized arrays with their element type
+    std::map<string, string> fNames;   // Scalarized arrays with their scalar name
+    std::set<string>         fUsed;    // Scalarized arrays used in the current loop
+
+    LoopArrayScalarizer(const std::map<string, Typed*>& arrays) : fArrays(arrays)
+    {
+        // Scalars are named like the ones of the scalar mode
+        for (auto& it : fArrays) {
+            fNames[it.first] = gGlobal->getFreshID(isRealType(it.second->getType()) ? "fTemp" : "iTemp");
+        }
+    }
+
+    bool isScalarized(Address* address)
+    {
+        return dynamic_cast<IndexedAddress*>(address) && (fArrays.find(address->getName()) != fArrays.end());
+    }
+
+    virtual StatementInst* visit(DeclareVarInst* inst)
+    {
+        if (fArrays.find(inst->fAddress->getName()) != fArrays.end() && dynamic_cast<ArrayTyped*>(inst->fType)) {
+            return InstBuilder::genDropInst();
+        } else {
+            return BasicCloneVisitor::visit(inst);
+        }
+    }
+
+    virtual StatementInst* visit(StoreVarInst* inst)
+    {
+        if (isScalarized(inst->fAddress)) {
+            string name = inst->fAddress->getName();
+            fUsed.insert(name);
+            return InstBuilder::genStoreStackVar(fNames[name], inst->fValue->clone(this));
+        } else {
+            return BasicCloneVisitor::visit(inst);
+        }
+    }
+
+    virtual ValueInst* visit(LoadVarInst* inst)
+    {
+        if (isScalarized(inst->fAddress)) {
+            return InstBuilder::genLoadStackVar(fNames[inst->fAddress->getName()]);
+        } else {
+            return BasicCloneVisitor::visit(inst);
+        }
+    }
+
+    virtual StatementInst* visit(ForLoopInst* inst)
+    {
+        std::set<string> used = fUsed;
+        fUsed.clear();
+        ForLoopInst* loop = static_cast<ForLoopInst*>(BasicCloneVisitor::visit(inst));
+        // Declarations in reverse order, so that they are in name order once pushed in front
+        for (std::set<string>::reverse_iterator it = fUsed.rbegin(); it != fUsed.rend(); it++) {
+            BasicCloneVisitor cloner;
+            loop->fCode->pushFrontInst(InstBuilder::genDecStackVar(fNames[*it], fArrays[*it]->clone(&cloner)));
+        }
+        fUsed = used;
+        return loop;
+    }
+};
+
+struct LoopFusion {
+    int fFusedLoops;
+    int fScalarizedArrays;
+
+    LoopFusion() : fFusedLoops(0), fScalarizedArrays(0) {}
+
+    // 'block' contains the stack arrays declarations, 'dag' the DAG of loops, both are rewritten
+    void fuse(BlockInst*& block, BlockInst*& dag)
+    {
+        LoopFuser fuser;
+        dag->accept(&fuser);
+        fFusedLoops = fuser.fFusedLoops;
+
+        LoopArrayChecker checker;
+        block->accept(&checker);
+        dag->accept(&checker);
+
+        // Keep the element type of the arrays declared in 'block'
+        std::map<string, Typed*>             arrays;
+        list<StatementInst*>::const_iterator it;
+        for (it = block->fCode.begin(); it != block->fCode.end(); it++) {
+            DeclareVarInst* dec  = dynamic_cast<DeclareVarInst*>(*it);
+            string          name = (dec) ? dec->fAddress->getName() : "";
+            if (checker.fArrays.find(name) != checker.fArrays.end() && checker.fArrays[name]) {
+                arrays[name] = static_cast<ArrayTyped*>(dec->fType)->fType;
+            }
+        }
+        fScalarizedArrays = int(arrays.size());
+
+        if (fScalarizedArrays > 0) {
+            LoopArrayScalarizer scalarizer(arrays);
+            block = static_cast<BlockInst*>(block->clone(&scalarizer));
+            dag   = static_cast<BlockInst*>(dag->clone(&scalarizer));
+        }
+    }
+};
+
+// Count struct variables accesses
+struct StructVarCounter : public DispatchVisitor {
+    std::map<string, int> fAccess;
+
+    using DispatchVisitor::visit;
+
+    virtual void visit(NamedAddress* address)
+    {
+        if (address->getAccess() & Address::kStruct) {
+            fAccess[address->getName()]++;
+        }
+    }
+};
+
+/*
+ Reorder the struct fields declarations to improve cache usage:
+
+ - scalars and small arrays accessed in the DSP loops (hot audio state) come first, the most accessed first
+ - then fields only accessed in the control part of 'compute' (slow parameters, UI zones...)
+ - then fields only accessed at init/clear time (constants...)
+ - big arrays (delay lines, tables) come last, accessed ones first, smaller first
+
+ The order of the fields is otherwise kept.
+*/
+struct StructLayout {
+    enum { kHot = 0, kControl, kCold, kHotArray, kColdArray, kGroups };
+
+    // Arrays bigger than a cache line are moved at the end of the struct
+    static const int gCacheLineSize = 64;
+
+    static bool isBigArray(DeclareVarInst* inst)
+    {
+        return dynamic_cast<ArrayTyped*>(inst->fType) && (inst->fType->getSize() > gCacheLineSize);
+    }
+
+    static BlockInst* getCode(BlockInst* src, std::map<string, int>& hot, std::map<string, int>& control)
+    {
+        std::vector<std::vector<DeclareVarInst*> > groups(kGroups);
+        list<StatementInst*>                      others;
+
+        list<StatementInst*>::const_iterator it;
+        for (it = src->fCode.begin(); it != src->fCode.end(); it++) {
+            DeclareVarInst* inst = dynamic_cast<DeclareVarInst*>(*it);
+            if (!inst || !(inst->fAddress->getAccess() & Address::kStruct)) {
+                others.push_back(*it);
+                continue;
+            }
+            string name = inst->fAddress->getName();
+            if (isBigArray(inst)) {
+                groups[(hot.find(name) != hot.end()) ? kHotArray : kColdArray].push_back(inst);
+            } else if (hot.find(name) != hot.end()) {
+                groups[kHot].push_back(inst);
+            } else if (control.find(name) != control.end()) {
+                groups[kControl].push_back(inst);
+            } else {
+                groups[kCold].push_back(inst);
+            }
+        }
+
+        std::stable_sort(groups[kHot].begin(), groups[kHot].end(), [&hot](DeclareVarInst* a, DeclareVarInst* b) {
+            return hot[a->fAddress->getName()] > hot[b->fAddress->getName()];
+        });
+        for (int g = kHotArray; g <= kColdArray; g++) {
+            std::stable_sort(groups[g].begin(), groups[g].end(), [](DeclareVarInst* a, DeclareVarInst* b) {
+                return a->fType->getSize() < b->fType->getSize();
+            });
+        }
+
+        BlockInst* dst = InstBuilder::genBlockInst();
+        for (it = others.begin(); it != others.end(); it++) {
+            dst->pushBackInst(*it);
+        }
+        for (int g = 0; g < kGroups; g++) {
+            for (size_t i = 0; i < groups[g].size(); i++) {
+                dst->pushBackInst(groups[g][i]);
+            }
+        }
+        return dst;
+    }
+};
+
 #endif
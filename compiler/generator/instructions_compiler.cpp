@@ -29,11 +29,13 @@
 #include "global.hh"
 #include "instructions.hh"
 #include "instructions_compiler.hh"
+#include "labels.hh"
 #include "ppsig.hh"
 #include "prim2.hh"
 #include "privatise.hh"
 #include "recursivness.hh"
 #include "sigConstantPropagation.hh"
+#include "sigLookAhead.hh"
 #include "sigPromotion.hh"
 #include "sigToGraph.hh"
 #include "sigprint.hh"
@@ -166,7 +168,21 @@ Tree InstructionsCompiler::prepare(Tree LS)
     Tree L4 = SK.mapself(L3);
     endTiming("Constant propagation");
 
+    startTiming("privatise");
     Tree L5 = privatise(L4);  // Un-share tables with multiple writers
+    endTiming("privatise");
+
+    // Rewrite linear recursions in look-ahead form (in vector mode only)
+    if (gGlobal->gVectorSwitch && gGlobal->gLookAhead > 1) {
+        startTiming("Look-ahead");
+        typeAnnotation(L5, false);  // Coefficients variability is needed
+        SignalLookAhead LA(gGlobal->gLookAhead);
+        L5 = LA.mapself(L5);
+        if (gGlobal->gDetailsSwitch) {
+            cerr << LA.rewritten() << " recursion(s) rewritten in look-ahead form" << endl;
+        }
+        endTiming("Look-ahead");
+    }
 
     // dump normal form
     if (gGlobal->gDumpNorm) {
@@ -174,14 +190,21 @@ Tree InstructionsCompiler::prepare(Tree LS)
         throw faustexception("Dump normal form finished...\n");
     }
 
+    startTiming("recursivnessAnnotation");
     recursivnessAnnotation(L5);  // Annotate L5 with recursivness information
+    endTiming("recursivnessAnnotation");
 
     startTiming("L5 typeAnnotation");
     typeAnnotation(L5, true);  // Annotate L5 with type information and check causality
     endTiming("L5 typeAnnotation");
 
+    startTiming("sharingAnalysis");
     sharingAnalysis(L5);  // annotate L5 with sharing count
+    endTiming("sharingAnalysis");
+
+    startTiming("occurrences analysis");
     fOccMarkup.mark(L5);  // annotate L5 with occurrences analysis
+    endTiming("occurrences analysis");
     // annotationStatistics();
     endTiming("prepare");
 
@@ -378,7 +401,9 @@ void InstructionsCompiler::compileMultiSignal(Tree L)
     }
 
     // Apply FIR to FIR transformations
+    startTiming("processFIR");
     fContainer->processFIR();
+    endTiming("processFIR");
 
     // Generate JSON
     if (gGlobal->gPrintJSONSwitch) {
@@ -1515,8 +1540,20 @@ ValueInst* InstructionsCompiler::generateSelect2(Tree sig, Tree sel, Tree s1, Tr
         v2 = promote2real(t2, v2);
     }
 
-    if (gGlobal->gGenerateSelectWithIf && (type->variability() == kSamp) &&
-        (!v1->isSimpleValue() || !v2->isSimpleValue())) {
+    if (gGlobal->gProfileInstrument && (getCertifiedSigType(sig)->variability() == kSamp)) {
+        generateSelect2Profile(sig, cond);
+    }
+
+    bool with_if = gGlobal->gGenerateSelectWithIf;
+    if (with_if && (gGlobal->gSelectProfile.size() > 0)) {
+        map<string, double>::iterator it = gGlobal->gSelectProfile.find(getSelectProfileKey(sig));
+        if (it != gGlobal->gSelectProfile.end()) {
+            // A well predicted condition is worth a branch, both values are computed and selected otherwise
+            with_if = (it->second <= 0.1) || (it->second >= 0.9);
+        }
+    }
+
+    if (with_if && (type->variability() == kSamp) && (!v1->isSimpleValue() || !v2->isSimpleValue())) {
         return generateSelect2WithIf(sig, (((t1 == kReal) || (t2 == kReal)) ? itfloat() : Typed::kInt32), cond, v1, v2);
     } else {
         return generateSelect2WithSelect(sig, cond, v1, v2);
@@ -1568,6 +1605,79 @@ ValueInst* InstructionsCompiler::generateSelect2WithIf(Tree sig, Typed::VarType
     return generateCacheCode(sig, InstBuilder::genLoadStackVar(vname));
 }
 
+/**
+ * Structural hash of a signal : unlike the tree hash which depends on the node addresses,
+ * it is the same from one compilation to another, so that it can name the entries of a profile.
+ */
+unsigned long long InstructionsCompiler::structuralHash(Tree sig)
+{
+    map<Tree, unsigned long long>::iterator it = fStructuralHash.find(sig);
+    if (it != fStructuralHash.end()) return it->second;
+
+    // FNV-1a on the node content, then on the branches hashes
+    const Node&        node = sig->node();
+    unsigned long long hash = 14695981039346656037ULL ^ (unsigned long long)node.type();
+    unsigned long long data = 0;
+    if (node.type() == kIntNode) {
+        data = (unsigned long long)node.getInt();
+    } else if (node.type() == kDoubleNode) {
+        double value = node.getDouble();
+        memcpy(&data, &value, sizeof(double));
+    } else if (node.type() == kSymNode) {
+        for (const char* c = name(node.getSym()); *c; c++) {
+            hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+        }
+    }
+    hash = (hash ^ data) * 1099511628211ULL;
+    for (int i = 0; i < sig->arity(); i++) {
+        hash = (hash ^ structuralHash(sig->branch(i))) * 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    fStructuralHash[sig] = hash;
+    return hash;
+}
+
+string InstructionsCompiler::getSelectProfileKey(Tree sig)
+{
+    char key[32];
+    snprintf(key, 32, "select_%016llx", structuralHash(sig));
+    return key;
+}
+
+/**
+ * Profile instrumentation (-pgi) : count how often the condition of a sample rate select2 is true,
+ * and publish the ratio in a bargraph of a 'profile' group at the end of each block.
+ */
+void InstructionsCompiler::generateSelect2Profile(Tree sig, ValueInst* sel)
+{
+    string key     = getSelectProfileKey(sig);
+    string taken   = gGlobal->getFreshID("iProfileTaken");
+    string count   = gGlobal->getFreshID("iProfileCount");
+    string varname = gGlobal->getFreshID("fHbargraph");
+
+    pushDeclare(InstBuilder::genDecStructVar(taken, InstBuilder::genBasicTyped(Typed::kInt32)));
+    pushDeclare(InstBuilder::genDecStructVar(count, InstBuilder::genBasicTyped(Typed::kInt32)));
+    pushDeclare(InstBuilder::genDecStructVar(varname, InstBuilder::genBasicTyped(Typed::kFloatMacro)));
+    pushClearMethod(InstBuilder::genStoreStructVar(taken, InstBuilder::genInt32NumInst(0)));
+    pushClearMethod(InstBuilder::genStoreStructVar(count, InstBuilder::genInt32NumInst(0)));
+
+    BasicCloneVisitor cloner;
+    ValueInst*        cond = InstBuilder::genCastInt32Inst(
+        InstBuilder::genNotEqual(sel->clone(&cloner), InstBuilder::genInt32NumInst(0)));
+    pushComputeDSPMethod(
+        InstBuilder::genStoreStructVar(taken, InstBuilder::genAdd(InstBuilder::genLoadStructVar(taken), cond)));
+    pushComputeDSPMethod(InstBuilder::genStoreStructVar(
+        count, InstBuilder::genAdd(InstBuilder::genLoadStructVar(count), InstBuilder::genInt32NumInst(1))));
+
+    ValueInst* ratio = InstBuilder::genDiv(InstBuilder::genCastFloatInst(InstBuilder::genLoadStructVar(taken)),
+                                           InstBuilder::genCastFloatInst(InstBuilder::genLoadStructVar(count)));
+    pushPostComputeBlockMethod(InstBuilder::genStoreStructVar(varname, InstBuilder::genCastFloatMacroInst(ratio)));
+
+    // The label is parsed as a widget label, giving a 'profile' group at the root of the UI
+    Tree path = normalizePath(cons(tree(subst("v:profile/$0[profile:select]", key)), gGlobal->nil));
+    addUIWidget(reverse(tl(path)), uiWidget(hd(path), tree(varname), sigHBargraph(path, tree(0.), tree(1.), sig)));
+}
+
 ValueInst* InstructionsCompiler::generateSelect3(Tree sig, Tree sel, Tree s1, Tree s2, Tree s3)
 {
     // Done at signal level
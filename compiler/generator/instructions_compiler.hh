@@ -54,6 +54,8 @@ class InstructionsCompiler : public virtual Garbageable {
 
     std::map<int, std::string> fIOTATable;  // Ensure IOTA base fixed delays are computed once
 
+    std::map<Tree, unsigned long long> fStructuralHash;  // Memoized structural hash of signals (see -pgi/-pgu)
+
     Tree         fUIRoot;
     Description* fDescription;
     bool         fLoadedIota;
@@ -83,6 +85,10 @@ class InstructionsCompiler : public virtual Garbageable {
     ValueInst* generateSelect2WithSelect(Tree sig, ValueInst* sel, ValueInst* val1, ValueInst* val2);
     ValueInst* generateSelect2WithIf(Tree sig, Typed::VarType type, ValueInst* sel, ValueInst* val1, ValueInst* val2);
 
+    unsigned long long structuralHash(Tree sig);
+    string             getSelectProfileKey(Tree sig);
+    void               generateSelect2Profile(Tree sig, ValueInst* sel);
+
     /* wrapper functions to access code container */
     StatementInst* pushInitMethod(StatementInst* inst) { return fContainer->pushInitMethod(inst); }
     StatementInst* pushResetUIInstructions(StatementInst* inst) { return fContainer->pushResetUIInstructions(inst); }
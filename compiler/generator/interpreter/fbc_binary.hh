@@ -0,0 +1,215 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef _FBC_BINARY_H
+#define _FBC_BINARY_H
+
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "exception.hh"
+
+/*
+ Binary FBC format :
+
+    - header : "FBCB" magic, format version, endianness marker, real size, section number, checksum
+    - section table : (offset, size) of each section, offsets are counted from the start of the buffer
+    - sections : factory description, meta, UI and code blocks
+
+ All values are written as 32 bits integers or reals in the host byte order, with no padding, so that
+ a buffer (possibly mapped from a file) can be directly decoded. The checksum covers the section table
+ and the sections. Code blocks are stored after bytecode optimization, so no optimization pass is needed at load time.
+*/
+
+#define INTERP_BINARY_MAGIC "FBCB"
+#define INTERP_BINARY_VERSION 1
+#define INTERP_BINARY_ENDIAN 0x01020304
+
+enum FBCBinarySection {
+    kFBCHeaderSection,
+    kFBCMetaSection,
+    kFBCUserInterfaceSection,
+    kFBCStaticInitSection,
+    kFBCInitSection,
+    kFBCResetUISection,
+    kFBCClearSection,
+    kFBCControlSection,
+    kFBCDSPSection,
+    kFBCSectionCount
+};
+
+// FNV-1a hash
+static inline uint32_t fbcChecksum(const char* buffer, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ uint8_t(buffer[i])) * 16777619u;
+    }
+    return hash;
+}
+
+struct FBCBinaryWriter {
+    std::string fBuffer;
+
+    void writeInt(int32_t val) { fBuffer.append((const char*)&val, sizeof(int32_t)); }
+
+    template <class T>
+    void writeReal(T val)
+    {
+        fBuffer.append((const char*)&val, sizeof(T));
+    }
+
+    void writeString(const std::string& str)
+    {
+        writeInt(int32_t(str.size()));
+        fBuffer.append(str);
+    }
+};
+
+struct FBCBinaryReader {
+    const char* fBuffer;
+    size_t      fSize;
+    size_t      fPos;
+
+    FBCBinaryReader(const char* buffer = nullptr, size_t size = 0) : fBuffer(buffer), fSize(size), fPos(0) {}
+
+    void check(size_t size)
+    {
+        if (fPos + size > fSize) {
+            throw faustexception("ERROR : truncated binary FBC\n");
+        }
+    }
+
+    int32_t readInt()
+    {
+        int32_t val;
+        check(sizeof(int32_t));
+        memcpy(&val, fBuffer + fPos, sizeof(int32_t));
+        fPos += sizeof(int32_t);
+        return val;
+    }
+
+    template <class T>
+    T readReal()
+    {
+        T val;
+        check(sizeof(T));
+        memcpy(&val, fBuffer + fPos, sizeof(T));
+        fPos += sizeof(T);
+        return val;
+    }
+
+    int readSize()
+    {
+        int32_t size = readInt();
+        if (size < 0) {
+            throw faustexception("ERROR : corrupted binary FBC\n");
+        }
+        return size;
+    }
+
+    std::string readString()
+    {
+        int size = readSize();
+        check(size);
+        std::string str(fBuffer + fPos, size);
+        fPos += size;
+        return str;
+    }
+};
+
+// Header size : magic, version, endianness, real size, section number, checksum
+#define INTERP_BINARY_HEADER_SIZE (4 + 5 * sizeof(int32_t))
+
+static inline bool isFBCBinary(const char* buffer, size_t size)
+{
+    return (size >= INTERP_BINARY_HEADER_SIZE) && (strncmp(buffer, INTERP_BINARY_MAGIC, 4) == 0);
+}
+
+static inline void writeFBCBinary(std::ostream* out, int real_size, FBCBinaryWriter* sections)
+{
+    FBCBinaryWriter table;
+    int32_t         offset = INTERP_BINARY_HEADER_SIZE + kFBCSectionCount * 2 * sizeof(int32_t);
+    for (int i = 0; i < kFBCSectionCount; i++) {
+        table.writeInt(offset);
+        table.writeInt(int32_t(sections[i].fBuffer.size()));
+        offset += sections[i].fBuffer.size();
+    }
+
+    // Checksum is computed on the section table followed by the sections
+    std::string content = table.fBuffer;
+    for (int i = 0; i < kFBCSectionCount; i++) {
+        content += sections[i].fBuffer;
+    }
+
+    FBCBinaryWriter header;
+    header.fBuffer = INTERP_BINARY_MAGIC;
+    header.writeInt(INTERP_BINARY_VERSION);
+    header.writeInt(INTERP_BINARY_ENDIAN);
+    header.writeInt(real_size);
+    header.writeInt(kFBCSectionCount);
+    header.writeInt(int32_t(fbcChecksum(content.c_str(), content.size())));
+
+    out->write(header.fBuffer.c_str(), header.fBuffer.size());
+    out->write(content.c_str(), content.size());
+}
+
+// Check the header and checksum, then return the real size and a reader on each section
+static inline int readFBCBinary(const char* buffer, size_t size, std::vector<FBCBinaryReader>& sections)
+{
+    if (!isFBCBinary(buffer, size)) {
+        throw faustexception("ERROR : unrecognized file format\n");
+    }
+
+    FBCBinaryReader header(buffer, size);
+    header.fPos = 4;
+    if (header.readInt() != INTERP_BINARY_VERSION) {
+        throw faustexception("ERROR : binary FBC version is not the one expected\n");
+    }
+    if (header.readInt() != INTERP_BINARY_ENDIAN) {
+        throw faustexception("ERROR : binary FBC was written with a different byte order\n");
+    }
+    int real_size = header.readInt();
+    int count     = header.readInt();
+    if (count != kFBCSectionCount) {
+        throw faustexception("ERROR : corrupted binary FBC\n");
+    }
+    uint32_t checksum = uint32_t(header.readInt());
+    if (checksum != fbcChecksum(buffer + header.fPos, size - header.fPos)) {
+        throw faustexception("ERROR : binary FBC checksum error\n");
+    }
+
+    for (int i = 0; i < count; i++) {
+        size_t offset       = size_t(header.readSize());
+        size_t section_size = size_t(header.readSize());
+        if (offset + section_size > size) {
+            throw faustexception("ERROR : corrupted binary FBC\n");
+        }
+        sections.push_back(FBCBinaryReader(buffer + offset, section_size));
+    }
+
+    return real_size;
+}
+
+#endif
@@ -33,6 +33,9 @@ struct FBCExecutor {
     
     virtual void setIntValue(int offset, int value) {}
     virtual int getIntValue(int offset) { return -1; }
+
+    virtual int* getIntHeap() { return nullptr; }
+    virtual T*   getRealHeap() { return nullptr; }
     
     virtual void setInput(int offset, T* buffer) {}
     virtual void setOutput(int offset, T* buffer) {}
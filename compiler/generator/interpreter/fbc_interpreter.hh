@@ -2334,6 +2334,9 @@ class FBCInterpreter : public FBCExecutor<T> {
     void setIntValue(int offset, int value) { fIntHeap[offset] = value; }
     int  getIntValue(int offset) { return fIntHeap[offset]; }
 
+    int* getIntHeap() { return fIntHeap; }
+    T*   getRealHeap() { return fRealHeap; }
+
     virtual void setInput(int input, T* buffer) { fInputs[input] = buffer; }
     virtual void setOutput(int output, T* buffer) { fOutputs[output] = buffer; }
 };
@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "exception.hh"
+#include "fbc_binary.hh"
 #include "fbc_opcode.hh"
 #include "faust/gui/PathBuilder.h"
 
@@ -139,6 +140,23 @@ struct FBCBasicInstruction : public FBCInstruction {
         }
     }
 
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeInt(fOpcode);
+        out->writeInt(fIntValue);
+        out->writeReal<T>(fRealValue);
+        out->writeInt(fOffset1);
+        out->writeInt(fOffset2);
+        // If select/if/loop : write branches, preceded by the mask of present branches
+        out->writeInt(((getBranch1()) ? 1 : 0) | ((fBranch2) ? 2 : 0));
+        if (getBranch1()) {
+            fBranch1->writeBinary(out);
+        }
+        if (fBranch2) {
+            fBranch2->writeBinary(out);
+        }
+    }
+
     virtual FBCBasicInstruction<T>* copy()
     {
         return new FBCBasicInstruction<T>(fOpcode, fIntValue, fRealValue, fOffset1, fOffset2,
@@ -183,6 +201,17 @@ struct FIRBlockStoreRealInstruction : public FBCBasicInstruction<T> {
         }
         *out << std::endl;
     }
+
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeInt(this->fOpcode);
+        out->writeInt(this->fOffset1);
+        out->writeInt(this->fOffset2);
+        out->writeInt(int32_t(this->fNumTable.size()));
+        for (unsigned int i = 0; i < fNumTable.size(); i++) {
+            out->writeReal<T>(this->fNumTable[i]);
+        }
+    }
 };
 
 template <class T>
@@ -221,6 +250,17 @@ struct FIRBlockStoreIntInstruction : public FBCBasicInstruction<T> {
         }
         *out << std::endl;
     }
+
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeInt(this->fOpcode);
+        out->writeInt(this->fOffset1);
+        out->writeInt(this->fOffset2);
+        out->writeInt(int32_t(this->fNumTable.size()));
+        for (unsigned int i = 0; i < fNumTable.size(); i++) {
+            out->writeInt(this->fNumTable[i]);
+        }
+    }
 };
 
 template <class T>
@@ -301,6 +341,19 @@ struct FIRUserInterfaceInstruction : public FBCInstruction {
                  << " min " << fMin << " max " << fMax << " step " << fStep << std::endl;
         }
     }
+
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeInt(fOpcode);
+        out->writeInt(fOffset);
+        out->writeString(fLabel);
+        out->writeString(fKey);
+        out->writeString(fValue);
+        out->writeReal<T>(fInit);
+        out->writeReal<T>(fMin);
+        out->writeReal<T>(fMax);
+        out->writeReal<T>(fStep);
+    }
 };
 
 struct FIRMetaInstruction : public FBCInstruction {
@@ -321,6 +374,12 @@ struct FIRMetaInstruction : public FBCInstruction {
                  << " key " << quote1(fKey) << " value " << quote1(fValue) << std::endl;
         }
     }
+
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeString(fKey);
+        out->writeString(fValue);
+    }
 };
 
 #define InstructionIT typename std::vector<FBCBasicInstruction<T>*>::iterator
@@ -351,6 +410,14 @@ struct FIRUserInterfaceBlockInstruction : public FBCInstruction {
             it->write(out, binary, small);
         }
     }
+
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeInt(int32_t(fInstructions.size()));
+        for (auto& it : fInstructions) {
+            it->writeBinary(out);
+        }
+    }
     
     std::map<std::string, int>& getPathMap()
     {
@@ -449,6 +516,14 @@ struct FIRMetaBlockInstruction : public FBCInstruction {
             it->write(out, binary, small);
         }
     }
+
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeInt(int32_t(fInstructions.size()));
+        for (auto& it : fInstructions) {
+            it->writeBinary(out);
+        }
+    }
 };
 
 template <class T>
@@ -488,6 +563,14 @@ struct FBCBlockInstruction : public FBCInstruction {
         }
     }
 
+    virtual void writeBinary(FBCBinaryWriter* out)
+    {
+        out->writeInt(int32_t(fInstructions.size()));
+        for (auto& it : fInstructions) {
+            it->writeBinary(out);
+        }
+    }
+
     void stackMove(int& int_index, int& real_index)
     {
         std::cout << "FBCBlockInstruction::stackMove" << std::endl;
@@ -73,6 +73,23 @@ static void setCurrentBlock(FBCBlockInstruction<T>* block)
     static_cast<InterpreterInstVisitor<T>*>(gGlobal->gInterpreterVisitor)->fCurrentBlock = block;
 }
 
+// Keep the fields offsets in the factory (soundfiles and audio buffers are not part of the state)
+template <class T, int TRACE>
+static interpreter_dsp_factory_aux<T, TRACE>* setFields(interpreter_dsp_factory_aux<T, TRACE>* factory,
+                                                       map<string, MemoryDesc>& field_table)
+{
+    for (auto& it : field_table) {
+        if (it.second.fSize <= 0) {
+            continue;
+        } else if (it.second.fType == Typed::kInt32) {
+            factory->fIntFields[it.first] = make_pair(it.second.fOffset, it.second.fSize);
+        } else if (it.second.fType != Typed::kSound_ptr) {
+            factory->fRealFields[it.first] = make_pair(it.second.fOffset, it.second.fSize);
+        }
+    }
+    return factory;
+}
+
 template <class T>
 InterpreterCodeContainer<T>::InterpreterCodeContainer(const string& name, int numInputs, int numOutputs)
 {
@@ -213,59 +230,65 @@ dsp_factory_base* InterpreterCodeContainer<T>::produceFactory()
 
     switch (mode) {
         case 1:
-            return new interpreter_dsp_factory_aux<T, 1>(
+            return setFields(new interpreter_dsp_factory_aux<T, 1>(
                 name, compile_options.str(), "", INTERP_FILE_VERSION, fNumInputs, fNumOutputs, getInterpreterVisitor<T>()->fIntHeapOffset,
                 getInterpreterVisitor<T>()->fRealHeapOffset, getInterpreterVisitor<T>()->fSoundHeapOffset,
                 getInterpreterVisitor<T>()->getFieldOffset("fSamplingFreq"),
                 getInterpreterVisitor<T>()->getFieldOffset("count"), getInterpreterVisitor<T>()->getFieldOffset("IOTA"),
                 INTER_MAX_OPT_LEVEL, metadata_block, getInterpreterVisitor<T>()->fUserInterfaceBlock, init_static_block,
-                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block);
+                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block),
+                             getInterpreterVisitor<T>()->fFieldTable);
 
         case 2:
-            return new interpreter_dsp_factory_aux<T, 2>(
+            return setFields(new interpreter_dsp_factory_aux<T, 2>(
                 name, compile_options.str(), "", INTERP_FILE_VERSION, fNumInputs, fNumOutputs, getInterpreterVisitor<T>()->fIntHeapOffset,
                 getInterpreterVisitor<T>()->fRealHeapOffset, getInterpreterVisitor<T>()->fSoundHeapOffset,
                 getInterpreterVisitor<T>()->getFieldOffset("fSamplingFreq"),
                 getInterpreterVisitor<T>()->getFieldOffset("count"), getInterpreterVisitor<T>()->getFieldOffset("IOTA"),
                 INTER_MAX_OPT_LEVEL, metadata_block, getInterpreterVisitor<T>()->fUserInterfaceBlock, init_static_block,
-                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block);
+                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block),
+                             getInterpreterVisitor<T>()->fFieldTable);
 
         case 3:
-            return new interpreter_dsp_factory_aux<T, 3>(
+            return setFields(new interpreter_dsp_factory_aux<T, 3>(
                 name, compile_options.str(), "", INTERP_FILE_VERSION, fNumInputs, fNumOutputs, getInterpreterVisitor<T>()->fIntHeapOffset,
                 getInterpreterVisitor<T>()->fRealHeapOffset, getInterpreterVisitor<T>()->fSoundHeapOffset,
                 getInterpreterVisitor<T>()->getFieldOffset("fSamplingFreq"),
                 getInterpreterVisitor<T>()->getFieldOffset("count"), getInterpreterVisitor<T>()->getFieldOffset("IOTA"),
                 INTER_MAX_OPT_LEVEL, metadata_block, getInterpreterVisitor<T>()->fUserInterfaceBlock, init_static_block,
-                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block);
+                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block),
+                             getInterpreterVisitor<T>()->fFieldTable);
 
         case 4:
-            return new interpreter_dsp_factory_aux<T, 4>(
+            return setFields(new interpreter_dsp_factory_aux<T, 4>(
                 name, compile_options.str(), "", INTERP_FILE_VERSION, fNumInputs, fNumOutputs, getInterpreterVisitor<T>()->fIntHeapOffset,
                 getInterpreterVisitor<T>()->fRealHeapOffset, getInterpreterVisitor<T>()->fSoundHeapOffset,
                 getInterpreterVisitor<T>()->getFieldOffset("fSamplingFreq"),
                 getInterpreterVisitor<T>()->getFieldOffset("count"), getInterpreterVisitor<T>()->getFieldOffset("IOTA"),
                 INTER_MAX_OPT_LEVEL, metadata_block, getInterpreterVisitor<T>()->fUserInterfaceBlock, init_static_block,
-                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block);
+                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block),
+                             getInterpreterVisitor<T>()->fFieldTable);
 
         case 5:
-            return new interpreter_dsp_factory_aux<T, 5>(
+            return setFields(new interpreter_dsp_factory_aux<T, 5>(
                 name, compile_options.str(), "", INTERP_FILE_VERSION, fNumInputs, fNumOutputs, getInterpreterVisitor<T>()->fIntHeapOffset,
                 getInterpreterVisitor<T>()->fRealHeapOffset, getInterpreterVisitor<T>()->fSoundHeapOffset,
                 getInterpreterVisitor<T>()->getFieldOffset("fSamplingFreq"),
                 getInterpreterVisitor<T>()->getFieldOffset("count"), getInterpreterVisitor<T>()->getFieldOffset("IOTA"),
                 INTER_MAX_OPT_LEVEL, metadata_block, getInterpreterVisitor<T>()->fUserInterfaceBlock, init_static_block,
-                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block);
+                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block),
+                             getInterpreterVisitor<T>()->fFieldTable);
 
         default:
             // Default case, no trace...
-            return new interpreter_dsp_factory_aux<T, 0>(
+            return setFields(new interpreter_dsp_factory_aux<T, 0>(
                 name, compile_options.str(), "", INTERP_FILE_VERSION, fNumInputs, fNumOutputs, getInterpreterVisitor<T>()->fIntHeapOffset,
                 getInterpreterVisitor<T>()->fRealHeapOffset, getInterpreterVisitor<T>()->fSoundHeapOffset,
                 getInterpreterVisitor<T>()->getFieldOffset("fSamplingFreq"),
                 getInterpreterVisitor<T>()->getFieldOffset("count"), getInterpreterVisitor<T>()->getFieldOffset("IOTA"),
                 INTER_MAX_OPT_LEVEL, metadata_block, getInterpreterVisitor<T>()->fUserInterfaceBlock, init_static_block,
-                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block);
+                init_block, resetui_block, clear_block, compute_control_block, compute_dsp_block),
+                             getInterpreterVisitor<T>()->fFieldTable);
     }
 }
 
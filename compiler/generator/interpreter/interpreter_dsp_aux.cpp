@@ -38,6 +38,9 @@ void faustassertaux(bool cond, const string& file, int line)
         throw faustexception(str.str());
     }
 }
+
+// Global API access lock
+TLockAble* gDSPFactoriesLock = nullptr;
 #endif
 
 dsp_factory_table<SDsp_factory> gInterpreterFactoryTable;
@@ -46,11 +49,13 @@ dsp_factory_table<SDsp_factory> gInterpreterFactoryTable;
 
 EXPORT interpreter_dsp_factory* getInterpreterDSPFactoryFromSHAKey(const string& sha_key)
 {
+    LOCK_API
     return static_cast<interpreter_dsp_factory*>(gInterpreterFactoryTable.getDSPFactoryFromSHAKey(sha_key));
 }
 
 EXPORT bool deleteInterpreterDSPFactory(interpreter_dsp_factory* factory)
 {
+    LOCK_API
     return (factory) ? gInterpreterFactoryTable.deleteDSPFactory(factory) : false;
 }
 
@@ -63,16 +68,19 @@ EXPORT vector<string> getInterpreterDSPFactoryLibraryList(interpreter_dsp_factor
 
 EXPORT vector<string> getAllInterpreterDSPFactories()
 {
+    LOCK_API
     return gInterpreterFactoryTable.getAllDSPFactories();
 }
 
 EXPORT void deleteAllInterpreterDSPFactories()
 {
+    LOCK_API
     gInterpreterFactoryTable.deleteAllDSPFactories();
 }
 
 EXPORT interpreter_dsp::~interpreter_dsp()
 {
+    LOCK_API
     gInterpreterFactoryTable.removeDSP(fFactory, this);
 
     if (fFactory->getMemoryManager()) {
@@ -85,6 +93,7 @@ EXPORT interpreter_dsp::~interpreter_dsp()
 
 EXPORT interpreter_dsp* interpreter_dsp_factory::createDSPInstance()
 {
+    LOCK_API
     dsp* dsp = fFactory->createDSPInstance(this);
     gInterpreterFactoryTable.addDSP(this, dsp);
     return static_cast<interpreter_dsp*>(dsp);
@@ -120,6 +129,7 @@ static string read_real_type(istream* in)
 
 static interpreter_dsp_factory* readInterpreterDSPFactoryFromBitcodeAux(const string& bitcode, string& error_msg)
 {
+    LOCK_API
     try {
         dsp_factory_table<SDsp_factory>::factory_iterator it;
         interpreter_dsp_factory* factory = 0;
@@ -142,8 +152,7 @@ static interpreter_dsp_factory* readInterpreterDSPFactoryFromBitcodeAux(const st
                 throw faustexception("ERROR : unrecognized file format\n");
             }
 
-            gInterpreterFactoryTable.setFactory(factory);
-            factory->setSHAKey(sha_key);
+            gInterpreterFactoryTable.setFactory(factory, sha_key);
             factory->setDSPCode(bitcode);
             return factory;
         }
@@ -191,6 +200,83 @@ EXPORT void writeInterpreterDSPFactoryToBitcodeFile(interpreter_dsp_factory* fac
     factory->write(&writer, true);
 }
 
+static interpreter_dsp_factory* readInterpreterDSPFactoryFromBinaryAux(const char* buffer, size_t size,
+                                                                       string& error_msg)
+{
+    LOCK_API
+    try {
+        dsp_factory_table<SDsp_factory>::factory_iterator it;
+        string sha_key = generateSHA1(string(buffer, size));
+
+        if (gInterpreterFactoryTable.getFactory(sha_key, it)) {
+            SDsp_factory sfactory = (*it).first;
+            sfactory->addReference();
+            return sfactory;
+        } else {
+            interpreter_dsp_factory* factory = nullptr;
+            vector<FBCBinaryReader>  sections;
+            int                      real_size = readFBCBinary(buffer, size, sections);
+
+            if (real_size == sizeof(float)) {
+                factory = new interpreter_dsp_factory(interpreter_dsp_factory_aux<float, 0>::readBinary(sections));
+            } else if (real_size == sizeof(double)) {
+                factory = new interpreter_dsp_factory(interpreter_dsp_factory_aux<double, 0>::readBinary(sections));
+            } else {
+                throw faustexception("ERROR : unrecognized file format\n");
+            }
+
+            gInterpreterFactoryTable.setFactory(factory, sha_key);
+            return factory;
+        }
+    } catch (faustexception& e) {
+        error_msg = e.Message();
+        return nullptr;
+    }
+}
+
+static void writeInterpreterDSPFactoryToBinaryAux(interpreter_dsp_factory* factory, ostream* out)
+{
+    dsp_factory_base* factory_aux = factory->getFactory();
+    if (interpreter_dsp_factory_aux<float, 0>* float_factory = dynamic_cast<interpreter_dsp_factory_aux<float, 0>*>(factory_aux)) {
+        float_factory->writeBinary(out);
+    } else if (interpreter_dsp_factory_aux<double, 0>* double_factory = dynamic_cast<interpreter_dsp_factory_aux<double, 0>*>(factory_aux)) {
+        double_factory->writeBinary(out);
+    } else {
+        cerr << "ERROR : writeInterpreterDSPFactoryToBinary unsupported factory\n";
+    }
+}
+
+EXPORT interpreter_dsp_factory* readInterpreterDSPFactoryFromBinary(const string& binary, string& error_msg)
+{
+    return readInterpreterDSPFactoryFromBinaryAux(binary.c_str(), binary.size(), error_msg);
+}
+
+EXPORT string writeInterpreterDSPFactoryToBinary(interpreter_dsp_factory* factory)
+{
+    stringstream writer;
+    writeInterpreterDSPFactoryToBinaryAux(factory, &writer);
+    return writer.str();
+}
+
+EXPORT interpreter_dsp_factory* readInterpreterDSPFactoryFromBinaryFile(const string& binary_path, string& error_msg)
+{
+    ifstream reader(binary_path.c_str(), ios::in | ios::binary);
+    if (reader.is_open()) {
+        // The whole file is read in a single block and decoded in place
+        string binary(istreambuf_iterator<char>(reader), {});
+        return readInterpreterDSPFactoryFromBinaryAux(binary.c_str(), binary.size(), error_msg);
+    } else {
+        error_msg = "ERROR opening file '" + binary_path + "'\n";
+        return nullptr;
+    }
+}
+
+EXPORT void writeInterpreterDSPFactoryToBinaryFile(interpreter_dsp_factory* factory, const string& binary_path)
+{
+    ofstream writer(binary_path.c_str(), ios::out | ios::binary);
+    writeInterpreterDSPFactoryToBinaryAux(factory, &writer);
+}
+
 EXPORT void interpreter_dsp::metadata(Meta* meta)
 {
     fDSP->metadata(meta);
@@ -251,3 +337,13 @@ EXPORT void interpreter_dsp::compute(int count, FAUSTFLOAT** input, FAUSTFLOAT**
 {
     fDSP->compute(count, input, output);
 }
+
+EXPORT void* interpreter_dsp::getFieldAddress(const string& name, int& size)
+{
+    return fDSP->getFieldAddress(name, size);
+}
+
+EXPORT vector<string> interpreter_dsp::getFieldNames()
+{
+    return fDSP->getFieldNames();
+}
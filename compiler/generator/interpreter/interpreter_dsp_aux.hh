@@ -69,6 +69,11 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
     bool fOptimized;
     std::string fCompileOptions;
 
+    // Fields of the DSP structure : { offset, size } in the int and real heaps, used to copy
+    // the state between instances (only known when the factory is compiled, not when read from a file)
+    std::map<std::string, std::pair<int, int> > fIntFields;
+    std::map<std::string, std::pair<int, int> > fRealFields;
+
     FIRMetaBlockInstruction*             fMetaBlock;
     FIRUserInterfaceBlockInstruction<T>* fUserInterfaceBlock;
     FBCBlockInstruction<T>*              fStaticInitBlock;
@@ -248,6 +253,42 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
         }
     }
 
+    // Binary writer : code blocks are written after optimization
+    void writeBinary(std::ostream* out)
+    {
+        optimize();
+
+        FBCBinaryWriter sections[kFBCSectionCount];
+
+        FBCBinaryWriter& header = sections[kFBCHeaderSection];
+        header.writeInt(INTERP_FILE_VERSION);
+        header.writeString(FAUSTVERSION);
+        header.writeString(fCompileOptions);
+        header.writeString(fName);
+        header.writeString(fSHAKey);
+        header.writeInt(fOptLevel);
+        header.writeInt(fOptimized);
+        header.writeInt(fNumInputs);
+        header.writeInt(fNumOutputs);
+        header.writeInt(fIntHeapSize);
+        header.writeInt(fRealHeapSize);
+        header.writeInt(fSoundHeapSize);
+        header.writeInt(fSROffset);
+        header.writeInt(fCountOffset);
+        header.writeInt(fIOTAOffset);
+
+        fMetaBlock->writeBinary(&sections[kFBCMetaSection]);
+        fUserInterfaceBlock->writeBinary(&sections[kFBCUserInterfaceSection]);
+        fStaticInitBlock->writeBinary(&sections[kFBCStaticInitSection]);
+        fInitBlock->writeBinary(&sections[kFBCInitSection]);
+        fResetUIBlock->writeBinary(&sections[kFBCResetUISection]);
+        fClearBlock->writeBinary(&sections[kFBCClearSection]);
+        fComputeBlock->writeBinary(&sections[kFBCControlSection]);
+        fComputeDSPBlock->writeBinary(&sections[kFBCDSPSection]);
+
+        writeFBCBinary(out, sizeof(T), sections);
+    }
+
     // Factory reader
     static interpreter_dsp_factory_aux<T, TRACE>* read(std::istream* in)
     {
@@ -609,6 +650,139 @@ struct interpreter_dsp_factory_aux : public dsp_factory_imp {
         }
     }
 
+    // Binary factory reader (sections have been checked by readFBCBinary)
+    static interpreter_dsp_factory_aux<T, TRACE>* readBinary(std::vector<FBCBinaryReader>& sections)
+    {
+        FBCBinaryReader& header = sections[kFBCHeaderSection];
+
+        int file_num = header.readInt();
+        if (INTERP_FILE_VERSION != file_num) {
+            std::stringstream error;
+            error << "ERROR : interpreter file format version '" << file_num << "' different from compiled one '"
+                  << INTERP_FILE_VERSION << "'" << std::endl;
+            throw faustexception(error.str());
+        }
+
+        header.readString();  // Faust version
+        std::string compile_options = header.readString();
+        std::string factory_name    = header.readString();
+        std::string sha_key         = header.readString();
+        int         opt_level       = header.readInt();
+        bool        optimized       = header.readInt();
+        int         inputs          = header.readInt();
+        int         outputs         = header.readInt();
+        int         int_heap_size   = header.readInt();
+        int         real_heap_size  = header.readInt();
+        int         sound_heap_size = header.readInt();
+        int         sr_offset       = header.readInt();
+        int         count_offset    = header.readInt();
+        int         iota_offset     = header.readInt();
+
+        interpreter_dsp_factory_aux<T, TRACE>* factory = new interpreter_dsp_factory_aux(
+            factory_name, compile_options, sha_key, file_num, inputs, outputs, int_heap_size, real_heap_size,
+            sound_heap_size, sr_offset, count_offset, iota_offset, opt_level,
+            readBinaryMetaBlock(&sections[kFBCMetaSection]), readBinaryUIBlock(&sections[kFBCUserInterfaceSection]),
+            readBinaryCodeBlock(&sections[kFBCStaticInitSection]), readBinaryCodeBlock(&sections[kFBCInitSection]),
+            readBinaryCodeBlock(&sections[kFBCResetUISection]), readBinaryCodeBlock(&sections[kFBCClearSection]),
+            readBinaryCodeBlock(&sections[kFBCControlSection]), readBinaryCodeBlock(&sections[kFBCDSPSection]));
+
+        // Blocks are already optimized
+        factory->fOptimized = optimized;
+        return factory;
+    }
+
+    static FIRMetaBlockInstruction* readBinaryMetaBlock(FBCBinaryReader* in)
+    {
+        FIRMetaBlockInstruction* meta_block = new FIRMetaBlockInstruction();
+        int                      size       = in->readSize();
+
+        for (int i = 0; i < size; i++) {
+            std::string key = in->readString();
+            std::string val = in->readString();
+            meta_block->push(new FIRMetaInstruction(key, val));
+        }
+
+        return meta_block;
+    }
+
+    static FIRUserInterfaceBlockInstruction<T>* readBinaryUIBlock(FBCBinaryReader* in)
+    {
+        FIRUserInterfaceBlockInstruction<T>* ui_block = new FIRUserInterfaceBlockInstruction<T>();
+        int                                  size     = in->readSize();
+
+        for (int i = 0; i < size; i++) {
+            int         opcode = in->readInt();
+            int         offset = in->readInt();
+            std::string label  = in->readString();
+            std::string key    = in->readString();
+            std::string val    = in->readString();
+            T           init   = in->readReal<T>();
+            T           min    = in->readReal<T>();
+            T           max    = in->readReal<T>();
+            T           step   = in->readReal<T>();
+            ui_block->push(new FIRUserInterfaceInstruction<T>(FBCInstruction::Opcode(opcode), offset, label, key, val,
+                                                              init, min, max, step));
+        }
+
+        return ui_block;
+    }
+
+    static FBCBlockInstruction<T>* readBinaryCodeBlock(FBCBinaryReader* in)
+    {
+        FBCBlockInstruction<T>* code_block = new FBCBlockInstruction<T>();
+        int                     size       = in->readSize();
+
+        for (int i = 0; i < size; i++) {
+            FBCBasicInstruction<T>* inst = readBinaryCodeInstruction(in);
+            // Special case for loops
+            if (inst->fOpcode == FBCInstruction::kCondBranch) {
+                inst->fBranch1 = code_block;
+            }
+            code_block->push(inst);
+        }
+
+        return code_block;
+    }
+
+    static FBCBasicInstruction<T>* readBinaryCodeInstruction(FBCBinaryReader* in)
+    {
+        int opcode = in->readInt();
+
+        if (opcode == FBCInstruction::kBlockStoreReal) {
+            int            offset1    = in->readInt();
+            int            offset2    = in->readInt();
+            int            block_size = in->readSize();
+            std::vector<T> block_values;
+            for (int i = 0; i < block_size; i++) {
+                block_values.push_back(in->readReal<T>());
+            }
+            return new FIRBlockStoreRealInstruction<T>(FBCInstruction::Opcode(opcode), offset1, offset2, block_values);
+
+        } else if (opcode == FBCInstruction::kBlockStoreInt) {
+            int              offset1    = in->readInt();
+            int              offset2    = in->readInt();
+            int              block_size = in->readSize();
+            std::vector<int> block_values;
+            for (int i = 0; i < block_size; i++) {
+                block_values.push_back(in->readInt());
+            }
+            return new FIRBlockStoreIntInstruction<T>(FBCInstruction::Opcode(opcode), offset1, offset2, block_values);
+
+        } else {
+            int val_int  = in->readInt();
+            T   val_real = in->readReal<T>();
+            int offset1  = in->readInt();
+            int offset2  = in->readInt();
+            int branches = in->readInt();
+
+            FBCBlockInstruction<T>* branch1 = (branches & 1) ? readBinaryCodeBlock(in) : nullptr;
+            FBCBlockInstruction<T>* branch2 = (branches & 2) ? readBinaryCodeBlock(in) : nullptr;
+
+            return new FBCBasicInstruction<T>(FBCInstruction::Opcode(opcode), val_int, val_real, offset1, offset2,
+                                              branch1, branch2);
+        }
+    }
+
     void metadata(Meta* meta) { ExecuteMeta(fMetaBlock, meta); }
 
     void ExecuteMeta(FIRMetaBlockInstruction* block, Meta* meta)
@@ -638,6 +812,10 @@ struct interpreter_dsp_base : public dsp {
 
     virtual void instanceClear() {}
 
+    virtual void* getFieldAddress(const std::string& name, int& size) { return nullptr; }
+
+    virtual std::vector<std::string> getFieldNames() { return std::vector<std::string>(); }
+
     // Not implemented...
     virtual void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs) {}
 
@@ -711,6 +889,29 @@ class interpreter_dsp_aux : public interpreter_dsp_base {
 
     virtual int getNumOutputs() { return fFactory->fNumOutputs; }
 
+    virtual void* getFieldAddress(const std::string& name, int& size)
+    {
+        std::map<std::string, std::pair<int, int> >::iterator it1 = fFactory->fIntFields.find(name);
+        if (it1 != fFactory->fIntFields.end() && fFBCExecutor->getIntHeap()) {
+            size = it1->second.second * sizeof(int);
+            return &fFBCExecutor->getIntHeap()[it1->second.first];
+        }
+        std::map<std::string, std::pair<int, int> >::iterator it2 = fFactory->fRealFields.find(name);
+        if (it2 != fFactory->fRealFields.end() && fFBCExecutor->getRealHeap()) {
+            size = it2->second.second * sizeof(T);
+            return &fFBCExecutor->getRealHeap()[it2->second.first];
+        }
+        return nullptr;
+    }
+
+    virtual std::vector<std::string> getFieldNames()
+    {
+        std::vector<std::string> names;
+        for (auto& it : fFactory->fIntFields) names.push_back(it.first);
+        for (auto& it : fFactory->fRealFields) names.push_back(it.first);
+        return names;
+    }
+
     virtual int getInputRate(int channel) { return -1; }
 
     virtual int getOutputRate(int channel) { return -1; }
@@ -1203,6 +1404,10 @@ class EXPORT interpreter_dsp : public dsp {
     void metadata(Meta* meta);
 
     void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs);
+
+    void* getFieldAddress(const std::string& name, int& size);
+
+    std::vector<std::string> getFieldNames();
 };
 
 class EXPORT interpreter_dsp_factory : public dsp_factory, public faust_smartable {
@@ -1277,6 +1482,15 @@ EXPORT interpreter_dsp_factory* readInterpreterDSPFactoryFromBitcodeFile(const s
 EXPORT void writeInterpreterDSPFactoryToBitcodeFile(interpreter_dsp_factory* factory,
                                                     const std::string&       bitcode_path);
 
+EXPORT interpreter_dsp_factory* readInterpreterDSPFactoryFromBinary(const std::string& binary, std::string& error_msg);
+
+EXPORT std::string writeInterpreterDSPFactoryToBinary(interpreter_dsp_factory* factory);
+
+EXPORT interpreter_dsp_factory* readInterpreterDSPFactoryFromBinaryFile(const std::string& binary_path,
+                                                                        std::string&       error_msg);
+
+EXPORT void writeInterpreterDSPFactoryToBinaryFile(interpreter_dsp_factory* factory, const std::string& binary_path);
+
 EXPORT void deleteAllInterpreterDSPFactories();
 
 #endif
@@ -45,6 +45,8 @@ EXPORT interpreter_dsp_factory* createInterpreterDSPFactoryFromFile(const string
 EXPORT interpreter_dsp_factory* createInterpreterDSPFactoryFromString(const string& name_app, const string& dsp_content,
                                                                       int argc, const char* argv[], string& error_msg)
 {
+    LOCK_API
+
     string expanded_dsp_content, sha_key;
 
     if ((expanded_dsp_content = expandDSPFromString(name_app, dsp_content, argc, argv, sha_key, error_msg)) == "") {
@@ -77,8 +79,7 @@ EXPORT interpreter_dsp_factory* createInterpreterDSPFactoryFromString(const stri
             if (dsp_factory_aux) {
                 dsp_factory_aux->setName(name_app);
                 factory = new interpreter_dsp_factory(dsp_factory_aux);
-                gInterpreterFactoryTable.setFactory(factory);
-                factory->setSHAKey(sha_key);
+                gInterpreterFactoryTable.setFactory(factory, sha_key);
                 factory->setDSPCode(expanded_dsp_content);
                 return factory;
             } else {
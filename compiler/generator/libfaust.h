@@ -23,6 +23,9 @@
 #define LIBFAUST_H
 
 #include <string.h>
+#include <functional>
+#include <memory>
+#include <string>
 
 #ifdef _WIN32
 #define LIBEXPORT __declspec(dllexport)
@@ -215,6 +218,19 @@ LIBEXPORT inline std::string generateSHA1(const std::string& data)
     return sha1key;
 }
 
+/**
+ * Start multi-thread access mode : the compiler state and the factory tables are shared, so all factory
+ * functions (creation, read/write, deletion...) of all backends are then serialized by a single compiler lock.
+ *
+ * @return true if 'multi-thread' safe access is started.
+ */
+LIBEXPORT bool startMTDSPFactories();
+
+/**
+ * Stop multi-thread access mode (not to be called while compilations are running on other threads).
+ */
+LIBEXPORT void stopMTDSPFactories();
+
 /**
  * Expand a DSP source code into a self-contained DSP where all library import have been inlined starting from a
  * filename.
@@ -272,6 +288,87 @@ LIBEXPORT bool generateAuxFilesFromFile(const std::string& filename, int argc, c
 LIBEXPORT bool generateAuxFilesFromString(const std::string& name_app, const std::string& dsp_content, int argc,
                                           const char* argv[], std::string& error_msg);
 
+#ifndef EMCC
+
+/**
+ * Asynchronous compilation service : compilations are done one at a time on a background thread, by decreasing
+ * priority. Identical requests (same name, DSP code, options and backend) submitted while a previous one is pending
+ * or running share the same handle. Since the Faust compiler is not reentrant, the first submission starts the
+ * multi-thread access mode (see startMTDSPFactories) : factory functions directly called on other threads then
+ * wait for the running compilation.
+ */
+
+class dsp_factory;
+
+enum dsp_compile_state { kCompilePending, kCompileRunning, kCompileDone, kCompileFailed, kCompileCancelled };
+
+/**
+ * The backend compilation function, typically calling one of the createXXXFactoryFromString functions.
+ */
+typedef std::function<dsp_factory*(const std::string& name_app, const std::string& dsp_content, int argc,
+                                   const char* argv[], std::string& error_msg)>
+    dsp_compile_fun;
+
+/**
+ * The progress callback, called on the compilation thread with the name of the compilation stage
+ * ("options", "parser", "evaluation", "propagation", "generation", "output", and finally "done",
+ * "failed" or "cancelled") and the progress in [0..1].
+ */
+typedef std::function<void(const std::string& stage, float progress)> dsp_progress_fun;
+
+class LIBEXPORT dsp_compile_handle {
+   public:
+    virtual ~dsp_compile_handle() {}
+
+    virtual dsp_compile_state getState() = 0;
+
+    /* Wait for the compilation to be finished and return its final state */
+    virtual dsp_compile_state wait() = 0;
+
+    /*
+     Cancel the compilation : a pending compilation is removed from the queue, a running one
+     is stopped at the next compilation stage. A compilation sharing the handle is also cancelled.
+    */
+    virtual void cancel() = 0;
+
+    /* Return the factory when the state is kCompileDone, otherwise a null pointer */
+    virtual dsp_factory* getFactory() = 0;
+
+    virtual std::string getErrorMessage() = 0;
+
+    virtual std::string getSHAKey() = 0;
+};
+
+/**
+ * Submit a compilation to the asynchronous compilation service.
+ *
+ * @param name_app - the name of the Faust program
+ * @param dsp_content - the Faust program as a string
+ * @param argc - the number of parameters in argv array
+ * @param argv - the array of parameters
+ * @param backend - the backend description (like "llvm" + target), used to recognize identical requests
+ * @param compile - the backend compilation function
+ * @param priority - higher priority compilations are done first
+ * @param progress - the progress callback (possibly null)
+ * @param tag - when not empty, pending or running compilations with the same tag and a different SHA key are
+ * cancelled (typically to drop stale versions of an edited program)
+ *
+ * @return the compilation handle.
+ */
+LIBEXPORT std::shared_ptr<dsp_compile_handle> submitDSPCompilation(const std::string& name_app,
+                                                                   const std::string& dsp_content, int argc,
+                                                                   const char* argv[], const std::string& backend,
+                                                                   dsp_compile_fun compile, int priority = 0,
+                                                                   dsp_progress_fun progress = nullptr,
+                                                                   const std::string& tag = "");
+
+/**
+ * Cancel all pending and running compilations.
+ */
+LIBEXPORT void cancelAllDSPCompilations();
+
+#endif
+
 /**
  * The free function to be used on memory returned by getCDSPMachineTarget, getCName, getCSHAKey,
  * getCDSPCode, getCLibraryList, getAllCDSPFactories, writeCDSPFactoryToBitcode,
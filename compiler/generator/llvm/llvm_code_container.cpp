@@ -934,7 +934,9 @@ dsp_factory_base* LLVMCodeContainer::produceFactory()
         throw faustexception(llvm_error.str());
     }
 
-    return new llvm_dynamic_dsp_factory_aux("", fModule, fContext, "", -1);
+    llvm_dynamic_dsp_factory_aux* factory = new llvm_dynamic_dsp_factory_aux("", fModule, fContext, "", -1);
+    factory->setFieldLayout(fTypeBuilder.getFieldLayout());
+    return factory;
 }
 
 // Scalar
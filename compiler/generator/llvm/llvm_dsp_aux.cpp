@@ -100,9 +100,6 @@ int llvm_dsp_factory_aux::gInstance = 0;
 
 dsp_factory_table<SDsp_factory> llvm_dsp_factory_aux::gLLVMFactoryTable;
 
-// Global API access lock
-TLockAble* llvm_dsp_factory_aux::gDSPFactoriesLock = nullptr;
-
 void* llvm_dsp_factory_aux::loadOptimize(const string& function)
 {
     void* fun = (void*)fJIT->getFunctionAddress(function);
@@ -224,6 +221,8 @@ void llvm_dsp_factory_aux::init(const string& type_name, const string& dsp_name)
     fExpandedDSP        = "";
     fOptLevel           = 0;
     fTarget             = "";
+    fJITTime            = 0.;
+    fCodeSize           = 0;
 
     // To keep Debug functions in generated code
 #if 0
@@ -237,6 +236,7 @@ void llvm_dsp_factory_aux::init(const string& type_name, const string& dsp_name)
 bool llvm_dsp_factory_aux::initJIT(string& error_msg)
 {
     startTiming("initJIT");
+    fJITStart = chrono::steady_clock::now();
  
     // Restoring from machine code
 #if defined(LLVM_35)
@@ -264,6 +264,9 @@ bool llvm_dsp_factory_aux::initJIT(string& error_msg)
 
 bool llvm_dsp_factory_aux::initJITAux(string& error_msg)
 {
+    // Machine code is generated (or loaded from the object cache) when the functions are first accessed
+    startTiming("LLVM code generation");
+
     // Run static constructors.
     fJIT->runStaticConstructorsDestructors(false);
     fJIT->DisableLazyCompilation(true);
@@ -289,12 +292,20 @@ bool llvm_dsp_factory_aux::initJITAux(string& error_msg)
     
         // Set the default sound
         fSetDefaultSound(dynamic_defaultsound);
-        
+
+        // Functions have been compiled, so the machine code is available
+#ifndef LLVM_35
+        fCodeSize = (fObjectCache) ? int(fObjectCache->getMachineCode().size()) : 0;
+#endif
+        fJITTime = chrono::duration<double, milli>(chrono::steady_clock::now() - fJITStart).count();
+
+        endTiming("LLVM code generation");
         endTiming("initJIT");
         return true;
     } catch (
         faustexception& e) {  // Module does not contain the Faust entry points, or external symbol was not found...
         error_msg = e.Message();
+        endTiming("LLVM code generation");
         endTiming("initJIT");
         return false;
     }
@@ -367,8 +378,8 @@ llvm_dsp::llvm_dsp(llvm_dsp_factory* factory, dsp_imp* dsp) : fFactory(factory),
 
 llvm_dsp::~llvm_dsp()
 {
+    LOCK_API
     llvm_dsp_factory_aux::gLLVMFactoryTable.removeDSP(fFactory, this);
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
 
     if (fFactory->getMemoryManager()) {
         fFactory->getMemoryManager()->destroy(fDSP);
@@ -451,42 +462,40 @@ void llvm_dsp::compute(int count, FAUSTFLOAT** input, FAUSTFLOAT** output)
     fFactory->getFactory()->fCompute(fDSP, count, input, output);
 }
 
-// Public C++ API
-
-EXPORT bool startMTDSPFactories()
+void* llvm_dsp::getFieldAddress(const string& name, int& size)
 {
-    try {
-        if (!llvm_dsp_factory_aux::gDSPFactoriesLock) {
-            llvm_dsp_factory_aux::gDSPFactoriesLock = new TLockAble();
-        }
-        return true;
-    } catch (...) {
-        return false;
-    }
+    map<string, pair<int, int> >&          layout = fFactory->getFactory()->fFieldLayout;
+    map<string, pair<int, int> >::iterator it     = layout.find(name);
+    if (it == layout.end()) return nullptr;
+    size = it->second.second;
+    return reinterpret_cast<char*>(fDSP) + it->second.first;
 }
 
-EXPORT void stopMTDSPFactories()
+vector<string> llvm_dsp::getFieldNames()
 {
-    delete llvm_dsp_factory_aux::gDSPFactoriesLock;
-    llvm_dsp_factory_aux::gDSPFactoriesLock = nullptr;
+    vector<string> names;
+    for (auto& it : fFactory->getFactory()->fFieldLayout) names.push_back(it.first);
+    return names;
 }
 
+// Public C++ API
+
 EXPORT llvm_dsp_factory* getDSPFactoryFromSHAKey(const string& sha_key)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return static_cast<llvm_dsp_factory*>(llvm_dsp_factory_aux::gLLVMFactoryTable.getDSPFactoryFromSHAKey(sha_key));
 }
 
 EXPORT vector<string> getAllDSPFactories()
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return llvm_dsp_factory_aux::gLLVMFactoryTable.getAllDSPFactories();
 }
 
 EXPORT bool deleteDSPFactory(llvm_dsp_factory* factory)
 {
     if (factory) {
-        TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+        LOCK_API
         return llvm_dsp_factory_aux::gLLVMFactoryTable.deleteDSPFactory(factory);
     } else {
         return false;
@@ -505,13 +514,13 @@ EXPORT string getDSPMachineTarget()
 
 EXPORT vector<string> getLibraryList(llvm_dsp_factory* factory)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return factory->getLibraryList();
 }
 
 EXPORT void deleteAllDSPFactories()
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     llvm_dsp_factory_aux::gLLVMFactoryTable.deleteAllDSPFactories();
 }
 
@@ -570,8 +579,7 @@ static llvm_dsp_factory* readDSPFactoryFromMachineAux(MEMORY_BUFFER buffer, cons
 
         if (factory_aux->initJIT(error_msg)) {
             llvm_dsp_factory* factory = new llvm_dsp_factory(factory_aux);
-            llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory);
-            factory->setSHAKey(sha_key);
+            llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory, sha_key);
             return factory;
         } else {
             error_msg = "ERROR : readDSPFactoryFromMachine failed : " + error_msg;
@@ -586,7 +594,7 @@ static llvm_dsp_factory* readDSPFactoryFromMachineAux(MEMORY_BUFFER buffer, cons
 EXPORT llvm_dsp_factory* readDSPFactoryFromMachine(const string& machine_code, const string& target, std::string& error_msg)
 {
 #ifndef LLVM_35
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return readDSPFactoryFromMachineAux(MEMORY_BUFFER_CREATE(StringRef(base64_decode(machine_code))), target, error_msg);
 #else
 #warning "machine code is not supported..."
@@ -598,7 +606,7 @@ EXPORT llvm_dsp_factory* readDSPFactoryFromMachine(const string& machine_code, c
 EXPORT llvm_dsp_factory* readDSPFactoryFromMachineFile(const string& machine_code_path, const string& target, std::string& error_msg)
 {
 #ifndef LLVM_35
-    TLock                            lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     ErrorOr<OwningPtr<MemoryBuffer>> buffer = MemoryBuffer::getFileOrSTDIN(machine_code_path);
     if (error_code ec = buffer.getError()) {
         error_msg = "ERROR : readDSPFactoryFromMachineFile failed : " + ec.message() + "\n";
@@ -614,14 +622,14 @@ EXPORT llvm_dsp_factory* readDSPFactoryFromMachineFile(const string& machine_cod
 
 EXPORT string writeDSPFactoryToMachine(llvm_dsp_factory* factory, const string& target)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return factory->writeDSPFactoryToMachine(target);
 }
 
 EXPORT void writeDSPFactoryToMachineFile(llvm_dsp_factory* factory, const string& machine_code_path,
                                          const string& target)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     if (factory) {
         factory->writeDSPFactoryToMachineFile(machine_code_path, target);
     }
@@ -22,6 +22,7 @@
 #ifndef LLVM_DSP_AUX_H
 #define LLVM_DSP_AUX_H
 
+#include <chrono>
 #include <map>
 #include <string>
 #include <utility>
@@ -124,6 +125,10 @@ class EXPORT llvm_dsp : public dsp {
     virtual void metadata(MetaGlue* glue);
 
     virtual void compute(int count, FAUSTFLOAT** input, FAUSTFLOAT** output);
+
+    void* getFieldAddress(const std::string& name, int& size);
+
+    std::vector<std::string> getFieldNames();
 };
 
 #ifndef LLVM_35
@@ -170,6 +175,14 @@ class llvm_dsp_factory_aux : public dsp_factory_imp {
     std::string fClassName;
     std::string fTypeName;
 
+    std::chrono::steady_clock::time_point fJITStart;
+    double                                fJITTime;   // in ms
+    int                                   fCodeSize;  // machine code size in bytes
+
+    // Fields of the DSP structure : { offset, size } in bytes, used to copy the state between instances
+    // (only known when the factory is compiled, not when read from bitcode, IR or machine code)
+    std::map<std::string, std::pair<int, int> > fFieldLayout;
+
     newDspFun             fNew;
     deleteDspFun          fDelete;
     getNumInputsFun       fGetNumInputs;
@@ -240,6 +253,11 @@ class llvm_dsp_factory_aux : public dsp_factory_imp {
 
     void setClassName(const std::string& class_name) { fClassName = class_name; }
 
+    void setFieldLayout(const std::map<std::string, std::pair<int, int> >& layout) { fFieldLayout = layout; }
+
+    double getJITTime() { return fJITTime; }
+    int    getCodeSize() { return fCodeSize; }
+
     llvm_dsp* createDSPInstance(dsp_factory* factory);
 
     void metadata(Meta* m);
@@ -248,8 +266,6 @@ class llvm_dsp_factory_aux : public dsp_factory_imp {
 
     static int gInstance;
 
-    static TLockAble* gDSPFactoriesLock;
-
     static dsp_factory_table<SDsp_factory> gLLVMFactoryTable;
 };
 
@@ -280,6 +296,9 @@ class EXPORT llvm_dsp_factory : public dsp_factory, public faust_smartable {
 
     std::string getTarget() { return fFactory->getTarget(); }
 
+    double getJITTime() { return fFactory->getJITTime(); }
+    int    getCodeSize() { return fFactory->getCodeSize(); }
+
     llvm_dsp* createDSPInstance();
 
     void                setMemoryManager(dsp_memory_manager* manager) { fFactory->setMemoryManager(manager); }
@@ -329,10 +348,6 @@ EXPORT std::vector<std::string> getAllDSPFactories();
 
 EXPORT void deleteAllDSPFactories();
 
-EXPORT bool startMTDSPFactories();
-
-EXPORT void stopMTDSPFactories();
-
 // machine <==> string
 EXPORT llvm_dsp_factory* readDSPFactoryFromMachine(const std::string& machine_code, const std::string& target, std::string& error_msg);
 
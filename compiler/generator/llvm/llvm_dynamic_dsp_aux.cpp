@@ -92,12 +92,24 @@ using namespace std;
         std::cout << out_str.str() << std::endl; \
     }
 
-static void splitTarget(const string& target, string& triple, string& cpu)
-{
-    size_t pos1 = target.find_first_of(':');
-    triple      = target.substr(0, pos1);
-    if (pos1 != string::npos) {
-        cpu = target.substr(pos1 + 1);
+// Target is 'triple:cpu[:features[:vector_width]]', like 'x86_64-apple-darwin15.6.0:haswell:+avx2,-avx512f:256'
+static void splitTarget(const string& target, string& triple, string& cpu, vector<string>& features,
+                        int& vector_width)
+{
+    vector<string> items;
+    stringstream   reader(target);
+    string         item;
+    while (getline(reader, item, ':')) {
+        items.push_back(item);
+    }
+    triple       = (items.size() > 0) ? items[0] : "";
+    cpu          = (items.size() > 1) ? items[1] : "";
+    vector_width = (items.size() > 3) ? atoi(items[3].c_str()) : 0;
+    if (items.size() > 2) {
+        stringstream feature_reader(items[2]);
+        while (getline(feature_reader, item, ',')) {
+            if (item != "") features.push_back(item);
+        }
     }
 }
 
@@ -223,7 +235,10 @@ void llvm_dynamic_dsp_factory_aux::writeDSPFactoryToIRFile(const string& ir_code
 /// based on selected optimization level, OptLevel. This routine
 /// duplicates llvm-gcc behaviour.
 ///
-/// OptLevel - Optimization Level
+/// OptLevel - Optimization Level :
+///     - 0 and 1 give the 'fast JIT' profile : cheap code generation (and no loop unrolling at 0)
+///     - 2 and 3 give the default profile
+///     - 4 and 5 give the 'max throughput' profile : loop and SLP auto-vectorization are added
 static void AddOptimizationPasses(PassManagerBase& MPM, FUNCTION_PASS_MANAGER& FPM, unsigned OptLevel,
                                   unsigned SizeLevel)
 {
@@ -264,9 +279,48 @@ static void AddOptimizationPasses(PassManagerBase& MPM, FUNCTION_PASS_MANAGER& F
     Builder.populateModulePassManager(MPM);
 }
 
+static CodeGenOpt::Level getCodeGenOptLevel(int opt_level)
+{
+    switch (opt_level) {
+        case 0:
+            return CodeGenOpt::None;
+        case 1:
+            return CodeGenOpt::Less;
+        case 2:
+            return CodeGenOpt::Default;
+        default:
+            return CodeGenOpt::Aggressive;
+    }
+}
+
+// Only 'compute' runs at audio rate : other DSP methods are optimized for size,
+// and the preferred vector width (in bits) possibly given in the target is set on 'compute'
+static void setFunctionAttributes(Module* module, const string& class_name, int vector_width)
+{
+    const char* control_funs[] = {"new", "delete", "getNumInputs", "getNumOutputs", "getSampleRate",
+                                  "buildUserInterface", "metadata", "getJSON", "setDefaultSound", "classInit",
+                                  "init", "instanceInit", "instanceConstants", "instanceResetUserInterface",
+                                  "instanceClear", 0};
+
+    for (int i = 0; control_funs[i]; i++) {
+        Function* fun = module->getFunction(string(control_funs[i]) + class_name);
+        if (fun && !fun->isDeclaration()) {
+            fun->addFnAttr(Attribute::OptimizeForSize);
+        }
+    }
+
+    Function* compute = module->getFunction("compute" + class_name);
+    if (compute && vector_width > 0) {
+        stringstream width;
+        width << vector_width;
+        compute->addFnAttr("prefer-vector-width", width.str());
+    }
+}
+
 bool llvm_dynamic_dsp_factory_aux::initJIT(string& error_msg)
 {
     startTiming("initJIT");
+    fJITStart = chrono::steady_clock::now();
     faustassert(fModule);
 
 #ifdef LLVM_BUILD_UNIVERSAL
@@ -309,7 +363,7 @@ bool llvm_dynamic_dsp_factory_aux::initJIT(string& error_msg)
     EngineBuilder builder((unique_ptr<Module>(fModule)));
 #endif
 
-    builder.setOptLevel(CodeGenOpt::Aggressive);
+    builder.setOptLevel(getCodeGenOptLevel(fOptLevel));
     builder.setEngineKind(EngineKind::JIT);
 #if !defined(LLVM_60) && !defined(LLVM_70) && !defined(LLVM_80)
     builder.setCodeModel(CodeModel::JITDefault);
@@ -332,11 +386,14 @@ bool llvm_dynamic_dsp_factory_aux::initJIT(string& error_msg)
     string        target_suffix = "";
 #endif
 
-    string triple, cpu;
-    splitTarget(fTarget, triple, cpu);
+    string         triple, cpu;
+    vector<string> features;
+    int            vector_width = 0;
+    splitTarget(fTarget, triple, cpu, features, vector_width);
     fModule->setTargetTriple(triple + target_suffix);
 
     builder.setMCPU((cpu == "") ? llvm::sys::getHostCPUName() : StringRef(cpu));
+    builder.setMAttrs(features);
     TargetOptions targetOptions;
 
     // -fastmath is activated at IR level, and has to be setup at JIT level also
@@ -398,6 +455,8 @@ bool llvm_dynamic_dsp_factory_aux::initJIT(string& error_msg)
         pm.add(createTargetTransformInfoWrapperPass(tm->getTargetIRAnalysis()));
 #endif
 
+        setFunctionAttributes(fModule, fClassName, vector_width);
+
         if (fOptLevel > 0) {
             AddOptimizationPasses(pm, fpm, fOptLevel, 0);
         }
@@ -411,6 +470,7 @@ bool llvm_dynamic_dsp_factory_aux::initJIT(string& error_msg)
             dumpLLVM(fModule);
         }
 
+        startTiming("LLVM optimization");
         fpm.doInitialization();
         for (Module::iterator F = fModule->begin(), E = fModule->end(); F != E; ++F) {
             fpm.run(*F);
@@ -429,6 +489,7 @@ bool llvm_dynamic_dsp_factory_aux::initJIT(string& error_msg)
 
         // Now that we have all of the passes ready, run them.
         pm.run(*fModule);
+        endTiming("LLVM optimization");
 
         if ((debug_var != "") && (debug_var.find("FAUST_LLVM2") != string::npos)) {
             dumpLLVM(fModule);
@@ -464,7 +525,7 @@ EXPORT llvm_dsp_factory* createDSPFactoryFromString(const string& name_app, cons
                                                     const char* argv[], const string& target, string& error_msg,
                                                     int opt_level)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
 
     string expanded_dsp_content, sha_key;
 
@@ -510,12 +571,14 @@ EXPORT llvm_dsp_factory* createDSPFactoryFromString(const string& name_app, cons
                     factory_aux->setOptlevel(opt_level);
                     factory_aux->setClassName(getParam(argc, argv, "-cn", "mydsp"));
                     factory_aux->setName(name_app);
-                    if (!factory_aux->initJIT(error_msg)) {
+                    bool jit = factory_aux->initJIT(error_msg);
+                    // Rewrite the trace file (-tt) written by compileFaustFactory, with the JIT phases
+                    writeTimingTrace();
+                    if (!jit) {
                         goto error;
                     }
                     factory = new llvm_dsp_factory(factory_aux);
-                    llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory);
-                    factory->setSHAKey(sha_key);
+                    llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory, sha_key);
                     factory->setDSPCode(expanded_dsp_content);
                     return factory;
                 }
@@ -552,8 +615,7 @@ static llvm_dsp_factory* readDSPFactoryFromBitcodeAux(MEMORY_BUFFER buffer, cons
 
         if (factory_aux->initJIT(error_msg)) {
             llvm_dsp_factory* factory = new llvm_dsp_factory(factory_aux);
-            llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory);
-            factory->setSHAKey(sha_key);
+            llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory, sha_key);
             return factory;
         } else {
             error_msg = "ERROR : readDSPFactoryFromBitcode failed : " + error_msg;
@@ -565,20 +627,20 @@ static llvm_dsp_factory* readDSPFactoryFromBitcodeAux(MEMORY_BUFFER buffer, cons
 
 EXPORT llvm_dsp_factory* readDSPFactoryFromBitcode(const string& bit_code, const string& target, string& error_msg, int opt_level)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return readDSPFactoryFromBitcodeAux(MEMORY_BUFFER_CREATE(StringRef(base64_decode(bit_code))), target, error_msg, opt_level);
 }
 
 EXPORT string writeDSPFactoryToBitcode(llvm_dsp_factory* factory)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return (factory) ? factory->writeDSPFactoryToBitcode() : "";
 }
 
 // Bitcode <==> file
 EXPORT llvm_dsp_factory* readDSPFactoryFromBitcodeFile(const string& bit_code_path, const string& target, string& error_msg, int opt_level)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     
     ErrorOr<OwningPtr<MemoryBuffer>> buffer = MemoryBuffer::getFileOrSTDIN(bit_code_path);
     
@@ -592,7 +654,7 @@ EXPORT llvm_dsp_factory* readDSPFactoryFromBitcodeFile(const string& bit_code_pa
 
 EXPORT void writeDSPFactoryToBitcodeFile(llvm_dsp_factory* factory, const string& bit_code_path)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     if (factory) {
         factory->writeDSPFactoryToBitcodeFile(bit_code_path);
     }
@@ -632,8 +694,7 @@ static llvm_dsp_factory* readDSPFactoryFromIRAux(MEMORY_BUFFER buffer, const str
 
         if (factory_aux->initJIT(error_msg)) {
             llvm_dsp_factory* factory = new llvm_dsp_factory(factory_aux);
-            llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory);
-            factory->setSHAKey(sha_key);
+            llvm_dsp_factory_aux::gLLVMFactoryTable.setFactory(factory, sha_key);
             return factory;
         } else {
             error_msg = "ERROR : readDSPFactoryFromBitcode failed : " + error_msg;
@@ -645,20 +706,20 @@ static llvm_dsp_factory* readDSPFactoryFromIRAux(MEMORY_BUFFER buffer, const str
 
 EXPORT llvm_dsp_factory* readDSPFactoryFromIR(const string& ir_code, const string& target, string& error_msg, int opt_level)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return readDSPFactoryFromIRAux(MEMORY_BUFFER_CREATE(StringRef(ir_code)), target, error_msg, opt_level);
 }
 
 EXPORT string writeDSPFactoryToIR(llvm_dsp_factory* factory)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     return (factory) ? factory->writeDSPFactoryToIR() : "";
 }
 
 // IR <==> file
 EXPORT llvm_dsp_factory* readDSPFactoryFromIRFile(const string& ir_code_path, const string& target, string& error_msg, int opt_level)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     
     ErrorOr<OwningPtr<MemoryBuffer>> buffer = MemoryBuffer::getFileOrSTDIN(ir_code_path);
     
@@ -672,7 +733,7 @@ EXPORT llvm_dsp_factory* readDSPFactoryFromIRFile(const string& ir_code_path, co
 
 EXPORT void writeDSPFactoryToIRFile(llvm_dsp_factory* factory, const string& ir_code_path)
 {
-    TLock lock(llvm_dsp_factory_aux::gDSPFactoriesLock);
+    LOCK_API
     if (factory) {
         factory->writeDSPFactoryToIRFile(ir_code_path);
     }
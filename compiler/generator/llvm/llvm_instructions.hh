@@ -252,6 +252,8 @@ class LLVMTypeInstVisitor : public DispatchVisitor, public LLVMTypeHelper {
     VECTOR_OF_TYPES       fDSPFields;         // vector of LLVM types (for each field)
     int                   fDSPFieldsCounter;  // fields counter
 
+    std::map<string, std::pair<int, int> > fDSPFieldsLayout;  // map of field names and { offset, size } in bytes
+
     string      fPrefix;
     DataLayout* fDataLayout;
 
@@ -677,6 +679,14 @@ class LLVMTypeInstVisitor : public DispatchVisitor, public LLVMTypeHelper {
 
         fSize = fDataLayout->getTypeSizeInBits(dsp_type) / 8;
 
+        const StructLayout* layout = fDataLayout->getStructLayout(dsp_type);
+        for (auto& it : fDSPFieldsNames) {
+            // Soundfiles are not part of the state
+            if (fDSPFields[it.second] == fTypeMap[Typed::kSound_ptr]) continue;
+            fDSPFieldsLayout[it.first] = std::make_pair(int(layout->getElementOffset(it.second)),
+                                                        int(fDataLayout->getTypeAllocSize(fDSPFields[it.second])));
+        }
+
         // Create llvm_free_dsp function
         generateFreeDsp(dsp_type_ptr, internal);
 
@@ -705,6 +715,8 @@ class LLVMTypeInstVisitor : public DispatchVisitor, public LLVMTypeHelper {
     LLVMValue getUIPtr() { return fUIInterfacePtr; }
 
     std::map<string, int> getFieldNames() { return fDSPFieldsNames; }
+
+    std::map<string, std::pair<int, int> > getFieldLayout() { return fDSPFieldsLayout; }
 };
 
 // Special version for DSP code (add call to "destroy" function)
@@ -24,6 +24,7 @@
 #include "fir_code_checker.hh"
 #include "fir_to_fir.hh"
 #include "global.hh"
+#include "timing.hh"
 
 using namespace std;
 
@@ -210,7 +211,9 @@ void VectorCodeContainer::processFIR(void)
 
     if (counter.fSizeBytes > gGlobal->gMachineMaxStackSize) {
         // Transform stack array variables in struct variables
+        startTiming("moveStack2Struct");
         moveStack2Struct();
+        endTiming("moveStack2Struct");
     } else {
         // Sort arrays to be at the begining
         // fComputeBlockInstructions->fCode.sort(sortArrayDeclarations);
@@ -221,6 +224,7 @@ void VectorCodeContainer::processFIR(void)
                                                                 InstBuilder::genLoadFunArgsVar(fFullCount));
     pushComputeBlockMethod(fullcount_dec);
   
+    startTiming("generateDAGLoop");
     if (gGlobal->gVectorLoopVariant == 0) {
         fDAGBlock = generateDAGLoopVariant0(fullcount);
     } else if (gGlobal->gVectorLoopVariant == 1) {
@@ -228,10 +232,23 @@ void VectorCodeContainer::processFIR(void)
     } else {
         faustassert(false);
     }
+    endTiming("generateDAGLoop");
     
     if (gGlobal->gRemoveVarAddress) {
         fDAGBlock = remover.getCode(fDAGBlock);
     }
+
+    // Possibly fuse vectorizable loops and replace their temporary arrays by scalars
+    if (gGlobal->gFuseLoopsSwitch) {
+        startTiming("LoopFusion");
+        LoopFusion fusion;
+        fusion.fuse(fComputeBlockInstructions, fDAGBlock);
+        endTiming("LoopFusion");
+        if (gGlobal->gDetailsSwitch) {
+            cerr << fusion.fFusedLoops << " loop(s) fused, " << fusion.fScalarizedArrays << " array(s) eliminated"
+                 << endl;
+        }
+    }
  
     // Verify code
     /*
@@ -301,11 +301,13 @@ wasm_dsp_factory* wasm_dsp_factory::readWasmDSPFactoryFromMachine2(const std::st
 
 EXPORT bool deleteWasmDSPFactory(wasm_dsp_factory* factory)
 {
+    LOCK_API
     return (factory) ? wasm_dsp_factory::gWasmFactoryTable.deleteDSPFactory(factory) : false;
 }
 
 EXPORT void deleteAllWasmDSPFactories()
 {
+    LOCK_API
     wasm_dsp_factory::gWasmFactoryTable.deleteAllDSPFactories();
 }
 
@@ -314,8 +316,7 @@ EXPORT void deleteAllWasmDSPFactories()
 EXPORT wasm_dsp_factory* readWasmDSPFactoryFromMachine(const std::string& machine_code)
 {
     wasm_dsp_factory* factory = new wasm_dsp_factory(new text_dsp_factory_aux("MachineDSP", "", "", machine_code, ""));
-    wasm_dsp_factory::gWasmFactoryTable.setFactory(factory);
-    factory->setSHAKey("");
+    wasm_dsp_factory::gWasmFactoryTable.setFactory(factory, "");
     factory->setDSPCode("");
     return factory;
 }
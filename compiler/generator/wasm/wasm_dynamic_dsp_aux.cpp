@@ -66,6 +66,8 @@ EXPORT wasm_dsp_factory* createWasmDSPFactoryFromFile(const string& filename, in
 EXPORT wasm_dsp_factory* createWasmDSPFactoryFromString(const string& name_app, const string& dsp_content, int argc,
                                                         const char* argv[], string& error_msg, bool internal_memory)
 {
+    LOCK_API
+
     /*
     string expanded_dsp_content, sha_key;
 
@@ -101,8 +103,7 @@ EXPORT wasm_dsp_factory* createWasmDSPFactoryFromString(const string& name_app,
             if (dsp_factory_aux) {
                 dsp_factory_aux->setName(name_app);
                 wasm_dsp_factory* factory = new wasm_dsp_factory(dsp_factory_aux);
-                wasm_dsp_factory::gWasmFactoryTable.setFactory(factory);
-                factory->setSHAKey(sha_key);
+                wasm_dsp_factory::gWasmFactoryTable.setFactory(factory, sha_key);
                 factory->setDSPCode(expanded_dsp_content);
                 return factory;
             } else {
@@ -136,8 +137,7 @@ EXPORT wasm_dsp_factory* createWasmDSPFactoryFromString(const string& name_app,
     if (dsp_factory_aux) {
         dsp_factory_aux->setName(name_app);
         wasm_dsp_factory* factory = new wasm_dsp_factory(dsp_factory_aux);
-        wasm_dsp_factory::gWasmFactoryTable.setFactory(factory);
-        factory->setSHAKey(sha_key);
+        wasm_dsp_factory::gWasmFactoryTable.setFactory(factory, sha_key);
         factory->setDSPCode(expanded_dsp_content);
         return factory;
     } else {
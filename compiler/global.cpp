@@ -47,6 +47,7 @@
 #include "sourcereader.hh"
 #include "sqrtprim.hh"
 #include "tanprim.hh"
+#include "timing.hh"
 #include "tree.hh"
 
 #ifdef WIN32
@@ -121,9 +122,13 @@ global::global():TABBER(1), gLoopDetector(1024, 400), gNextFreeColor(1)
     gSimplifyDiagrams = false;
     gLessTempSwitch   = false;
     gMaxCopyDelay     = 16;
+    gWrapFreeDelay    = 0;
+    gLookAhead        = 0;
 
+    gProfileInstrument = false;
     gVectorSwitch      = false;
     gDeepFirstSwitch   = false;
+    gFuseLoopsSwitch   = false;
     gVecSize           = 32;
     gVectorLoopVariant = 0;
 
@@ -232,7 +237,8 @@ global::global():TABBER(1), gLoopDetector(1024, 400), gNextFreeColor(1)
     gDummyInput = 10000;
 
     gBoxSlotNumber = 0;
-    gMemoryManager = false;
+    gMemoryManager      = false;
+    gStructLayoutSwitch = false;
 
     gOccurrences = 0;
     gFoldingFlag = false;
@@ -321,6 +327,7 @@ global::global():TABBER(1), gLoopDetector(1024, 400), gNextFreeColor(1)
     DOCMTD      = symbol("DocMtd");
     DOCTXT      = symbol("DocTxt");
     BARRIER     = symbol("BARRIER");
+    ENVLAYER    = symbol("ENV_LAYER");
     UIFOLDER    = symbol("uiFolder");
     UIWIDGET    = symbol("uiWidget");
     PATHROOT    = symbol("/");
@@ -447,6 +454,8 @@ void global::init()
     // Essential predefined types
     gMemoizedTypes   = new property<AudioType*>();
     gAllocationCount = 0;
+
+    initTiming();
     
     // True by default but only usable with -lang ocpp backend
     gEnableFlag = true;
@@ -585,22 +594,41 @@ void global::printCompilationOptions(ostream& dst, bool backend)
             << " -vs " << gVecSize << ((gFunTaskSwitch) ? " -fun" : "") << ((gGroupTaskSwitch) ? " -g" : "")
             << ((gDeepFirstSwitch) ? " -dfs" : "")
             << ((gFloatSize == 2) ? " -double" : (gFloatSize == 3) ? " -quad" : "") << " -ftz " << gFTZMode << " -mcd "
-            << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "");
+            << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "") << ((gStructLayoutSwitch) ? " -sl" : "");
+        if (gWrapFreeDelay > 0) {
+            dst << " -wfd " << gWrapFreeDelay;
+        }
+        if (gLookAhead > 1) {
+            dst << " -la " << gLookAhead;
+        }
     } else if (gVectorSwitch) {
         dst << "-vec"
             << " -lv " << gVectorLoopVariant << " -vs " << gVecSize << ((gFunTaskSwitch) ? " -fun" : "")
             << ((gGroupTaskSwitch) ? " -g" : "") << ((gDeepFirstSwitch) ? " -dfs" : "")
+            << ((gFuseLoopsSwitch) ? " -fl" : "")
             << ((gFloatSize == 2) ? " -double" : (gFloatSize == 3) ? " -quad" : "") << " -ftz " << gFTZMode << " -mcd "
-            << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "");
+            << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "") << ((gStructLayoutSwitch) ? " -sl" : "");
+        if (gWrapFreeDelay > 0) {
+            dst << " -wfd " << gWrapFreeDelay;
+        }
+        if (gLookAhead > 1) {
+            dst << " -la " << gLookAhead;
+        }
     } else if (gOpenMPSwitch) {
         dst << "-omp"
             << " -vs " << gVecSize << " -vs " << gVecSize << ((gFunTaskSwitch) ? " -fun" : "")
             << ((gGroupTaskSwitch) ? " -g" : "") << ((gDeepFirstSwitch) ? " -dfs" : "")
             << ((gFloatSize == 2) ? " -double" : (gFloatSize == 3) ? " -quad" : "") << " -ftz " << gFTZMode << " -mcd "
-            << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "");
+            << gGlobal->gMaxCopyDelay << ((gMemoryManager) ? " -mem" : "") << ((gStructLayoutSwitch) ? " -sl" : "");
+        if (gWrapFreeDelay > 0) {
+            dst << " -wfd " << gWrapFreeDelay;
+        }
+        if (gLookAhead > 1) {
+            dst << " -la " << gLookAhead;
+        }
     } else {
         dst << ((gFloatSize == 1) ? "-scal" : ((gFloatSize == 2) ? "-double" : (gFloatSize == 3) ? "-quad" : ""))
-            << " -ftz " << gFTZMode << ((gMemoryManager) ? " -mem" : "");
+            << " -ftz " << gFTZMode << ((gMemoryManager) ? " -mem" : "") << ((gStructLayoutSwitch) ? " -sl" : "");
     }
 }
 
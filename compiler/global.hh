@@ -62,6 +62,7 @@ class WASMInstVisitor;
 struct DeclareStructTypeInst;
 
 struct Typed;
+struct Automaton;
 struct BasicTyped;
 
 class dsp_factory_base;
@@ -99,6 +100,7 @@ struct global {
     string         gDocName;
     vector<string> gImportDirList;        // dir list enrobage.cpp/fopensearch() searches for imports, etc.
     vector<string> gArchitectureDirList;  // dir list enrobage.cpp/fopensearch() searches for architecture files
+    string         gLibraryCacheDir;      // directory of the precompiled library cache (none if empty)
     vector<string> gLibraryList;
     string         gOutputDir;
     string         gImportFilename;
@@ -116,10 +118,15 @@ struct global {
     bool   gSimplifyDiagrams;
     bool   gLessTempSwitch;
     int    gMaxCopyDelay;
+    int    gWrapFreeDelay;
+    int    gLookAhead;
+    bool   gProfileInstrument;          // Count the select2 conditions in 'profile' bargraphs (-pgi)
+    map<string, double> gSelectProfile;  // Profiled ratio of true conditions of each select2 (-pgu)
     string gOutputFile;
 
     bool gVectorSwitch;
     bool gDeepFirstSwitch;
+    bool gFuseLoopsSwitch;
     int  gVecSize;
     int  gVectorLoopVariant;
 
@@ -212,6 +219,7 @@ struct global {
     int gBoxSlotNumber;  ///< counter for unique slot number
 
     bool gMemoryManager;
+    bool gStructLayoutSwitch;
 
     bool gLocalCausalityCheck;  ///< when true trigs local causality errors (negative delay)
     bool gCausality;  ///< (FIXME: global used as a parameter of typeAnnotation) when true trigs causality errors
@@ -319,6 +327,7 @@ struct global {
     Sym DOCMTD;
     Sym DOCTXT;
     Sym BARRIER;
+    Sym ENVLAYER;
 
     property<bool>* gPureRoutingProperty;
     property<Tree>* gSymbolicBoxProperty;
@@ -340,6 +349,8 @@ struct global {
     // the property used to memoize the results
     property<Tree>* gSymListProp;
 
+    map<Tree, Automaton*> gAutomata;  // pattern matching automata, indexed by their evaluated rules
+
     Sym SIGINPUT;
     Sym SIGOUTPUT;
     Sym SIGDELAY1;
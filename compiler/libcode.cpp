@@ -37,6 +37,7 @@
 #include "description.hh"
 #include "doc.hh"
 #include "drawschema.hh"
+#include "dsp_compile_service.hh"
 #include "enrobage.hh"
 #include "errormsg.hh"
 #include "eval.hh"
@@ -306,7 +307,8 @@ static void* threadBoxPropagateSig(void* arg)
 global* gGlobal = NULL;
 
 // Timing can be used outside of the scope of 'gGlobal'
-extern bool gTimingSwitch;
+extern bool   gTimingSwitch;
+extern string gTimingTraceFile;
 
 /****************************************************************
                         Parser variables
@@ -330,6 +332,27 @@ static bool isCmd(const char* cmd, const char* kw1, const char* kw2)
     return (strcmp(cmd, kw1) == 0) || (strcmp(cmd, kw2) == 0);
 }
 
+/*
+    A select profile has one 'select_<key> <ratio>' line per select2, the ratio being how often its condition is true.
+    It is written by the architecture files from the 'profile' bargraphs of a DSP compiled with -pgi.
+*/
+static void readSelectProfile(const string& filename)
+{
+    ifstream reader(filename.c_str());
+    if (!reader.is_open()) {
+        throw faustexception("ERROR : cannot open profile file '" + filename + "'\n");
+    }
+    string line;
+    while (getline(reader, line)) {
+        stringstream stream(line);
+        string       key;
+        double       ratio;
+        if ((line.size() > 0) && (line[0] != '#') && (stream >> key >> ratio)) {
+            gGlobal->gSelectProfile[key] = ratio;
+        }
+    }
+}
+
 static bool processCmdline(int argc, const char* argv[])
 {
     int          i   = 1;
@@ -457,10 +480,30 @@ static bool processCmdline(int argc, const char* argv[])
             gGlobal->gMaxCopyDelay = std::atoi(argv[i + 1]);
             i += 2;
 
+        } else if (isCmd(argv[i], "-wfd", "--wrap-free-delay") && (i + 1 < argc)) {
+            gGlobal->gWrapFreeDelay = std::atoi(argv[i + 1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-la", "--look-ahead") && (i + 1 < argc)) {
+            gGlobal->gLookAhead = std::atoi(argv[i + 1]);
+            i += 2;
+
+        } else if (isCmd(argv[i], "-pgi", "--profile-instrument")) {
+            gGlobal->gProfileInstrument = true;
+            i += 1;
+
+        } else if (isCmd(argv[i], "-pgu", "--profile-use") && (i + 1 < argc)) {
+            readSelectProfile(argv[i + 1]);
+            i += 2;
+
         } else if (isCmd(argv[i], "-mem", "--memory-manager")) {
             gGlobal->gMemoryManager = true;
             i += 1;
 
+        } else if (isCmd(argv[i], "-sl", "--struct-layout")) {
+            gGlobal->gStructLayoutSwitch = true;
+            i += 1;
+
         } else if (isCmd(argv[i], "-sd", "--simplify-diagrams")) {
             gGlobal->gSimplifyDiagrams = true;
             i += 1;
@@ -477,6 +520,10 @@ static bool processCmdline(int argc, const char* argv[])
             gGlobal->gDeepFirstSwitch = true;
             i += 1;
 
+        } else if (isCmd(argv[i], "-fl", "--fuse-loops")) {
+            gGlobal->gFuseLoopsSwitch = true;
+            i += 1;
+
         } else if (isCmd(argv[i], "-vs", "--vec-size") && (i + 1 < argc)) {
             gGlobal->gVecSize = std::atoi(argv[i + 1]);
             i += 2;
@@ -526,6 +573,10 @@ static bool processCmdline(int argc, const char* argv[])
             gTimingSwitch = true;
             i += 1;
 
+        } else if (isCmd(argv[i], "-tt", "--time-trace") && (i + 1 < argc)) {
+            gTimingTraceFile = argv[i + 1];
+            i += 2;
+
             // double float options
         } else if (isCmd(argv[i], "-single", "--single-precision-floats")) {
             if (float_size) {
@@ -624,6 +675,10 @@ static bool processCmdline(int argc, const char* argv[])
             }
             i += 2;
 
+        } else if (isCmd(argv[i], "-lcd", "--library-cache-dir") && (i + 1 < argc)) {
+            gGlobal->gLibraryCacheDir = argv[i + 1];
+            i += 2;
+
         } else if (isCmd(argv[i], "-A", "--architecture-dir") && (i + 1 < argc)) {
             if ((strstr(argv[i + 1], "http://") != 0) || (strstr(argv[i + 1], "https://") != 0)) {
                 gGlobal->gArchitectureDirList.push_back(argv[i + 1]);
@@ -809,11 +864,15 @@ static void printHelp()
     cout << tab << "-A <dir>  --architecture-dir <dir>      add the directory <dir> to the architecture search path."
          << endl;
     cout << tab << "-I <dir>  --import-dir <dir>            add the directory <dir> to the import search path." << endl;
+    cout << tab << "-lcd <dir> --library-cache-dir <dir>    keep precompiled libraries in <dir> (default $FAUST_LIB_CACHE)."
+         << endl;
     cout << tab << "-L <file> --library <file>              link with the LLVM module <file>." << endl;
 
     cout << tab << "-t <sec>  --timeout <sec>               abort compilation after <sec> seconds (default 120)."
          << endl;
     cout << tab << "-time     --compilation-time            display compilation phases timing information." << endl;
+    cout << tab << "-tt <file> --time-trace <file>          write compilation phases timing and statistics in <file> (Chrome trace format)."
+         << endl;
 
     cout << endl << "Output options:" << line;
     cout << tab << "-o <file>                               the output file." << endl;
@@ -871,6 +930,10 @@ static void printHelp()
     cout << tab
          << "-mem        --memory                    allocate static in global state using a custom memory manager."
          << endl;
+    cout << tab
+         << "-sl         --struct-layout             group DSP fields by access (audio loops, control, init) and move "
+            "big arrays at the end."
+         << endl;
     cout << tab
          << "-ftz <n>    --flush-to-zero <n>         code added to recursive signals [0:no (default), 1:fabs based, "
             "2:mask based (fastest)]."
@@ -887,6 +950,15 @@ static void printHelp()
     cout << tab << "-vec       --vectorize                  generate easier to vectorize code." << endl;
     cout << tab << "-vs <n>    --vec-size <n>               size of the vector (default 32 samples)." << endl;
     cout << tab << "-lv <n>    --loop-variant <n>           [0:fastest (default), 1:simple]." << endl;
+    cout << tab
+         << "-wfd <n>   --wrap-free-delay <n>        threshold from which ring buffer delay lines are accessed without "
+            "index masking (default 0: never)."
+         << endl;
+    cout << tab
+         << "-la <n>    --look-ahead <n>             rewrite linear recursions with control-rate coefficients with a "
+            "look-ahead of <n> samples (default 0: never), exact while the coefficients are constant over the "
+            "look-ahead window."
+         << endl;
     cout << tab << "-omp       --openmp                     generate OpenMP pragmas, activates --vectorize option."
          << endl;
     cout << tab << "-pl        --par-loop                   generate parallel loops in --openmp mode." << endl;
@@ -897,6 +969,8 @@ static void printHelp()
     cout << tab << "-ocl       --opencl                     generate tasks with OpenCL (experimental)." << endl;
     cout << tab << "-cuda      --cuda                       generate tasks with CUDA (experimental)." << endl;
     cout << tab << "-dfs       --deep-first-scheduling      schedule vector loops in deep first order." << endl;
+    cout << tab << "-fl        --fuse-loops                 fuse vector loops and replace their temporary arrays by scalars."
+         << endl;
     cout << tab
          << "-g         --group-tasks                group single-threaded sequential tasks together when -omp or -sch "
             "is used."
@@ -910,6 +984,14 @@ static void printHelp()
             "<file>,"
          << endl;
     cout << tab << "                                        use 'faust/dsp/fastmath.cpp' when file is 'def'." << endl;
+    cout << tab
+         << "-pgi       --profile-instrument         count how often each select2 condition is true, in the bargraphs "
+            "of a 'profile' group."
+         << endl;
+    cout << tab
+         << "-pgu <f>   --profile-use <f>            compile the select2 with the profile <f> written from a -pgi run "
+            "(LLVM backend)."
+         << endl;
 
     cout << endl << "Block diagram options:" << line;
     cout << tab << "-ps        --postscript                 print block-diagram to a postscript file." << endl;
@@ -1001,6 +1083,7 @@ static void oldprintHelp()
     cout << "-pn <name> \t--process-name <name> specify the name of the dsp entry-point instead of process \n";
     cout << "-t <sec> \t--timeout <sec>, abort compilation after <sec> seconds (default 120)\n";
     cout << "-time \t\t--compilation-time, flag to display compilation phases timing information\n";
+    cout << "-tt <file> \t--time-trace <file>, write compilation phases timing and statistics in <file> (Chrome trace format)\n";
     cout << "-o <file> \tC, C++, JAVA, JavaScript, ASM JavaScript, WebAssembly, LLVM IR or FVM (interpreter) output "
             "file\n";
     cout << "-scal   \t--scalar generate non-vectorized code\n";
@@ -1029,6 +1112,7 @@ static void oldprintHelp()
     cout << "-norm \t\t--normalized-form print signals in normalized form and exits\n";
     cout << "-A <dir> \t--architecture-dir <dir> add the directory <dir> to the architecture search path\n";
     cout << "-I <dir> \t--import-dir <dir> add the directory <dir> to the import search path\n";
+    cout << "-lcd <dir> \t--library-cache-dir <dir> keep precompiled libraries in <dir> (default $FAUST_LIB_CACHE)\n";
     cout << "-L <file> \t--library <file> link with the LLVM module <file>\n";
     cout << "-O <dir> \t--output-dir <dir> specify the relative directory of the generated output code, and the output "
             "directory of additional generated files (SVG, XML...)\n";
@@ -1201,6 +1285,9 @@ static void initFaustDirectories(int argc, const char* argv[])
     if (char* envpath = getenv("FAUST_LIB_PATH")) {
         gGlobal->gImportDirList.push_back(envpath);
     }
+    if (char* envpath = getenv("FAUST_LIB_CACHE")) {
+        gGlobal->gLibraryCacheDir = envpath;
+    }
 #ifdef INSTALL_PREFIX
     gGlobal->gImportDirList.push_back(INSTALL_PREFIX "/share/faust");
 #endif
@@ -1909,11 +1996,13 @@ static string expandDSPInternal(int argc, const char* argv[], const char* name,
     initDocumentNames();
     initFaustFloat();
 
+    checkCompileCancelled();
     parseSourceFiles();
 
     /****************************************************************
      3 - evaluate 'process' definition
     *****************************************************************/
+    checkCompileCancelled();
     callFun(threadEvaluateBlockDiagram);  // In a thread with more stack size...
     if (!gGlobal->gProcessTree) {
         throw faustexception(gGlobal->gErrorMessage);
@@ -1943,6 +2032,7 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
     /****************************************************************
      1 - process command line
     *****************************************************************/
+    compileStage("options", 0.f);
     initFaustDirectories(argc, argv);
     processCmdline(argc, argv);
 
@@ -2002,12 +2092,14 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
     initDocumentNames();
     initFaustFloat();
 
+    compileStage("parser", 0.1f);
     parseSourceFiles();
 
     /****************************************************************
      3 - evaluate 'process' definition
     *****************************************************************/
 
+    compileStage("evaluation", 0.3f);
     callFun(threadEvaluateBlockDiagram);  // In a thread with more stack size...
     if (!gGlobal->gProcessTree) {
         throw faustexception(gGlobal->gErrorMessage);
@@ -2041,6 +2133,7 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
     /****************************************************************
      4 - compute output signals of 'process'
     *****************************************************************/
+    compileStage("propagation", 0.5f);
     startTiming("propagation");
 
     callFun(threadBoxPropagateSig);  // In a thread with more stack size...
@@ -2060,11 +2153,13 @@ static void compileFaustFactoryAux(int argc, const char* argv[], const char* nam
     /*************************************************************************
     5 - preparation of the signal tree and translate output signals
     **************************************************************************/
+    compileStage("generation", 0.6f);
     generateCode(lsignals, numInputs, numOutputs, generate);
 
     /****************************************************************
      6 - generate xml description, documentation or dot files
     *****************************************************************/
+    compileStage("output", 0.9f);
     generateOutputFiles();
 }
 
@@ -2085,6 +2180,7 @@ dsp_factory_base* compileFaustFactory(int argc, const char* argv[], const char*
         error_msg = e.Message();
     }
 
+    writeTimingTrace();
     global::destroy();
     return factory;
 }
@@ -0,0 +1,368 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#if !defined(_WIN32) && !defined(EMCC)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LIBCACHE_MMAP
+#endif
+
+#include "boxes.hh"
+#include "export.hh"
+#include "global.hh"
+#include "libcache.hh"
+#include "signals.hh"
+
+using namespace std;
+
+#define LIBCACHE_MAGIC "FBLC"
+#define LIBCACHE_VERSION 1
+#define LIBCACHE_ENDIAN 0x01020304
+
+enum { kPropDefLine, kPropUseLine };
+
+// The primitives used by the parser (boxPrimN nodes are function pointers, only valid in the current process)
+static void* gLibPrims[] = {
+    (void*)sigDelay1,   (void*)sigFloatCast,    (void*)sigIntCast,      (void*)sigAND,         (void*)sigAdd,
+    (void*)sigAttach,   (void*)sigControl,      (void*)sigDiv,          (void*)sigEQ,          (void*)sigEnable,
+    (void*)sigFixDelay, (void*)sigGE,           (void*)sigGT,           (void*)sigLE,          (void*)sigLT,
+    (void*)sigLeftShift, (void*)sigMul,         (void*)sigNE,           (void*)sigOR,          (void*)sigPrefix,
+    (void*)sigRem,      (void*)sigRightShift,   (void*)sigSub,          (void*)sigXOR,         (void*)sigReadOnlyTable,
+    (void*)sigSelect2,  (void*)sigSelect3,      (void*)sigWriteReadTable};
+
+static const int gLibPrimsCount = sizeof(gLibPrims) / sizeof(void*);
+
+// FNV-1a hash
+static uint64_t libHash(uint64_t hash, const string& str)
+{
+    for (size_t i = 0; i < str.size(); i++) {
+        hash = (hash ^ uint8_t(str[i])) * 1099511628211ULL;
+    }
+    // Separator, so that the concatenation of strings is not ambiguous
+    return (hash ^ 0xff) * 1099511628211ULL;
+}
+
+uint64_t LibraryCache::getKey(const string& name, const string& fullpath, const string& content)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hash          = libHash(hash, FAUSTVERSION);
+    hash          = libHash(hash, name);
+    hash          = libHash(hash, fullpath);
+    return libHash(hash, content);
+}
+
+string LibraryCache::path(uint64_t key)
+{
+    char name[32];
+    snprintf(name, 32, "%016llx.fbl", (unsigned long long)key);
+    return fDir + "/" + name;
+}
+
+/*
+ Serialization of a set of trees in bottom-up order
+*/
+
+struct LibWriter {
+    string         fBuffer;
+    map<Tree, int> fIndex;
+    int            fCount;
+
+    LibWriter() : fCount(0) {}
+
+    void writeInt(int32_t val) { fBuffer.append((const char*)&val, sizeof(int32_t)); }
+
+    // Returns the index of the tree, or -1 if it can't be serialized
+    int writeTree(Tree t)
+    {
+        map<Tree, int>::iterator it = fIndex.find(t);
+        if (it != fIndex.end()) return it->second;
+
+        // Iterative post-order traversal, since lists of definitions can be long
+        vector<pair<Tree, int> > stack;
+        stack.push_back(make_pair(t, 0));
+        while (!stack.empty()) {
+            Tree cur = stack.back().first;
+            int  b   = stack.back().second;
+            if (b < cur->arity()) {
+                stack.back().second++;
+                if (fIndex.find(cur->branch(b)) == fIndex.end()) {
+                    stack.push_back(make_pair(cur->branch(b), 0));
+                }
+            } else {
+                stack.pop_back();
+                if (fIndex.find(cur) != fIndex.end()) continue;
+                if (!writeNode(cur->node())) return -1;
+                writeInt(cur->arity());
+                for (int i = 0; i < cur->arity(); i++) writeInt(fIndex[cur->branch(i)]);
+                fIndex[cur] = fCount++;
+            }
+        }
+        return fIndex[t];
+    }
+
+    bool writeNode(const Node& n)
+    {
+        switch (n.type()) {
+            case kIntNode:
+                writeInt(kIntNode);
+                writeInt(n.getInt());
+                return true;
+            case kDoubleNode: {
+                double val = n.getDouble();
+                writeInt(kDoubleNode);
+                fBuffer.append((const char*)&val, sizeof(double));
+                return true;
+            }
+            case kSymNode: {
+                const char* str = name(n.getSym());
+                writeInt(kSymNode);
+                writeInt(int32_t(strlen(str)));
+                fBuffer.append(str);
+                return true;
+            }
+            case kPointerNode:
+                for (int i = 0; i < gLibPrimsCount; i++) {
+                    if (gLibPrims[i] == n.getPointer()) {
+                        writeInt(kPointerNode);
+                        writeInt(i);
+                        return true;
+                    }
+                }
+                return false;
+            default:
+                return false;
+        }
+    }
+};
+
+struct LibReader {
+    const char*  fBuffer;
+    size_t       fSize;
+    size_t       fPos;
+    vector<Tree> fTrees;
+
+    LibReader(const char* buffer, size_t size) : fBuffer(buffer), fSize(size), fPos(0) {}
+
+    bool check(size_t size) { return fPos + size <= fSize; }
+
+    bool readInt(int32_t& val)
+    {
+        if (!check(sizeof(int32_t))) return false;
+        memcpy(&val, fBuffer + fPos, sizeof(int32_t));
+        fPos += sizeof(int32_t);
+        return true;
+    }
+
+    bool readTree(Tree& t)
+    {
+        int32_t index;
+        if (!readInt(index) || index < 0 || index >= int32_t(fTrees.size())) return false;
+        t = fTrees[index];
+        return true;
+    }
+
+    bool readNode(Node& n)
+    {
+        int32_t type, val;
+        if (!readInt(type)) return false;
+        switch (type) {
+            case kIntNode:
+                if (!readInt(val)) return false;
+                n = Node(int(val));
+                return true;
+            case kDoubleNode: {
+                double dval;
+                if (!check(sizeof(double))) return false;
+                memcpy(&dval, fBuffer + fPos, sizeof(double));
+                fPos += sizeof(double);
+                n = Node(dval);
+                return true;
+            }
+            case kSymNode:
+                if (!readInt(val) || val < 0 || !check(val)) return false;
+                n = Node(symbol(string(fBuffer + fPos, val)));
+                fPos += val;
+                return true;
+            case kPointerNode:
+                if (!readInt(val) || val < 0 || val >= gLibPrimsCount) return false;
+                n = Node(gLibPrims[val]);
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Rebuild the trees, the properties and the metadata
+    bool read(uint64_t key, Tree& ldef, LibMetadata& metadata)
+    {
+        int32_t  val, count;
+        uint64_t key1;
+        if (!check(4) || strncmp(fBuffer, LIBCACHE_MAGIC, 4) != 0) return false;
+        fPos = 4;
+        if (!readInt(val) || val != LIBCACHE_VERSION) return false;
+        if (!readInt(val) || val != LIBCACHE_ENDIAN) return false;
+        if (!check(sizeof(uint64_t))) return false;
+        memcpy(&key1, fBuffer + fPos, sizeof(uint64_t));
+        fPos += sizeof(uint64_t);
+        if (key1 != key) return false;
+
+        if (!readInt(count) || count < 0) return false;
+        fTrees.reserve(count);
+        for (int i = 0; i < count; i++) {
+            Node    n(0);
+            int32_t arity;
+            if (!readNode(n) || !readInt(arity) || arity < 0) return false;
+            tvec br(arity);
+            for (int b = 0; b < arity; b++) {
+                if (!readTree(br[b])) return false;
+            }
+            fTrees.push_back(tree(n, br));
+        }
+        if (!readTree(ldef)) return false;
+
+        // Properties are only set once the whole file has been checked
+        vector<Tree> props;
+        if (!readInt(count) || count < 0) return false;
+        for (int i = 0; i < count; i++) {
+            Tree t, v;
+            if (!readTree(t) || !readInt(val) || !readTree(v)) return false;
+            props.push_back(t);
+            props.push_back((val == kPropDefLine) ? gGlobal->DEFLINEPROP : gGlobal->USELINEPROP);
+            props.push_back(v);
+        }
+        if (!readInt(count) || count < 0) return false;
+        for (int i = 0; i < count; i++) {
+            Tree k, v;
+            if (!readTree(k) || !readTree(v)) return false;
+            metadata.push_back(make_pair(k, v));
+        }
+        for (size_t i = 0; i < props.size(); i += 3) {
+            setProperty(props[i], props[i + 1], props[i + 2]);
+        }
+        return true;
+    }
+};
+
+bool LibraryCache::load(uint64_t key, Tree& ldef, LibMetadata& metadata)
+{
+    string fname = path(key);
+    bool   res   = false;
+
+#ifdef LIBCACHE_MMAP
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* buffer = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (buffer != MAP_FAILED) {
+            LibReader reader((const char*)buffer, st.st_size);
+            res = reader.read(key, ldef, metadata);
+            munmap(buffer, st.st_size);
+        }
+    }
+    close(fd);
+#else
+    ifstream file(fname.c_str(), ios::in | ios::binary);
+    if (!file.is_open()) return false;
+    stringstream content;
+    content << file.rdbuf();
+    string    buffer = content.str();
+    LibReader reader(buffer.c_str(), buffer.size());
+    res = reader.read(key, ldef, metadata);
+#endif
+
+    if (!res) metadata.clear();
+    return res;
+}
+
+void LibraryCache::save(uint64_t key, const string& name, Tree ldef, const LibMetadata& metadata)
+{
+    LibWriter writer;
+    int       root = writer.writeTree(ldef);
+    if (root < 0) return;
+
+    // Only keep the source location properties set when parsing this file
+    Tree           file = tree(name.c_str());
+    vector<int>    props;
+    map<Tree, int> index = writer.fIndex;
+    for (map<Tree, int>::iterator it = index.begin(); it != index.end(); it++) {
+        Tree v;
+        if (getProperty(it->first, gGlobal->DEFLINEPROP, v) && hd(v) == file) {
+            int val = writer.writeTree(v);
+            if (val < 0) return;
+            props.push_back(it->second);
+            props.push_back(kPropDefLine);
+            props.push_back(val);
+        }
+        if (getProperty(it->first, gGlobal->USELINEPROP, v) && hd(v) == file) {
+            int val = writer.writeTree(v);
+            if (val < 0) return;
+            props.push_back(it->second);
+            props.push_back(kPropUseLine);
+            props.push_back(val);
+        }
+    }
+    vector<int> md;
+    for (size_t i = 0; i < metadata.size(); i++) {
+        md.push_back(writer.writeTree(metadata[i].first));
+        md.push_back(writer.writeTree(metadata[i].second));
+    }
+    for (size_t i = 0; i < md.size(); i++) {
+        if (md[i] < 0) return;
+    }
+
+    LibWriter header;
+    header.fBuffer = LIBCACHE_MAGIC;
+    header.writeInt(LIBCACHE_VERSION);
+    header.writeInt(LIBCACHE_ENDIAN);
+    header.fBuffer.append((const char*)&key, sizeof(uint64_t));
+    header.writeInt(writer.fCount);
+
+    LibWriter footer;
+    footer.writeInt(root);
+    footer.writeInt(int32_t(props.size() / 3));
+    for (size_t i = 0; i < props.size(); i++) footer.writeInt(props[i]);
+    footer.writeInt(int32_t(md.size() / 2));
+    for (size_t i = 0; i < md.size(); i++) footer.writeInt(md[i]);
+
+    // Written in a temporary file then renamed, so that concurrent compilations never see a partial file
+    stringstream tmp;
+#ifdef LIBCACHE_MMAP
+    tmp << path(key) << "." << getpid() << ".tmp";
+#else
+    tmp << path(key) << "." << (void*)this << ".tmp";
+#endif
+    ofstream out(tmp.str().c_str(), ios::out | ios::binary);
+    if (!out.is_open()) return;
+    out << header.fBuffer << writer.fBuffer << footer.fBuffer;
+    out.close();
+    if (out.fail() || rename(tmp.str().c_str(), path(key).c_str()) != 0) {
+        remove(tmp.str().c_str());
+    }
+}
@@ -0,0 +1,68 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __LIBCACHE__
+#define __LIBCACHE__
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tlib.hh"
+
+/*
+ Precompiled library cache : the result of the parsing of a library file (its list of definitions,
+ the source location properties of its identifiers, and the metadata it declares) is serialized in
+ a '<key>.fbl' file of the cache directory. The key is a hash of the library content, name and path,
+ and of the compiler version, so a cached library is only used when its source is unchanged.
+
+ The file is memory mapped and the trees are directly rebuilt in the hash-consing table, without
+ lexing or parsing:
+
+    - header : "FBLC" magic, format version, endianness marker, key, number of trees
+    - trees : in bottom-up order, each one as (node type, node value, arity, branch indexes)
+    - index of the list of definitions
+    - source location properties : (tree index, DEFLINEPROP/USELINEPROP, value index)
+    - metadata : (key index, value index)
+*/
+
+typedef std::vector<std::pair<Tree, Tree> > LibMetadata;
+
+class LibraryCache {
+   private:
+    std::string fDir;
+
+    std::string path(uint64_t key);
+
+   public:
+    LibraryCache(const std::string& dir) : fDir(dir) {}
+
+    static uint64_t getKey(const std::string& name, const std::string& fullpath, const std::string& content);
+
+    // Load the list of definitions of a library (setting its properties), and the metadata it declares
+    bool load(uint64_t key, Tree& ldef, LibMetadata& metadata);
+
+    // Save the list of definitions of a library 'name', and the metadata it declares
+    void save(uint64_t key, const std::string& name, Tree ldef, const LibMetadata& metadata);
+};
+
+#endif
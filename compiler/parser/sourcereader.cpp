@@ -40,6 +40,7 @@
 #endif
 
 #include "compatibility.hh"
+#include "libcache.hh"
 #include "sourcereader.hh"
 #include "sourcefetcher.hh"
 #include "enrobage.hh"
@@ -423,14 +424,91 @@ Tree SourceReader::getList(const char* fname)
         // Previous metadata need to be cleared before parsing a file
         gGlobal->gFunMDSet.clear();
 
-        Tree ldef = (gGlobal->gInputString) ? parseString(fname) : parseFile(fname);
+        if (!gGlobal->gInputString && useLibraryCache(fname)) {
+            fFileCache[fname] = getCachedList(fname);
+        } else {
+            Tree ldef = (gGlobal->gInputString) ? parseString(fname) : parseFile(fname);
 
-        // Definitions with metadata have to be wrapped into a boxMetadata construction
-        fFileCache[fname] = addFunctionMetadata(ldef, gGlobal->gFunMDSet);
+            // Definitions with metadata have to be wrapped into a boxMetadata construction
+            fFileCache[fname] = addFunctionMetadata(ldef, gGlobal->gFunMDSet);
+        }
 	}
     return fFileCache[fname];
 }
 
+/**
+ * Check if a file can be loaded from the precompiled library cache : only
+ * local library files are cached, and not when documentation is generated.
+ *
+ * @param fname the name of the file to check
+ * @return true if the library cache can be used
+ */
+
+bool SourceReader::useLibraryCache(const char* fname)
+{
+    return (gGlobal->gLibraryCacheDir != "") && !gGlobal->gPrintDocSwitch && (gGlobal->gMasterDocument != fname) &&
+           !isURL(fname) && !isFILE(fname);
+}
+
+/**
+ * Return the list of definitions of a library file, from the precompiled
+ * library cache if its source is unchanged, otherwise parse the file and
+ * add it to the cache.
+ *
+ * @param fname the name of the library file
+ * @return the list of definitions it contains
+ */
+
+Tree SourceReader::getCachedList(const char* fname)
+{
+    string fullpath;
+    FILE*  file = fopenSearch(fname, fullpath);
+    if (file == NULL) {
+        // Will report the error
+        return parseFile(fname);
+    }
+    string content;
+    char   buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        content.append(buffer, size);
+    }
+    fclose(file);
+
+    LibraryCache cache(gGlobal->gLibraryCacheDir);
+    uint64_t     key = LibraryCache::getKey(fname, fullpath, content);
+    LibMetadata  metadata;
+    Tree         ldef;
+
+    if (cache.load(key, ldef, metadata)) {
+        for (size_t i = 0; i < metadata.size(); i++) {
+            gGlobal->gMetaDataSet[metadata[i].first].insert(metadata[i].second);
+        }
+        fFilePathnames.push_back(fullpath);
+        return ldef;
+    }
+
+    // Parse the file in an empty metadata set, to keep all the metadata it declares,
+    // even those already declared by previously parsed files
+    MetaDataSet previous;
+    previous.swap(gGlobal->gMetaDataSet);
+    try {
+        ldef = addFunctionMetadata(parseFile(fname), gGlobal->gFunMDSet);
+    } catch (...) {
+        previous.swap(gGlobal->gMetaDataSet);
+        throw;
+    }
+    for (MetaDataSet::iterator it = gGlobal->gMetaDataSet.begin(); it != gGlobal->gMetaDataSet.end(); it++) {
+        for (set<Tree>::iterator v = it->second.begin(); v != it->second.end(); v++) {
+            metadata.push_back(make_pair(it->first, *v));
+            previous[it->first].insert(*v);
+        }
+    }
+    previous.swap(gGlobal->gMetaDataSet);
+    cache.save(key, fname, ldef, metadata);
+    return ldef;
+}
+
 /**
  * Return a vector of pathnames representing the list
  * of all the source files that have been required
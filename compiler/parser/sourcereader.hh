@@ -49,6 +49,8 @@ class SourceReader
         Tree parseFile(const char* fname);
         Tree parseString(const char* fname);
         void checkName();
+        bool useLibraryCache(const char* fname);
+        Tree getCachedList(const char* fname);
         
     public:
     
@@ -31,6 +31,7 @@
 
 using namespace std;
 #include <list>
+#include <map>
 #include <set>
 #include <utility>
 #include <vector>
@@ -159,12 +160,16 @@ struct Trans : public virtual Garbageable {
 /* states */
 
 struct State : public virtual Garbageable {
-    int         s;          // state number
-    bool        match_num;  // whether state has a transition on a numeric constant
-    list<Rule>  rules;      // rule markers
-    list<Trans> trans;      // transitions (1st transition is on variable if available)
+    int           s;          // state number
+    bool          match_num;  // whether state has a transition on a numeric constant
+    list<Rule>    rules;      // rule markers
+    list<Trans>   trans;      // transitions (1st transition is on variable if available)
+    map<Tree, int> cst_trans;  // successor state of each constant transition (filled by Automaton::build)
     State() : s(0), match_num(false), rules(list<Rule>()), trans(list<Trans>()) {}
-    State(const State& state) : s(state.s), match_num(state.match_num), rules(state.rules), trans(state.trans) {}
+    State(const State& state)
+        : s(state.s), match_num(state.match_num), rules(state.rules), trans(state.trans), cst_trans(state.cst_trans)
+    {
+    }
 
     State& operator=(const State& state)
     {
@@ -172,6 +177,7 @@ struct State : public virtual Garbageable {
         match_num = state.match_num;
         rules     = state.rules;
         trans     = state.trans;
+        cst_trans = state.cst_trans;
         return *this;
     }
 
@@ -208,11 +214,35 @@ Trans& Trans::operator=(const Trans& trans)
     return *this;
 }
 
+/* Helper type to represent variable substitutions which are recorded during
+   matching. Each variable is associated with the path pointing at the subterm
+   of the argument where the substitution of the matched variable is to be
+   found. */
+
+struct Assoc : public virtual Garbageable {
+    Tree id;
+    Path p;
+    Assoc(Tree _id, const Path& _p) : id(_id), p(_p) {}
+};
+typedef list<Assoc> Subst;
+
+/* result of the matching of an argument from a given state : the resulting
+   state and the variable substitutions of each rule */
+
+struct Match {
+    int           s;
+    vector<Subst> subst;
+};
+
 /* the automaton */
 
 struct Automaton : public virtual Garbageable {
-    vector<State*> state;
-    vector<Tree>   rhs;
+    vector<State*>             state;
+    vector<Tree>               rhs;
+    map<pair<int, Tree>, Match> matches;  // memoized matches, indexed by start state and argument
+
+    // the memoized matches are dropped when this size is reached, to bound the memory used by an automaton
+    static const size_t kMaxMatches = 4096;
 
     Automaton() : state(vector<State*>()), rhs(vector<Tree>()), s(0) {}
 
@@ -245,6 +275,7 @@ void Automaton::build(State* st)
         int    i;
         if (t->is_cst_trans(x) && (isBoxInt(x, &i) || isBoxReal(x, &f))) st->match_num = true;
         build(t->state);
+        if (t->is_cst_trans(x)) st->cst_trans[x] = t->state->s;
     }
 }
 
@@ -516,7 +547,14 @@ Automaton* make_pattern_matcher(Tree R)
    NOTE: The lists of rules and patterns are actually delivered in reverse
    order by the parser, so we have to reverse them on the fly. */
 {
+    /* Automata only depend on the (evaluated) rules, so they are shared by all the
+       case expressions having the same rules, whatever their environment. */
+    map<Tree, Automaton*>::iterator it = gGlobal->gAutomata.find(R);
+    if (it != gGlobal->gAutomata.end()) {
+        return it->second;
+    }
     Automaton*            A = new Automaton;
+    gGlobal->gAutomata[R]   = A;
     int                   n = len(R), r = n;
     State*                start = new State;
     Tree                  rule, rest;
@@ -591,23 +629,11 @@ Automaton* make_pattern_matcher(Tree R)
     return A;
 }
 
-/* Helper type to represent variable substitutions which are recorded during
-   matching. Each variable is associated with the path pointing at the subterm
-   of the argument where the substitution of the matched variable is to be
-   found. */
-
-struct Assoc : public virtual Garbageable {
-    Tree id;
-    Path p;
-    Assoc(Tree _id, const Path& _p) : id(_id), p(_p) {}
-};
-typedef list<Assoc> Subst;
-
 /* add all substitutions for a given state */
 
 static void add_subst(vector<Subst>& subst, Automaton* A, int s)
 {
-    list<Rule>                 rules = A->rules(s);
+    const list<Rule>&          rules = A->rules(s);
     list<Rule>::const_iterator r;
     for (r = rules.begin(); r != rules.end(); r++)
         if (r->id != NULL) subst[r->r].push_back(Assoc(r->id, r->p));
@@ -625,24 +651,12 @@ static int apply_pattern_matcher_internal(Automaton* A, int s, Tree X, vector<Su
         if (A->state[s]->match_num) /* simplify possible numeric argument on the fly */
             X = simplifyPattern(X);
         /* first check for applicable non-variable transitions */
-        for (t = A->trans(s).begin(); t != A->trans(s).end(); t++) {
-            Tree x;
-            Node op(0), op1(0);
-            if (t->is_var_trans())
-                continue;
-            else if (t->is_cst_trans(x)) {
-                if (X == x) {
-                /* transition on constant */
-#ifdef DEBUG
-                    cerr << "state " << s << ", " << *x << ": goto state " << t->state->s << endl;
-#endif
-                    add_subst(subst, A, s);
-                    s = t->state->s;
-                    return s;
-                }
-            } else if (t->is_op_trans(op)) {
-                Tree x0, x1;
-                if (isBoxPatternOp(X, op1, x0, x1) && op == op1) {
+        Node op1(0);
+        Tree x0, x1;
+        if (isBoxPatternOp(X, op1, x0, x1)) {
+            for (t = A->trans(s).begin(); t != A->trans(s).end(); t++) {
+                Node op(0);
+                if (t->is_op_trans(op) && op == op1) {
                 /* transition on operation symbol */
 #ifdef DEBUG
                     cerr << "state " << s << ", " << op << ": goto state " << t->state->s << endl;
@@ -654,6 +668,16 @@ static int apply_pattern_matcher_internal(Automaton* A, int s, Tree X, vector<Su
                     return s;
                 }
             }
+        } else {
+            /* transition on constant (constants are never operation patterns) */
+            map<Tree, int>::const_iterator c = A->state[s]->cst_trans.find(X);
+            if (c != A->state[s]->cst_trans.end()) {
+#ifdef DEBUG
+                cerr << "state " << s << ", " << *X << ": goto state " << c->second << endl;
+#endif
+                add_subst(subst, A, s);
+                return c->second;
+            }
         }
         /* check for variable transition (is always first in the list of
            transitions) */
@@ -686,14 +710,22 @@ int apply_pattern_matcher(Automaton*    A,  // automaton
                           Tree&         C,  // output closure (if any)
                           vector<Tree>& E)  // modified output environments
 {
-    int           n = A->n_rules();
-    vector<Subst> subst(n, Subst());
-    /* perform matching, record variable substitutions */
+    /* perform matching, record variable substitutions (the result only depends on the
+       start state and the argument, so it is memoized in the automaton) */
 #ifdef DEBUG
     cerr << "automaton " << A << ", state " << s << ", start match on arg: " << *X << endl;
 #endif
-    s = apply_pattern_matcher_internal(A, s, X, subst);
-    C = gGlobal->nil;
+    map<pair<int, Tree>, Match>::iterator it = A->matches.find(make_pair(s, X));
+    if (it == A->matches.end()) {
+        if (A->matches.size() >= Automaton::kMaxMatches) A->matches.clear();
+        Match m;
+        m.subst = vector<Subst>(A->n_rules(), Subst());
+        m.s     = apply_pattern_matcher_internal(A, s, X, m.subst);
+        it      = A->matches.insert(make_pair(make_pair(s, X), m)).first;
+    }
+    const vector<Subst>& subst = it->second.subst;
+    s                          = it->second.s;
+    C                          = gGlobal->nil;
     if (s < 0) /* failed match */
         return s;
     /* process variable substitutions */
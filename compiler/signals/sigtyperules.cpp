@@ -24,6 +24,11 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#ifndef EMCC
+#include <thread>
+#endif
 
 #include "exception.hh"
 #include "global.hh"
@@ -33,6 +38,7 @@
 #include "sigprint.hh"
 #include "sigtype.hh"
 #include "sigtyperules.hh"
+#include "timing.hh"
 #include "tlib.hh"
 #include "xtended.hh"
 
@@ -69,8 +75,118 @@ static interval arithmetic(int opcode, const interval& x, const interval& y);
  * The empty type environment (also property key for closed term type)
  */
 
+/**
+ * Collect the indexes of the recursive symbols used by a recursive definition. The definitions
+ * of other recursive symbols are not entered, since they are properties and not branches
+ * of the symbols. Only the immutable structure of the trees is read, so that several
+ * definitions can be analyzed in parallel.
+ */
+static void recDependencies(Tree def, const unordered_map<Tree, int>& index, vector<int>& deps)
+{
+    unordered_set<Tree> visited;
+    vector<Tree>        stack(1, def);
+
+    while (!stack.empty()) {
+        Tree t = stack.back();
+        stack.pop_back();
+        if (!visited.insert(t).second) continue;
+        auto it = index.find(t);
+        if (it != index.end()) {
+            deps.push_back(it->second);
+        } else {
+            for (int i = 0; i < t->arity(); i++) stack.push_back(t->branch(i));
+        }
+    }
+}
+
+static void recDependencies(const vector<Tree>& vdef, const unordered_map<Tree, int>& index,
+                            vector<vector<int>>& deps)
+{
+    int n = int(vdef.size());
+    deps.resize(n);
+
+#ifndef EMCC
+    // Only worth for large programs
+    int threads = min(int(thread::hardware_concurrency()), n / 512);
+    if (threads > 1) {
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.push_back(thread([&, t]() {
+                for (int i = t; i < n; i += threads) recDependencies(vdef[i], index, deps[i]);
+            }));
+        }
+        for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+        return;
+    }
+#endif
+    for (int i = 0; i < n; i++) recDependencies(vdef[i], index, deps[i]);
+}
+
+/**
+ * Split the recursive symbols in groups of mutually dependent symbols (the strongly
+ * connected components of the dependency graph, computed with Tarjan's algorithm),
+ * a group being returned after the groups it depends on.
+ */
+static vector<vector<int>> recGroups(const vector<vector<int>>& deps)
+{
+    int                 n = int(deps.size());
+    int                 counter = 0;
+    vector<int>         index(n, -1), low(n, 0), stack;
+    vector<bool>        onstack(n, false);
+    vector<vector<int>> groups;
+
+    for (int s = 0; s < n; s++) {
+        if (index[s] >= 0) continue;
+
+        // Iterative depth first search (recursion depth could be too large)
+        vector<pair<int, size_t>> calls(1, make_pair(s, size_t(0)));
+        index[s] = low[s] = counter++;
+        stack.push_back(s);
+        onstack[s] = true;
+
+        while (!calls.empty()) {
+            int    v = calls.back().first;
+            size_t e = calls.back().second;
+            if (e < deps[v].size()) {
+                calls.back().second++;
+                int w = deps[v][e];
+                if (index[w] < 0) {
+                    index[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    onstack[w] = true;
+                    calls.push_back(make_pair(w, size_t(0)));
+                } else if (onstack[w]) {
+                    low[v] = min(low[v], index[w]);
+                }
+            } else {
+                calls.pop_back();
+                if (!calls.empty()) {
+                    int u  = calls.back().first;
+                    low[u] = min(low[u], low[v]);
+                }
+                if (low[v] == index[v]) {
+                    vector<int> group;
+                    int         w;
+                    do {
+                        w = stack.back();
+                        stack.pop_back();
+                        onstack[w] = false;
+                        group.push_back(w);
+                    } while (w != v);
+                    groups.push_back(group);
+                }
+            }
+        }
+    }
+
+    return groups;
+}
+
 /**
  * Fully annotate every subtree of term with type information.
+ * The least fixpoint of the recursive types is computed separately for each group
+ * of mutually dependent recursive symbols, the groups they depend on being already typed,
+ * so that only the definitions of a group are typed again at each iteration.
  * @param sig the signal term tree to annotate
  * @param causality when true check causality issues
  */
@@ -78,11 +194,14 @@ static interval arithmetic(int opcode, const interval& x, const interval& y);
 void typeAnnotation(Tree sig, bool causality)
 {
     gGlobal->gCausality = causality;
-    Tree sl             = symlist(sig);
-    int  n              = len(sl);
+    startTiming("symlist");
+    Tree sl = symlist(sig);
+    int  n  = len(sl);
+    endTiming("symlist");
 
-    vector<Tree> vrec, vdef;
-    vector<Type> vtype;
+    vector<Tree>             vrec, vdef;
+    vector<Type>             vtype;
+    unordered_map<Tree, int> index;
 
     // cerr << "Symlist " << *sl << endl;
     for (Tree l = sl; isList(l); l = tl(l)) {
@@ -92,43 +211,64 @@ void typeAnnotation(Tree sig, bool causality)
             continue;
         }
 
+        index[hd(l)] = int(vrec.size());
         vrec.push_back(hd(l));
         vdef.push_back(body);
     }
 
-    // init recursive types
+    // init recursive types (types of a previous annotation are removed, so that
+    // a recursive symbol cannot be used before its group is typed)
     for (int i = 0; i < n; i++) {
         vtype.push_back(initialRecType(vdef[i]));
+        vrec[i]->setType(0);
     }
 
     faustassert(int(vrec.size()) == n);
     faustassert(int(vdef.size()) == n);
     faustassert(int(vtype.size()) == n);
 
-    // find least fixpoint
-    for (bool finished = false; !finished;) {
-        // init recursive types
-        CTree::startNewVisit();
-        for (int i = 0; i < n; i++) {
-            setSigType(vrec[i], vtype[i]);
-            vrec[i]->setVisited();
-        }
+    startTiming("recursive groups");
+    vector<vector<int>> deps;
+    recDependencies(vdef, index, deps);
+    vector<vector<int>> groups = recGroups(deps);
+    endTiming("recursive groups");
 
-        // compute recursive types
-        for (int i = 0; i < n; i++) {
-            vtype[i] = T(vdef[i], gGlobal->NULLTYPEENV);
-        }
+    startTiming("recursive types");
+
+    for (size_t g = 0; g < groups.size(); g++) {
+        const vector<int>& group = groups[g];
+
+        // find least fixpoint
+        for (bool finished = false; !finished;) {
+            // init recursive types
+            CTree::startNewVisit();
+            for (size_t i = 0; i < group.size(); i++) {
+                setSigType(vrec[group[i]], vtype[group[i]]);
+                vrec[group[i]]->setVisited();
+            }
 
-        // check finished
-        finished = true;
-        for (int i = 0; i < n; i++) {
-            // cerr << i << "-" << *vrec[i] << ":" << *getSigType(vrec[i]) << " => " << *vtype[i] << endl;
-            finished = finished && (getSigType(vrec[i]) == vtype[i]);
+            // compute recursive types
+            for (size_t i = 0; i < group.size(); i++) {
+                vtype[group[i]] = T(vdef[group[i]], gGlobal->NULLTYPEENV);
+            }
+
+            // check finished
+            finished = true;
+            for (size_t i = 0; i < group.size(); i++) {
+                // cerr << group[i] << "-" << *vrec[group[i]] << ":" << *getSigType(vrec[group[i]]) << " => " <<
+                // *vtype[group[i]] << endl;
+                finished = finished && (getSigType(vrec[group[i]]) == vtype[group[i]]);
+            }
         }
     }
 
+    endTiming("recursive types");
+
     // type full term
+    startTiming("full term type");
+    CTree::startNewVisit();
     T(sig, gGlobal->NULLTYPEENV);
+    endTiming("full term type");
 }
 
 void annotationStatistics()
@@ -608,13 +748,14 @@ static Type initialRecType(Tree t)
 }
 
 /**
- * Infere the type of e recursive block by trying solutions of
- * increasing generality
+ * Recursive blocks are typed by typeAnnotation, group by group : a recursive block
+ * reached here belongs to an already typed group, and keeps its type
  */
 static Type infereRecType(Tree sig, Tree body, Tree env)
 {
-    faustassert(false);  // we should not come here
-    return 0;
+    Type ty = getSigType(sig);
+    faustassert(ty);
+    return ty;
 }
 
 /**
@@ -91,11 +91,16 @@ storage of trees.
 Tree         CTree::gHashTable[kHashTableSize];
 bool         CTree::gDetails   = false;
 unsigned int CTree::gVisitTime = 0;
+size_t       CTree::gTreeCount       = 0;
+size_t       CTree::gPropertyLookups = 0;
+bool         CTree::gCountLookups    = false;
 
 // Constructor : add the tree to the hash table
 CTree::CTree(size_t hk, const Node& n, const tvec& br)
     : fNode(n), fType(0), fHashKey(hk), fAperture(calcTreeAperture(n, br)), fVisitTime(0), fBranch(br)
 {
+    gTreeCount++;
+
     // link dans la hash table
     int j         = hk % kHashTableSize;
     fNext         = gHashTable[j];
@@ -128,6 +133,8 @@ bool CTree::equiv(const Node& n, const tvec& br) const
     return (fNode == n) && (fBranch == br);
 }
 
+// The branches hash keys are mixed with a multiplicative hash: a simple shift/xor
+// combination gives many collisions for trees of the same shape (lists, environments...)
 size_t CTree::calcTreeHash(const Node& n, const tvec& br)
 {
     size_t               hk = size_t(n.getPointer());
@@ -135,7 +142,8 @@ size_t CTree::calcTreeHash(const Node& n, const tvec& br)
     tvec::const_iterator z  = br.end();
 
     while (b != z) {
-        hk = (hk << 1) ^ (hk >> 20) ^ ((*b)->fHashKey);
+        hk = size_t((hk ^ (*b)->fHashKey) * 0x9E3779B97F4A7C15ULL);
+        hk ^= hk >> 29;
         ++b;
     }
     return hk;
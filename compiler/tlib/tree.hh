@@ -113,6 +113,9 @@ class CTree : public virtual Garbageable {
    public:
     static bool         gDetails;    ///< Ctree::print() print with more details when true
     static unsigned int gVisitTime;  ///< Should be incremented for each new visit to keep track of visited tree.
+    static size_t       gTreeCount;        ///< number of trees created (compilation statistics)
+    static size_t       gPropertyLookups;  ///< number of property lookups (compilation statistics)
+    static bool         gCountLookups;     ///< property lookups are only counted when timing is active
 
    private:
     // fields
@@ -171,6 +174,7 @@ class CTree : public virtual Garbageable {
 
     Tree getProperty(Tree key)
     {
+        if (gCountLookups) gPropertyLookups++;
         plist::iterator i = fProperties.find(key);
         if (i == fProperties.end()) {
             return 0;
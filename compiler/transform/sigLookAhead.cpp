@@ -0,0 +1,374 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#include "sigLookAhead.hh"
+#include <set>
+#include <vector>
+#include "global.hh"
+#include "ppsig.hh"
+#include "signals.hh"
+#include "sigtyperules.hh"
+#include "tlib.hh"
+#include "tree.hh"
+
+/********************************************************************
+SignalLookAhead::transformation(Tree sig) :
+
+Rewrite single recursions in look-ahead form when their body is linear
+in the recursive signal, with constant or control-rate coefficients.
+
+Note that control-rate coefficients are supposed to be constant on
+the look-ahead window : the K samples following a control change are
+computed with the new coefficients applied to the whole window.
+**********************************************************************/
+
+// Coefficients operations, folding numbers when possible
+
+static Tree realCoef(Tree c)
+{
+    int i;
+    return (isSigInt(c, &i)) ? sigReal(double(i)) : c;
+}
+
+static Tree addCoef(Tree a, Tree b)
+{
+    if (isZero(a)) {
+        return b;
+    } else if (isZero(b)) {
+        return a;
+    } else if (isNum(a) && isNum(b)) {
+        return realCoef(addNums(a, b));
+    } else {
+        return sigAdd(a, b);
+    }
+}
+
+static Tree minusCoef(Tree a)
+{
+    return (isNum(a)) ? realCoef(minusNum(a)) : sigSub(sigReal(0.0), a);
+}
+
+static Tree subCoef(Tree a, Tree b)
+{
+    if (isZero(b)) {
+        return a;
+    } else if (isZero(a)) {
+        return minusCoef(b);
+    } else if (isNum(a) && isNum(b)) {
+        return realCoef(subNums(a, b));
+    } else {
+        return sigSub(a, b);
+    }
+}
+
+static Tree mulCoef(Tree a, Tree b)
+{
+    if (isZero(a) || isZero(b)) {
+        return sigReal(0.0);
+    } else if (isOne(a)) {
+        return b;
+    } else if (isOne(b)) {
+        return a;
+    } else if (isNum(a) && isNum(b)) {
+        return realCoef(mulNums(a, b));
+    } else {
+        return sigMul(a, b);
+    }
+}
+
+static Tree divCoef(Tree a, Tree b)
+{
+    if (isZero(a)) {
+        return a;
+    } else if (isOne(b)) {
+        return a;
+    } else {
+        return sigDiv(a, b);
+    }
+}
+
+// Recognize x' and x@d with a constant d
+static bool isConstantDelay(Tree sig, Tree& x, int& d)
+{
+    Tree y, z;
+    if (isSigDelay1(sig, x)) {
+        d = 1;
+        return true;
+    } else if (isSigFixDelay(sig, x, y)) {
+        return isSigInt(y, &d) || (isSigIntCast(y, z) && isSigInt(z, &d));
+    } else {
+        return false;
+    }
+}
+
+// Build x@d, removing useless x@0 that can't be delayed again
+static Tree delaySig(Tree sig, int d)
+{
+    Tree x;
+    int  d0;
+    while (isConstantDelay(sig, x, d0) && d0 == 0) sig = x;
+    return sigFixDelay(sig, sigInt(d));
+}
+
+/**
+ * Add the reverse edges of the signals reachable from 'sig' that were not visited yet.
+ * The graph is shared by all the recursive groups, so each signal is only visited once
+ * during the whole transformation. Iterative traversal, to handle deep signals.
+ */
+void SignalLookAhead::collectParents(Tree sig)
+{
+    vector<Tree> todo;
+    if (fVisited.insert(sig).second) todo.push_back(sig);
+
+    while (!todo.empty()) {
+        Tree s = todo.back();
+        todo.pop_back();
+
+        vector<Tree> subsigs;
+        Tree         var, le;
+        if (isRec(s, var, le)) {
+            for (; isList(le); le = tl(le)) subsigs.push_back(hd(le));
+        } else {
+            getSubSignals(s, subsigs);
+        }
+
+        for (size_t i = 0; i < subsigs.size(); i++) {
+            fParents[subsigs[i]].push_back(s);
+            if (fVisited.insert(subsigs[i]).second) todo.push_back(subsigs[i]);
+        }
+    }
+}
+
+/**
+ * Mark all the signals that depend on the recursive group 'rec', going up the
+ * reverse edges from 'rec' (the cycles of the nested recursive groups included).
+ */
+void SignalLookAhead::markDependencies(Tree body, Tree rec)
+{
+    vector<Tree> todo(1, rec);
+    collectParents(body);
+
+    fDepends.clear();
+    fDepends.insert(rec);
+    while (!todo.empty()) {
+        Tree sig = todo.back();
+        todo.pop_back();
+        map<Tree, vector<Tree> >::iterator it = fParents.find(sig);
+        if (it == fParents.end()) continue;
+        for (auto p : it->second) {
+            if (fDepends.insert(p).second) todo.push_back(p);
+        }
+    }
+}
+
+bool SignalLookAhead::dependsOn(Tree sig)
+{
+    return fDepends.count(sig) > 0;
+}
+
+// A coefficient is a real number or a real control-rate signal
+bool SignalLookAhead::isControlCoef(Tree sig)
+{
+    if (isNum(sig)) return true;
+    AudioType* ty = (AudioType*)sig->getType();
+    return ty && (ty->nature() == kReal) && (ty->variability() <= kBlock);
+}
+
+/**
+ * Decompose 'sig' as a linear combination of delayed 'proj' signals plus a non recursive rest
+ * @return false if 'sig' is not linear in 'proj'
+ */
+bool SignalLookAhead::decompose(Tree sig, Tree proj, LinearForm& form)
+{
+    // shared subexpressions are only decomposed once
+    map<Tree, pair<bool, LinearForm> >::iterator it = fForms.find(sig);
+    if (it != fForms.end()) {
+        form = it->second.second;
+        return it->second.first;
+    }
+    bool res    = decomposeAux(sig, proj, form);
+    fForms[sig] = make_pair(res, form);
+    return res;
+}
+
+bool SignalLookAhead::decomposeAux(Tree sig, Tree proj, LinearForm& form)
+{
+    Tree x, y;
+    int  op, d;
+
+    if (!dependsOn(sig)) {
+        form.fRest = sig;
+        return true;
+
+    } else if (sig == proj) {
+        form.fCoefs[0] = sigReal(1.0);
+        return true;
+
+    } else if (isConstantDelay(sig, x, d)) {
+        if (d == 0) return decompose(x, proj, form);
+        LinearForm f;
+        if (!decompose(x, proj, f)) return false;
+        for (auto& c : f.fCoefs) {
+            // delaying a control-rate coefficient would change its value at block boundaries
+            if (!isNum(c.second)) return false;
+            form.fCoefs[c.first + d] = c.second;
+        }
+        if (f.fRest) form.fRest = delaySig(f.fRest, d);
+        return true;
+
+    } else if (isSigBinOp(sig, &op, x, y)) {
+        if (op == kAdd || op == kSub) {
+            LinearForm f1, f2;
+            if (!decompose(x, proj, f1) || !decompose(y, proj, f2)) return false;
+            form = f1;
+            for (auto& c : f2.fCoefs) {
+                if (form.fCoefs.find(c.first) == form.fCoefs.end()) {
+                    form.fCoefs[c.first] = (op == kAdd) ? c.second : minusCoef(c.second);
+                } else {
+                    Tree c1              = form.fCoefs[c.first];
+                    form.fCoefs[c.first] = (op == kAdd) ? addCoef(c1, c.second) : subCoef(c1, c.second);
+                }
+            }
+            if (f2.fRest) {
+                if (form.fRest) {
+                    form.fRest = (op == kAdd) ? sigAdd(form.fRest, f2.fRest) : sigSub(form.fRest, f2.fRest);
+                } else {
+                    form.fRest = (op == kAdd) ? f2.fRest : sigSub(sigReal(0.0), f2.fRest);
+                }
+            }
+            return true;
+
+        } else if (op == kMul || op == kDiv) {
+            // one side must be a control-rate coefficient, only a divisor for kDiv
+            Tree k = y;
+            if (op == kMul && !dependsOn(x)) {
+                k = x;
+                x = y;
+            }
+            if (dependsOn(k) || !isControlCoef(k)) return false;
+            k = realCoef(k);
+            LinearForm f;
+            if (!decompose(x, proj, f)) return false;
+            for (auto& c : f.fCoefs) {
+                form.fCoefs[c.first] = (op == kMul) ? mulCoef(c.second, k) : divCoef(c.second, k);
+            }
+            if (f.fRest) form.fRest = (op == kMul) ? sigMul(f.fRest, k) : sigDiv(f.fRest, k);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Rewrite the body of a single recursion in scattered look-ahead form :
+ * the denominator D(z) = 1 - sum(c(j).z^-j) is multiplied by Q(z) so that
+ * D(z).Q(z) = D'(z^K) only has terms in z^-K. The roots of D' are the roots
+ * of D at the power K, so the added poles have the same magnitude as the
+ * original ones and stability is preserved.
+ * @return the new body or 0 if the recursion can't or doesn't need to be rewritten
+ */
+Tree SignalLookAhead::lookAhead(Tree body, Tree proj, Tree rec)
+{
+    AudioType* ty = (AudioType*)body->getType();
+    if (!ty || ty->nature() != kReal) return 0;
+
+    LinearForm form;
+    markDependencies(body, rec);
+    fForms.clear();
+    if (!decompose(body, proj, form) || !form.fRest) return 0;
+
+    // remove null coefficients
+    for (auto it = form.fCoefs.begin(); it != form.fCoefs.end();) {
+        if (isZero(it->second)) {
+            it = form.fCoefs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (form.fCoefs.empty()) return 0;
+
+    int K    = fLookAhead;
+    int mind = form.fCoefs.begin()->first;
+    int N    = form.fCoefs.rbegin()->first;
+    if (mind < 1 || mind >= K) return 0;
+
+    vector<Tree> c(N + 1, sigReal(0.0));
+    for (auto& it : form.fCoefs) c[it.first] = it.second;
+
+    // power sums of the roots of D (Newton's identities) : s(k) = sum(c(j).s(k-j)) + k.c(k)
+    vector<Tree> s(N * K + 1, sigReal(0.0));
+    for (int k = 1; k <= N * K; k++) {
+        for (int j = 1; j <= min(k - 1, N); j++) s[k] = addCoef(s[k], mulCoef(c[j], s[k - j]));
+        if (k <= N) s[k] = addCoef(s[k], mulCoef(sigReal(double(k)), c[k]));
+    }
+
+    // coefficients of D' from the power sums s(m.K) of its roots (inverse Newton's identities)
+    vector<Tree> C(N + 1, sigReal(0.0));
+    for (int m = 1; m <= N; m++) {
+        Tree p = s[m * K];
+        for (int j = 1; j < m; j++) p = subCoef(p, mulCoef(C[j], s[(m - j) * K]));
+        C[m] = mulCoef(p, sigReal(1.0 / double(m)));
+    }
+
+    // Q = D'(z^K) / D(z) : q(k) = d'(k) + sum(c(j).q(k-j))
+    int          L = N * (K - 1);
+    vector<Tree> q(L + 1, sigReal(0.0));
+    q[0] = sigReal(1.0);
+    for (int k = 1; k <= L; k++) {
+        if (k % K == 0) q[k] = minusCoef(C[k / K]);
+        for (int j = 1; j <= min(k, N); j++) q[k] = addCoef(q[k], mulCoef(c[j], q[k - j]));
+    }
+
+    // non recursive part : sum(q(k).x@k)
+    Tree res = form.fRest;
+    for (int k = 1; k <= L; k++) {
+        if (!isZero(q[k])) res = sigAdd(res, mulCoef(q[k], delaySig(form.fRest, k)));
+    }
+
+    // recursive part : sum(C(m).y@(m.K))
+    for (int m = 1; m <= N; m++) {
+        if (!isZero(C[m])) res = sigAdd(res, mulCoef(C[m], sigFixDelay(proj, sigInt(m * K))));
+    }
+
+    return res;
+}
+
+Tree SignalLookAhead::transformation(Tree sig)
+{
+    Tree var, le;
+
+    if (isRec(sig, var, le) && !isNil(le)) {
+        // first visit
+        rec(var, gGlobal->nil);  // to avoid infinite recursions
+        Tree nle = mapself(le);
+        if (len(nle) == 1) {
+            Tree body = lookAhead(hd(nle), sigProj(0, sig), sig);
+            if (body) {
+                nle = cons(body, gGlobal->nil);
+                fRewritten++;
+            }
+        }
+        return rec(var, nle);
+    } else {
+        return SignalIdentity::transformation(sig);
+    }
+}
@@ -0,0 +1,77 @@
+/************************************************************************
+ ************************************************************************
+    FAUST compiler
+    Copyright (C) 2003-2018 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ ************************************************************************
+ ************************************************************************/
+
+#ifndef __SIGLOOKAHEAD__
+#define __SIGLOOKAHEAD__
+
+#include <map>
+#include <set>
+#include <vector>
+#include "sigIdentity.hh"
+
+//-------------------------SignalLookAhead-------------------------------
+// Rewrite linear recursions with control-rate coefficients :
+//
+//      y(n) = x(n) + c1.y(n-1) + ... + cN.y(n-N)
+//
+// in scattered look-ahead form, so that y(n) only depends on y(n-K) ... y(n-N.K) :
+//
+//      y(n) = q0.x(n) + ... + qN(K-1).x(n-N(K-1)) + C1.y(n-K) + ... + CN.y(n-N.K)
+//
+// The qk and Cm coefficients are computed at control rate, the x part
+// becomes a vectorizable loop and the remaining recursive loop has a
+// dependency distance of K samples. The signals must have been typed before.
+//------------------------------------------------------------------------
+
+class SignalLookAhead : public SignalIdentity {
+    // linear decomposition of a signal : sum of coef(d).y@d plus a non recursive rest (or 0 if none)
+    struct LinearForm {
+        std::map<int, Tree> fCoefs;
+        Tree                fRest;
+        LinearForm() : fRest(0) {}
+    };
+
+    int                                          fLookAhead;
+    int                                          fRewritten;
+    std::set<Tree>                               fVisited;  // signals whose reverse edges are collected
+    std::map<Tree, std::vector<Tree> >           fParents;  // reverse edges of the signals graph
+    std::set<Tree>                               fDepends;  // signals depending on the rewritten recursion
+    std::map<Tree, std::pair<bool, LinearForm> > fForms;    // memoized decompositions
+
+    void collectParents(Tree sig);
+    void markDependencies(Tree body, Tree rec);
+    bool dependsOn(Tree sig);
+    bool isControlCoef(Tree sig);
+    bool decompose(Tree sig, Tree proj, LinearForm& form);
+    bool decomposeAux(Tree sig, Tree proj, LinearForm& form);
+    Tree lookAhead(Tree body, Tree proj, Tree rec);
+
+   public:
+    SignalLookAhead(int lookahead) : fLookAhead(lookahead), fRewritten(0) {}
+
+    // number of rewritten recursions
+    int rewritten() { return fRewritten; }
+
+   protected:
+    virtual Tree transformation(Tree t);
+};
+
+#endif
@@ -0,0 +1,167 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <iostream>
+#include <thread>
+
+#include "faust/gui/ControlBus.h"
+
+std::list<GUI*> GUI::fGuiList;
+ztimedmap GUI::gTimedZoneMap;
+
+using namespace std;
+
+// Test DSP : one parameter per producer, the output of each channel is its parameter value
+class params_dsp : public dsp {
+
+    public:
+
+        FAUSTFLOAT fParams[2];
+        int fSampleRate;
+
+        params_dsp():fSampleRate(0) { fParams[0] = fParams[1] = 0; }
+
+        int getNumInputs() { return 0; }
+        int getNumOutputs() { return 2; }
+        void buildUserInterface(UI* ui_interface)
+        {
+            ui_interface->openVerticalBox("test");
+            ui_interface->addNumEntry("param0", &fParams[0], 0, 0, 1e9, 1);
+            ui_interface->addNumEntry("param1", &fParams[1], 0, 0, 1e9, 1);
+            ui_interface->closeBox();
+        }
+        int getSampleRate() { return fSampleRate; }
+        void init(int sample_rate) { instanceInit(sample_rate); }
+        void instanceInit(int sample_rate) { fSampleRate = sample_rate; }
+        void instanceConstants(int sample_rate) { fSampleRate = sample_rate; }
+        void instanceResetUserInterface() { fParams[0] = fParams[1] = 0; }
+        void instanceClear() {}
+        params_dsp* clone() { return new params_dsp(); }
+        void metadata(Meta* m) {}
+
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int chan = 0; chan < 2; chan++) {
+                for (int i = 0; i < count; i++) outputs[chan][i] = fParams[chan];
+            }
+        }
+};
+
+static int gErrors = 0;
+
+static void check(bool cond, const char* test, const char* msg)
+{
+    if (!cond) {
+        cerr << "ERROR : " << test << " : " << msg << endl;
+        gErrors++;
+    }
+}
+
+static const int kBlock = 64;
+
+// Two producer threads send increasing values (retrying when their queue is full) while an
+// audio thread computes blocks : the values have to arrive in order, and the last one has to arrive
+static void testProducers()
+{
+    const char* test = "two producers";
+    const int values = 200000;
+    params_dsp* params = new params_dsp();
+    params->init(48000);
+    // 'params' is deleted by 'audio', before the bus
+    ControlBus bus(params, 256);
+    controlbus_dsp audio(params, &bus);
+    ControlSender* senders[2] = { bus.createSender(), bus.createSender() };
+
+    std::atomic<int> running(2);
+    std::thread producers[2];
+    for (int p = 0; p < 2; p++) {
+        producers[p] = std::thread([&, p]() {
+            for (int v = 1; v <= values; v++) {
+                while (!senders[p]->send(&params->fParams[p], FAUSTFLOAT(v))) std::this_thread::yield();
+            }
+            running--;
+        });
+    }
+
+    FAUSTFLOAT out0[kBlock], out1[kBlock];
+    FAUSTFLOAT* outputs[] = { out0, out1 };
+    FAUSTFLOAT last[2] = { 0, 0 };
+    bool ordered = true;
+    bool done = false;
+    while (!done) {
+        // The producers are finished before the last block : all the values are in the queues
+        done = (running == 0);
+        audio.compute(kBlock, NULL, outputs);
+        for (int p = 0; p < 2; p++) {
+            ordered = ordered && (outputs[p][0] >= last[p]);
+            last[p] = outputs[p][0];
+        }
+    }
+    for (int p = 0; p < 2; p++) producers[p].join();
+
+    check(ordered, test, "values received out of order");
+    check(last[0] == values && last[1] == values, test, "values lost");
+}
+
+// A control dated in the block is applied at its frame
+static void testDated()
+{
+    const char* test = "dated control";
+    params_dsp* params = new params_dsp();
+    params->init(48000);
+    ControlBus bus(params);
+    controlbus_dsp audio(params, &bus);
+    ControlSender* sender = bus.createSender();
+
+    FAUSTFLOAT out0[kBlock], out1[kBlock];
+    FAUSTFLOAT* outputs[] = { out0, out1 };
+    double block_usec = 1000000. * kBlock / 48000.;
+    double date = 10 * block_usec;
+    // Dated at frame 20 of the block starting at 'date'
+    sender->send(&params->fParams[0], 1, date + 1000000. * 20 / 48000.);
+
+    audio.compute(date - block_usec, kBlock, NULL, outputs);
+    check(out0[kBlock - 1] == 0, test, "control applied before its block");
+    audio.compute(date, kBlock, NULL, outputs);
+    check(out0[19] == 0 && out0[20] == 1 && out0[kBlock - 1] == 1, test, "control not applied at its frame");
+}
+
+// A full queue drops the control and counts it
+static void testDropped()
+{
+    const char* test = "dropped controls";
+    params_dsp* params = new params_dsp();
+    ControlBus bus(params, 4);
+    ControlSender* sender = bus.createSender();
+    int sent = 0;
+    for (int i = 0; i < 16; i++) {
+        if (sender->send(&params->fParams[0], FAUSTFLOAT(i))) sent++;
+    }
+    check(sent > 0 && sent < 16, test, "queue size not respected");
+    check(bus.getDropped() == 16 - sent, test, "wrong dropped count");
+    delete params;
+}
+
+int main(int argc, char* argv[])
+{
+    testProducers();
+    testDated();
+    testDropped();
+    if (gErrors == 0) cout << "ControlBus : OK" << endl;
+    return (gErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/************************************************************************
+ FAUST Architecture File
+ Copyright (C) 2019 GRAME, Centre National de Creation Musicale
+ ---------------------------------------------------------------------
+ This Architecture section is free software; you can redistribute it
+ and/or modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 3 of
+ the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <iostream>
+#include <math.h>
+
+#include "faust/dsp/smooth-dsp.h"
+
+using namespace std;
+
+// Test DSP : outputs its parameter value, and can write a new value in the zone at a given
+// compute call, the way a control thread would do during a block
+class param_dsp : public dsp {
+
+    public:
+
+        FAUSTFLOAT fParam;
+        int fCalls;
+        int fWriteCall;
+        FAUSTFLOAT fWriteValue;
+        int fSampleRate;
+
+        param_dsp():fParam(0), fCalls(0), fWriteCall(-1), fWriteValue(0), fSampleRate(0) {}
+
+        int getNumInputs() { return 0; }
+        int getNumOutputs() { return 1; }
+        void buildUserInterface(UI* ui_interface)
+        {
+            ui_interface->openVerticalBox("test");
+            ui_interface->addHorizontalSlider("param", &fParam, 0, 0, 1, 0.001);
+            ui_interface->closeBox();
+        }
+        int getSampleRate() { return fSampleRate; }
+        void init(int sample_rate) { instanceInit(sample_rate); }
+        void instanceInit(int sample_rate) { fSampleRate = sample_rate; }
+        void instanceConstants(int sample_rate) { fSampleRate = sample_rate; }
+        void instanceResetUserInterface() { fParam = 0; }
+        void instanceClear() {}
+        param_dsp* clone() { return new param_dsp(); }
+        void metadata(Meta* m) {}
+
+        void compute(int count, FAUSTFLOAT** inputs, FAUSTFLOAT** outputs)
+        {
+            for (int i = 0; i < count; i++) outputs[0][i] = fParam;
+            if (fCalls++ == fWriteCall) fParam = fWriteValue;
+        }
+};
+
+static int gErrors = 0;
+
+static void check(bool cond, const char* test, const char* msg)
+{
+    if (!cond) {
+        cerr << "ERROR : " << test << " : " << msg << endl;
+        gErrors++;
+    }
+}
+
+static const int kSampleRate = 48000;
+static const int kSubBlock = 32;
+static const int kBlock = 1024;
+
+// Ramp of 'time_ms' from 0 to 1, returns the output of the first block
+static void ramp(smooth_dsp& smooth, param_dsp* param, FAUSTFLOAT* output)
+{
+    smooth.init(kSampleRate);
+    param->fParam = 1;
+    smooth.compute(kBlock, NULL, &output);
+}
+
+static void testLinear()
+{
+    const char* test = "linear ramp";
+    param_dsp* param = new param_dsp();
+    smooth_dsp smooth(param, kSubBlock);
+    smooth.setSmoothing(&param->fParam, 10.);
+    FAUSTFLOAT output[kBlock];
+    ramp(smooth, param, output);
+
+    // 10 ms at 48 kHz : 480 frames, so 15 sub-blocks of 32 frames
+    for (int s = 0; s < 15; s++) {
+        FAUSTFLOAT expected = FAUSTFLOAT(s + 1) / FAUSTFLOAT(15);
+        check(fabs(output[s * kSubBlock] - expected) < 1e-6, test, "wrong ramp value");
+        check(output[s * kSubBlock] == output[s * kSubBlock + kSubBlock - 1], test, "value not constant in a sub-block");
+    }
+    check(output[14 * kSubBlock - 1] < 1, test, "target reached before 15 sub-blocks");
+    check(output[15 * kSubBlock - 1] == 1, test, "target not reached after 15 sub-blocks");
+    check(output[kBlock - 1] == 1, test, "target not kept");
+    // 15 sub-blocks, then the rest of the block in one call
+    check(param->fCalls == 16, test, "wrong number of sub-blocks");
+}
+
+static void testExponential()
+{
+    const char* test = "exponential ramp";
+    param_dsp* param = new param_dsp();
+    smooth_dsp smooth(param, kSubBlock);
+    smooth.setSmoothing(&param->fParam, 10., smooth_dsp::kExponential);
+    FAUSTFLOAT output[kBlock];
+    ramp(smooth, param, output);
+
+    // Each sub-block moves by the same ratio of the remaining distance : 99.9% is reached in 15 sub-blocks
+    for (int s = 1; s < 14; s++) {
+        check(output[s * kSubBlock] > output[(s - 1) * kSubBlock], test, "ramp not increasing");
+        double ratio = (1. - output[s * kSubBlock]) / (1. - output[(s - 1) * kSubBlock]);
+        check(fabs(ratio - pow(0.001, 1. / 15.)) < 1e-4, test, "ramp not exponential");
+    }
+    check(fabs(1. - output[13 * kSubBlock]) < 0.002, test, "ramp does not converge");
+    check(output[15 * kSubBlock - 1] == 1, test, "target not reached after 15 sub-blocks");
+}
+
+static void testStatic()
+{
+    const char* test = "static parameter";
+    param_dsp* param = new param_dsp();
+    smooth_dsp smooth(param, kSubBlock);
+    smooth.setSmoothing(&param->fParam, 10.);
+    smooth.init(kSampleRate);
+    FAUSTFLOAT output[kBlock];
+    FAUSTFLOAT* outputs[] = { output };
+    smooth.compute(kBlock, NULL, outputs);
+    check(param->fCalls == 1, test, "block cut in sub-blocks");
+}
+
+static void testChangeDuringRamp()
+{
+    const char* test = "change during a ramp";
+    param_dsp* param = new param_dsp();
+    smooth_dsp smooth(param, kSubBlock);
+    smooth.setSmoothing(&param->fParam, 10.);
+    // The value is set to 0 by a 'control thread' during the 5th sub-block
+    param->fWriteCall = 4;
+    param->fWriteValue = 0;
+    FAUSTFLOAT output[kBlock];
+    ramp(smooth, param, output);
+
+    // The ramp goes back to 0 from where it was, without a jump
+    FAUSTFLOAT top = output[4 * kSubBlock];
+    check(fabs(top - FAUSTFLOAT(5) / FAUSTFLOAT(15)) < 1e-6, test, "wrong ramp value");
+    check(output[5 * kSubBlock] > 0 && output[5 * kSubBlock] < top, test, "new value applied without a ramp");
+    for (int s = 6; s < 20; s++) {
+        check(output[s * kSubBlock] <= output[(s - 1) * kSubBlock], test, "ramp not decreasing");
+    }
+    check(output[kBlock - 1] == 0, test, "new target not reached");
+    check(param->fParam == 0, test, "new value not kept in the zone");
+}
+
+int main(int argc, char* argv[])
+{
+    testLinear();
+    testExponential();
+    testStatic();
+    testChangeDuringRamp();
+    if (gErrors == 0) cout << "smooth_dsp : OK" << endl;
+    return (gErrors == 0) ? 0 : 1;
+}
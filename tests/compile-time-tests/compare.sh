@@ -0,0 +1,52 @@
+#!/bin/bash
+#
+# Compare compile-bench.sh results with a baseline.
+#
+# Usage : compare.sh baseline.txt current.txt [tolerance (in %, default 20)] [minimum duration (in ms, default 5)]
+#
+# A measure regresses when it is more than 'tolerance' percent above the baseline value.
+# Phases shorter than 'minimum duration' in the baseline are not compared (too noisy).
+# The exit code is 1 if at least one regression or new failure is found.
+
+if [ $# -lt 2 ]; then
+    echo "Usage : compare.sh baseline.txt current.txt [tolerance] [minimum duration]"
+    exit 1
+fi
+
+TOLERANCE=${3:-20}
+MINIMUM=${4:-5}
+
+awk -F'\t' -v tolerance=$TOLERANCE -v minimum=$MINIMUM '
+    # baseline
+    FNR == NR { base[$1 "\t" $2 "\t" $3] = $4; next }
+    {
+        key = $1 "\t" $2 "\t" $3
+        if ($3 == "failed") {
+            if (!(key in base)) { printf "NEW FAILURE\t%s\t%s\n", $1, $2; errors++ }
+            next
+        }
+        if (!(key in base)) next
+        ref = base[key]
+        if ($3 != "peak_rss_kb") {
+            total_ref[$2] += ($3 == "total") ? ref : 0
+            total_cur[$2] += ($3 == "total") ? $4 : 0
+            if (ref < minimum) next
+        }
+        if ($4 > ref * (1 + tolerance / 100)) {
+            printf "REGRESSION\t%s\t%s\t%s\t%s -> %s (+%.1f%%)\n", $1, $2, $3, ref, $4, ($4 / ref - 1) * 100
+            errors++
+        }
+    }
+    END {
+        for (backend in total_ref) {
+            if (total_ref[backend] > 0) {
+                printf "%s : total %d ms -> %d ms (%+.1f%%)\n", backend, total_ref[backend], total_cur[backend],
+                       (total_cur[backend] / total_ref[backend] - 1) * 100
+            }
+        }
+        if (errors) {
+            printf "%d regression(s) found\n", errors
+            exit 1
+        }
+        print "No regression found"
+    }' "$1" "$2"
@@ -0,0 +1,61 @@
+#!/bin/bash
+#
+# Measure the compilation time of a set of DSP files with several backends.
+#
+# Usage : compile-bench.sh file1.dsp file2.dsp ...
+#
+# Environment variables :
+#   FAUST         : the faust compiler (default ../../build/bin/faust)
+#   FACTORYBENCH  : the libfaust factory creation tool (default ./factory-bench)
+#   BACKENDS      : the list of backends (default "cpp c interp wasm interp-factory llvm-factory"),
+#                   'xxx-factory' backends use libfaust factory creation, the others use 'faust -lang xxx'
+#   FAUSTOPTIONS  : additional compilation options
+#
+# Output : one tab separated line per measure : <dsp> <backend> <measure> <value>
+# where measure is a compilation phase (duration in ms, summed when the phase is run several times),
+# 'total' (wall clock duration of the compiler process in ms) or 'peak_rss_kb'.
+# A DSP that cannot be compiled with a backend gives a single 'failed' measure.
+
+FAUST=${FAUST:-../../build/bin/faust}
+FACTORYBENCH=${FACTORYBENCH:-./factory-bench}
+BACKENDS=${BACKENDS:-"cpp c interp wasm interp-factory llvm-factory"}
+
+TRACE=$(mktemp /tmp/compile-bench.XXXXXX)
+OUT=$(mktemp /tmp/compile-bench-out.XXXXXX)
+
+now_ms()
+{
+    echo $(($(date +%s%N) / 1000000))
+}
+
+for dsp in "$@"; do
+    for backend in $BACKENDS; do
+        rm -f $TRACE
+        start=$(now_ms)
+        case $backend in
+            *-factory)
+                $FACTORYBENCH ${backend%-factory} $dsp -tt $TRACE $FAUSTOPTIONS > /dev/null 2>&1
+                status=$?;;
+            *)
+                $FAUST -lang $backend -tt $TRACE $FAUSTOPTIONS $dsp -o $OUT > /dev/null 2>&1
+                status=$?;;
+        esac
+        end=$(now_ms)
+
+        if [ $status -ne 0 ] || [ ! -f $TRACE ]; then
+            printf "%s\t%s\tfailed\t0\n" $dsp $backend
+            continue
+        fi
+
+        # One trace event per line : sum the phases durations (in us) by name
+        sed -n 's/^{"name": "\([^"]*\)", "cat": "faust", "ph": "X".*"dur": \([0-9]*\),.*/\1\t\2/p' $TRACE |
+            awk -F'\t' -v dsp=$dsp -v backend=$backend '
+                { if (!($1 in dur)) order[n++] = $1; dur[$1] += $2 }
+                END { for (i = 0; i < n; i++) printf "%s\t%s\t%s\t%.3f\n", dsp, backend, order[i], dur[order[i]] / 1000 }'
+        printf "%s\t%s\ttotal\t%d\n" $dsp $backend $((end - start))
+        rss=$(sed -n 's/.*"otherData": {[^}]*"peak_rss_kb": \([0-9]*\)}.*/\1/p' $TRACE)
+        printf "%s\t%s\tpeak_rss_kb\t%d\n" $dsp $backend ${rss:-0}
+    done
+done
+
+rm -f $TRACE $OUT
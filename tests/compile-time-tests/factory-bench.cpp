@@ -0,0 +1,65 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include "faust/dsp/interpreter-dsp.h"
+#include "faust/dsp/llvm-dsp.h"
+
+using namespace std;
+
+// Create (then delete) a libfaust factory, so that its compilation can be measured (typically with '-tt <file>')
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        cout << "factory-bench <interp|llvm> foo.dsp [additional Faust options (-vec -vs 8...)]" << endl;
+        return 0;
+    }
+
+    string backend = argv[1];
+    string error_msg;
+
+    if (backend == "interp") {
+        interpreter_dsp_factory* factory =
+            createInterpreterDSPFactoryFromFile(argv[2], argc - 3, (const char**)&argv[3], error_msg);
+        if (!factory) {
+            cerr << "ERROR in createInterpreterDSPFactoryFromFile : " << error_msg;
+            return 1;
+        }
+        deleteInterpreterDSPFactory(factory);
+    } else if (backend == "llvm") {
+        llvm_dsp_factory* factory = createDSPFactoryFromFile(argv[2], argc - 3, (const char**)&argv[3], "", error_msg, -1);
+        if (!factory) {
+            cerr << "ERROR in createDSPFactoryFromFile : " << error_msg;
+            return 1;
+        }
+        deleteDSPFactory(factory);
+    } else {
+        cerr << "ERROR : unknown backend " << backend << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,7 @@
+// select2 between sample-rate expressions in fused vector loops (-vec -fl)
+gain = hslider("gain", 0.5, 0, 1, 0.01);
+frac(x) = x - floor(x);
+phase = +(0.0137) ~ frac;
+sel(x) = select2(x > 0.4, sin(x * 3.0) * gain, cos(x) * (1.0 - gain));
+lp(x) = x : + ~ *(0.9);
+process = + (phase) <: sel, (abs : sqrt : sel) : + : lp : *(0.1);
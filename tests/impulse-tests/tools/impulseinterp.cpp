@@ -117,6 +117,34 @@ int main(int argc, char* argv[])
             runPolyDSP1(factory, linenum, nbsamples/4, 4);
             runPolyDSP1(factory, linenum, nbsamples/4, 1);
         }
+        
+        {
+            string error_msg;
+            // Test writeInterpreterDSPFactoryToBinaryFile/readInterpreterDSPFactoryFromBinaryFile
+            stringstream str; str << "/var/tmp/interp-factory" << factory << ".fbcb";
+            writeInterpreterDSPFactoryToBinaryFile(factory, str.str());
+            deleteInterpreterDSPFactory(static_cast<interpreter_dsp_factory*>(factory));
+            factory = readInterpreterDSPFactoryFromBinaryFile(str.str(), error_msg);
+            
+            if (!factory) {
+                cerr << "ERROR in readInterpreterDSPFactoryFromBinaryFile " << error_msg;
+                exit(-1);
+            }
+            
+            dsp* DSP = factory->createDSPInstance();
+            if (!DSP) {
+                cerr << "ERROR : createDSPInstance " << endl;
+                exit(-1);
+            }
+            
+            // print general informations
+            printHeader(DSP, nbsamples);
+            
+            runDSP1(factory, argv[1], linenum, nbsamples/4);
+            runDSP1(factory, argv[1], linenum, nbsamples/4, false, false, true);
+            runPolyDSP1(factory, linenum, nbsamples/4, 4);
+            runPolyDSP1(factory, linenum, nbsamples/4, 1);
+        }
      
     } else {
         
@@ -0,0 +1,3 @@
+import("oscillators.lib");
+
+process = saw : onepole;
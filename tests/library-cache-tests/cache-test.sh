@@ -0,0 +1,52 @@
+#!/bin/bash
+#
+# Check that the precompiled library cache does not change the compilation result.
+#
+# Usage : cache-test.sh file1.dsp file2.dsp ...
+#
+# Environment variables :
+#   FAUST         : the faust compiler (default ../../build/bin/faust)
+#   FAUSTOPTIONS  : additional compilation options
+#
+# Each DSP is compiled without the cache, then twice with an initially empty cache
+# (the first compilation fills it, the second one uses it). The generated code (which
+# contains the metadata) and the error messages have to be identical.
+
+FAUST=${FAUST:-../../build/bin/faust}
+
+CACHE=$(mktemp -d /tmp/library-cache.XXXXXX)
+OUT=$(mktemp -d /tmp/library-cache-out.XXXXXX)
+
+compile()
+{
+    # The compiler version and options lines are the same, but the cache directory is listed in the options
+    $FAUST $FAUSTOPTIONS "$@" 2>&1 | grep -v "Compilation options"
+}
+
+failures=0
+for dsp in "$@"; do
+    rm -rf $CACHE/*
+    name=$(basename $dsp .dsp)
+    compile $dsp > $OUT/$name-nocache.txt
+    compile -lcd $CACHE $dsp > $OUT/$name-cold.txt
+    if [ -z "$(ls $CACHE)" ]; then
+        echo "ERROR : $dsp : no library was cached"
+        failures=$((failures+1))
+        continue
+    fi
+    compile -lcd $CACHE $dsp > $OUT/$name-warm.txt
+    if ! diff $OUT/$name-nocache.txt $OUT/$name-cold.txt > /dev/null; then
+        echo "ERROR : $dsp : different result when filling the cache"
+        diff $OUT/$name-nocache.txt $OUT/$name-cold.txt
+        failures=$((failures+1))
+    elif ! diff $OUT/$name-nocache.txt $OUT/$name-warm.txt > /dev/null; then
+        echo "ERROR : $dsp : different result when using the cache"
+        diff $OUT/$name-nocache.txt $OUT/$name-warm.txt
+        failures=$((failures+1))
+    else
+        echo "OK : $dsp"
+    fi
+done
+
+rm -rf $CACHE $OUT
+[ $failures -eq 0 ]
@@ -0,0 +1,6 @@
+declare name "cache1";
+declare author "GRAME";
+
+import("oscillators.lib");
+
+process = saw(hslider("freq", 440, 20, 2000, 1)) : dcblock;
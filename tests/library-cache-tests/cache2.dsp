@@ -0,0 +1,6 @@
+declare name "cache2";
+
+import("filters.lib");
+import("oscillators.lib");
+
+process = par(i, 2, onepole(0.1 * (i + 1))), phasor(220);
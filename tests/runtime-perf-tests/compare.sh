@@ -0,0 +1,73 @@
+#!/bin/bash
+#
+# Compare runtime-bench.sh results with a baseline.
+#
+# Usage : compare.sh baseline.json current.json [tolerance (in %, default 5)]
+#
+# A measure regresses when its median block duration is more than 'tolerance' percent above the baseline one,
+# and when the 95% confidence intervals of both medians do not overlap (so that noise is not reported).
+# Measures where a CPU frequency change was detected during the measure ("stable": false) are reported as unreliable.
+# The exit code is 1 if at least one regression or new failure is found.
+
+if [ $# -lt 2 ]; then
+    echo "Usage : compare.sh baseline.json current.json [tolerance]"
+    exit 1
+fi
+
+TOLERANCE=${3:-5}
+
+for file in "$1" "$2"; do
+    governor=$(sed -n 's/^"governor": "\(.*\)",$/\1/p' $file)
+    if [ -n "$governor" ] && [ "$governor" != "performance" ]; then
+        echo "WARNING : $file was measured with the '$governor' CPU frequency governor, results may not be reliable"
+    fi
+done
+
+awk -v tolerance=$TOLERANCE '
+    function field(line, name,    value) {
+        if (!match(line, "\"" name "\": [^,}]*")) return ""
+        value = substr(line, RSTART + length(name) + 4, RLENGTH - length(name) - 4)
+        gsub("\"", "", value)
+        return value
+    }
+    !/^{"dsp"/ { next }
+    {
+        key = field($0, "dsp") "\t" field($0, "backend") "\t" field($0, "bsize")
+    }
+    # baseline
+    FNR == NR {
+        if (field($0, "failed") == "true") {
+            base_failed[key] = 1
+        } else {
+            # "+ 0" : the values extracted from the JSON lines are strings, they have to be compared as numbers
+            base[key] = field($0, "median_us") + 0; base_high[key] = field($0, "median_high_us") + 0
+        }
+        next
+    }
+    field($0, "failed") == "true" {
+        if (!(key in base_failed)) { printf "NEW FAILURE\t%s\t%s\n", field($0, "dsp"), field($0, "backend"); errors++ }
+        next
+    }
+    {
+        if (field($0, "stable") == "false") { printf "UNSTABLE\t%s\t(drift %s)\n", key, field($0, "drift"); unstable++ }
+        if (!(key in base)) next
+        ref = base[key]; cur = field($0, "median_us") + 0; low = field($0, "median_low_us") + 0
+        backend = field($0, "backend")
+        ratio_sum[backend] += log(cur / ref); ratio_count[backend]++
+        if (cur > ref * (1 + tolerance / 100) && low > base_high[key]) {
+            printf "REGRESSION\t%s\t%s -> %s us (+%.1f%%)\n", key, ref, cur, (cur / ref - 1) * 100
+            errors++
+        }
+    }
+    END {
+        for (backend in ratio_count) {
+            printf "%s : median block duration %+.1f%% (geometric mean on %d measures)\n", backend,
+                   (exp(ratio_sum[backend] / ratio_count[backend]) - 1) * 100, ratio_count[backend]
+        }
+        if (unstable) printf "%d unstable measure(s), check the CPU frequency scaling settings\n", unstable
+        if (errors) {
+            printf "%d regression(s) found\n", errors
+            exit 1
+        }
+        print "No regression found"
+    }' "$1" "$2"
@@ -0,0 +1,41 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include "faust/gui/UI.h"
+#include "faust/gui/meta.h"
+#include "runtime-bench.h"
+
+using namespace std;
+
+<<includeIntrinsic>>
+
+<<includeclass>>
+
+// Usage : foo -name <dsp> -backend <backend> [-bs 32,256,1024] [-duration <sec>]
+int main(int argc, char* argv[])
+{
+    mydsp DSP;
+    runtimeBench(&DSP, lopts(argv, "-name", "mydsp"), lopts(argv, "-backend", "cpp"), argv);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/interpreter-dsp.h"
+#ifdef LLVM_DSP
+#include "faust/dsp/llvm-dsp.h"
+#endif
+#include "runtime-bench.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3 || isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "runtime-bench-libfaust <interp|llvm> [-bs 32,256,1024] [-duration <sec>] [additional Faust options (-vec -vs 8...)] foo.dsp" << endl;
+        return 0;
+    }
+
+    string backend = argv[1];
+    string error_msg;
+
+    vector<const char*> argv1;
+    for (int i = 2; i < argc - 1; i++) {
+        if ((strcmp(argv[i], "-bs") == 0) || (strcmp(argv[i], "-duration") == 0)) {
+            i++;
+            continue;
+        }
+        argv1.push_back(argv[i]);
+    }
+    int argc1 = int(argv1.size());
+    argv1.push_back(nullptr);  // NULL terminated argv
+
+    const char* filename = argv[argc - 1];
+
+    if (backend == "interp") {
+        interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromFile(filename, argc1, argv1.data(), error_msg);
+        if (!factory) {
+            cerr << "ERROR in createInterpreterDSPFactoryFromFile : " << error_msg;
+            return 1;
+        }
+        dsp* DSP = factory->createDSPInstance();
+        runtimeBench(DSP, dspName(filename), backend, argv);
+        delete DSP;
+        deleteInterpreterDSPFactory(factory);
+#ifdef LLVM_DSP
+    } else if (backend == "llvm") {
+        llvm_dsp_factory* factory = createDSPFactoryFromFile(filename, argc1, argv1.data(), "", error_msg, -1);
+        if (!factory) {
+            cerr << "ERROR in createDSPFactoryFromFile : " << error_msg;
+            return 1;
+        }
+        dsp* DSP = factory->createDSPInstance();
+        runtimeBench(DSP, dspName(filename), backend, argv);
+        delete DSP;
+        deleteDSPFactory(factory);
+#endif
+    } else {
+        cerr << "ERROR : unknown backend " << backend << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#ifndef __runtime_bench__
+#define __runtime_bench__
+
+#include <stdlib.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "faust/dsp/dsp.h"
+#include "faust/dsp/dsp-bench.h"
+#include "faust/misc.h"
+
+// Parse a comma separated list of block sizes
+static std::vector<int> parseBlockSizes(const char* list)
+{
+    std::vector<int> bsizes;
+    std::stringstream reader(list);
+    std::string item;
+    while (std::getline(reader, item, ',')) {
+        int bsize = atoi(item.c_str());
+        if (bsize > 0) bsizes.push_back(bsize);
+    }
+    return bsizes;
+}
+
+// Returns the DSP name from its file path
+static std::string dspName(const std::string& path)
+{
+    std::string base = path.substr(path.find_last_of('/') + 1);
+    return base.substr(0, base.find_last_of('.'));
+}
+
+/**
+ * Measure a clone of the DSP with each block size during 'duration' seconds,
+ * and print one JSON object per block size on a single line (see README.md).
+ */
+static void runtimeBench(dsp* DSP, const std::string& name, const std::string& backend,
+                         const std::vector<int>& bsizes, double duration)
+{
+    for (size_t i = 0; i < bsizes.size(); i++) {
+        measure_dsp mes(DSP->clone(), bsizes[i], duration, false);
+        mes.measure();
+        bench_stats stats = mes.getBenchStats();
+        std::cout << "{\"dsp\": \"" << name << "\", \"backend\": \"" << backend << "\", \"bsize\": " << bsizes[i]
+                  << ", \"blocks\": " << stats.fCount
+                  << ", \"median_us\": " << stats.fMedianUsec
+                  << ", \"median_low_us\": " << stats.fLowUsec
+                  << ", \"median_high_us\": " << stats.fHighUsec
+                  << ", \"p99_us\": " << stats.fP99Usec
+                  << ", \"max_us\": " << stats.fMaxUsec
+                  << ", \"mbps\": " << stats.fMBps
+                  << ", \"mbps_low\": " << stats.fLowMBps
+                  << ", \"mbps_high\": " << stats.fHighMBps
+                  << ", \"drift\": " << stats.fDrift
+                  << ", \"stable\": " << (stats.isStable() ? "true" : "false") << "}" << std::endl;
+    }
+}
+
+// Usage : <tool> [-bs 32,256,1024] [-duration <sec>] ...
+static void runtimeBench(dsp* DSP, const std::string& name, const std::string& backend, char* argv[])
+{
+    runtimeBench(DSP, name, backend, parseBlockSizes(lopts(argv, "-bs", "32,256,1024")),
+                 atof(lopts(argv, "-duration", "1")));
+}
+
+#endif
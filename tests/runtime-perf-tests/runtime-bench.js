@@ -0,0 +1,143 @@
+'use strict';
+
+/*
+ Measure a DSP compiled with 'faust -lang wasm foo.dsp -o foo.wasm' using the node WebAssembly runtime.
+
+ Usage : node runtime-bench.js foo.wasm [-bs 32,256,1024] [-duration <sec>]
+
+ The foo.js file generated along foo.wasm is used to get the DSP JSON description.
+ One JSON object per block size is printed on a single line, with the same fields
+ as the C++ runtimeBench function (see runtime-bench.h).
+*/
+
+var fs = require('fs');
+var path = require('path');
+
+var SAMPLE_RATE = 44100;
+
+function option(name, def)
+{
+    var index = process.argv.indexOf(name);
+    return (index > 0 && index + 1 < process.argv.length) ? process.argv[index + 1] : def;
+}
+
+// Math functions imported by the wasm module, with the float ('_sinf') or double ('_sin') naming scheme
+function mathImport(name)
+{
+    var fun = name.replace(/^_/, '').replace(/_$/, '');
+    if (!Math[fun]) fun = fun.replace(/f$/, '').replace(/_$/, '');
+    if (fun === 'fmod') return function (x, y) { return x % y; };
+    if (fun === 'remainder') return function (x, y) { return x - Math.round(x / y) * y; };
+    if (fun === 'exp10') return function (x) { return Math.pow(10, x); };
+    if (fun === 'rint') return Math.round;
+    if (fun === 'abs' || fun === 'fabs') return Math.abs;
+    return Math[fun];
+}
+
+function benchDSP(instance, json, name, bsize, duration)
+{
+    var exports = instance.exports;
+    var numIn = parseInt(json.inputs);
+    var numOut = parseInt(json.outputs);
+    var sample_size = (json.compile_options.indexOf('-double') >= 0) ? 8 : 4;
+
+    // DSP is placed first with index 0, then the channel pointers, then the channel buffers
+    var dsp = 0;
+    var ptrs = parseInt(json.size);
+    var buffers = ptrs + (numIn + numOut) * 4;
+    buffers += (8 - buffers % 8) % 8;
+    var size = buffers + (numIn + numOut) * bsize * sample_size;
+    var memory = exports.memory;
+    if (memory.buffer.byteLength < size) {
+        memory.grow(Math.ceil((size - memory.buffer.byteLength) / 65536));
+    }
+
+    var HEAP32 = new Int32Array(memory.buffer);
+    var HEAPF = (sample_size === 8) ? new Float64Array(memory.buffer) : new Float32Array(memory.buffer);
+    for (var i = 0; i < numIn + numOut; i++) {
+        var buffer = buffers + i * bsize * sample_size;
+        HEAP32[(ptrs >> 2) + i] = buffer;
+        // Write noise in inputs (to avoid 'speedup' effect due to null values)
+        for (var j = 0; j < bsize && i < numIn; j++) {
+            HEAPF[buffer / sample_size + j] = Math.random() * 2 - 1;
+        }
+    }
+    var ins = ptrs;
+    var outs = ptrs + numIn * 4;
+
+    exports.init(dsp, SAMPLE_RATE);
+
+    function measure(count)
+    {
+        var V = new Array(count);
+        for (var i = 0; i < count; i++) {
+            var start = process.hrtime.bigint();
+            exports.compute(dsp, bsize, ins, outs);
+            V[i] = Number(process.hrtime.bigint() - start) / 1000;
+        }
+        return V;
+    }
+
+    function median(V)
+    {
+        var S = V.slice().sort(function (a, b) { return a - b; });
+        return S[Math.floor(S.length / 2)];
+    }
+
+    // A first measure (also used to warm up the JIT) estimates the proper number of blocks
+    var start = process.hrtime.bigint();
+    measure(1000);
+    var elapsed = Number(process.hrtime.bigint() - start) / 1e9;
+    var count = Math.max(100, Math.floor(1000 * duration / elapsed));
+
+    var V = measure(count);
+    var quarter = Math.floor(count / 4);
+    var drift = median(V.slice(count - quarter)) / median(V.slice(0, quarter)) - 1;
+
+    V.sort(function (a, b) { return a - b; });
+    var half = Math.floor(0.98 * Math.sqrt(count));
+    var low = Math.max(0, Math.floor(count / 2) - half - 1);
+    var high = Math.min(count - 1, Math.floor(count / 2) + half);
+    var mbps = function (usec) { return bsize * (numIn + numOut) * 4 / (1024 * 1024 * usec / 1e6); };
+    var stats = {
+        dsp: name,
+        backend: 'wasm',
+        bsize: bsize,
+        blocks: count,
+        median_us: V[Math.floor(count / 2)],
+        median_low_us: V[low],
+        median_high_us: V[high],
+        p99_us: V[Math.min(count - 1, Math.floor(count * 99 / 100))],
+        max_us: V[count - 1],
+        mbps: mbps(V[Math.floor(count / 2)]),
+        mbps_low: mbps(V[high]),
+        mbps_high: mbps(V[low]),
+        drift: drift,
+        stable: Math.abs(drift) <= 0.05
+    };
+    console.log(JSON.stringify(stats).replace(/,"/g, ', "').replace(/":/g, '": '));
+}
+
+var wasm_file = process.argv[2];
+if (!wasm_file) {
+    console.log('node runtime-bench.js foo.wasm [-bs 32,256,1024] [-duration <sec>]');
+    process.exit(0);
+}
+
+var name = path.basename(wasm_file, '.wasm');
+var js = fs.readFileSync(wasm_file.replace(/\.wasm$/, '.js'), 'utf8');
+var json = JSON.parse(new Function(js + '; return getJSONmydsp();')());
+var module = new WebAssembly.Module(fs.readFileSync(wasm_file));
+
+var env = {};
+WebAssembly.Module.imports(module).forEach(function (item) {
+    if (item.kind === 'function') env[item.name] = mathImport(item.name);
+});
+
+var bsizes = option('-bs', '32,256,1024').split(',').map(Number);
+var duration = parseFloat(option('-duration', '1'));
+
+bsizes.forEach(function (bsize) {
+    // A new instance for each block size, so that the memory layout only depends on the block size
+    benchDSP(new WebAssembly.Instance(module, { env: env }), json, name, bsize, duration);
+});
@@ -0,0 +1,90 @@
+#!/bin/bash
+#
+# Measure the runtime performance of a set of DSP files with several backends and block sizes.
+#
+# Usage : runtime-bench.sh file1.dsp file2.dsp ...
+#
+# Environment variables :
+#   FAUST          : the faust compiler (default ../../build/bin/faust)
+#   LIBFAUSTBENCH  : the libfaust runtime measure tool (default ./runtime-bench-libfaust)
+#   BACKENDS       : the list of backends (default "cpp-scal cpp-vec cpp-sch interp llvm wasm"),
+#                    'cpp-xxx' backends compile the C++ code generated with 'faust -xxx',
+#                    'interp' and 'llvm' use libfaust factories, 'wasm' uses the node WebAssembly runtime
+#   BLOCKSIZES     : comma separated list of block sizes (default "32,256,1024")
+#   DURATION       : duration of each measure in seconds (default 1)
+#   FAUSTOPTIONS   : additional compilation options
+#   CXX, CXXFLAGS  : the C++ compiler and its options (default "-O3 -march=native")
+#
+# Output : a JSON document with the machine description and one result per line in the 'results' array :
+# { "dsp", "backend", "bsize", "blocks", "median_us", "median_low_us", "median_high_us", "p99_us", "max_us",
+#   "mbps", "mbps_low", "mbps_high", "drift", "stable" }
+# (see README.md). A DSP that cannot be compiled or run with a backend gives a { "dsp", "backend", "failed" } result.
+
+FAUST=${FAUST:-../../build/bin/faust}
+LIBFAUSTBENCH=${LIBFAUSTBENCH:-./runtime-bench-libfaust}
+BACKENDS=${BACKENDS:-"cpp-scal cpp-vec cpp-sch interp llvm wasm"}
+BLOCKSIZES=${BLOCKSIZES:-"32,256,1024"}
+DURATION=${DURATION:-1}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-O3 -march=native"}
+ARCH=$(dirname $0)/runtime-bench-arch.cpp
+NODEBENCH=$(dirname $0)/runtime-bench.js
+
+TMP=$(mktemp -d /tmp/runtime-bench.XXXXXX)
+BENCHOPTIONS="-bs $BLOCKSIZES -duration $DURATION"
+
+governor=$(cat /sys/devices/system/cpu/cpu0/cpufreq/scaling_governor 2> /dev/null)
+cpu=$(sed -n 's/^model name[[:space:]]*: //p' /proc/cpuinfo 2> /dev/null | head -1)
+commit=$(git rev-parse --short HEAD 2> /dev/null)
+
+echo "{"
+echo "\"commit\": \"$commit\","
+echo "\"date\": \"$(date +%Y-%m-%dT%H:%M:%S)\","
+echo "\"machine\": \"$(uname -srm)\","
+echo "\"cpu\": \"$cpu\","
+echo "\"governor\": \"$governor\","
+echo "\"options\": \"$FAUSTOPTIONS\","
+echo "\"results\": ["
+
+first=true
+output()
+{
+    while read -r line; do
+        $first || echo ","
+        first=false
+        printf "%s" "$line"
+    done
+}
+
+for dsp in "$@"; do
+    name=$(basename $dsp .dsp)
+    for backend in $BACKENDS; do
+        case $backend in
+            cpp-*)
+                $FAUST -${backend#cpp-} $FAUSTOPTIONS -a $ARCH $dsp -o $TMP/$name.cpp > /dev/null 2>&1 &&
+                $CXX $CXXFLAGS -I$(dirname $0) -I$(dirname $0)/../../architecture $TMP/$name.cpp -lpthread -o $TMP/$name > /dev/null 2>&1 &&
+                $TMP/$name -name $name -backend $backend $BENCHOPTIONS > $TMP/result.txt 2> /dev/null
+                status=$?;;
+            wasm)
+                $FAUST -lang wasm $FAUSTOPTIONS $dsp -o $TMP/$name.wasm > /dev/null 2>&1 &&
+                node $NODEBENCH $TMP/$name.wasm $BENCHOPTIONS > $TMP/result.txt 2> /dev/null
+                status=$?;;
+            *)
+                $LIBFAUSTBENCH $backend $BENCHOPTIONS $FAUSTOPTIONS $dsp > $TMP/result.txt 2> /dev/null
+                status=$?;;
+        esac
+
+        if [ $status -ne 0 ] || [ ! -s $TMP/result.txt ]; then
+            # Not piped : 'output' has to run in the current shell to update 'first'
+            output <<< "{\"dsp\": \"$name\", \"backend\": \"$backend\", \"failed\": true}"
+        else
+            output < $TMP/result.txt
+        fi
+    done
+done
+
+echo
+echo "]"
+echo "}"
+
+rm -rf $TMP
@@ -29,9 +29,12 @@
 using namespace std;
 
 template <typename T>
-static void bench(dsp_optimizer<T> optimizer, const string& name, bool trace)
+static void bench(dsp_optimizer<T> optimizer, const string& name, const string& profile, const string& select_profile, bool trace)
 {
-    pair<double, vector<std::string> > res = optimizer.findOptimizedParameters();
+    if (select_profile != "") optimizer.setSelectProfile(select_profile);
+    pair<double, vector<std::string> > res = (profile != "")
+        ? optimizer.findOptimizedParameters(profile)
+        : optimizer.findOptimizedParameters();
     if (trace) cout << "Best value is for '" << name << "' is : " << res.first << " with ";
     for (int i = 0; i < res.second.size(); i++) {
         cout << res.second[i] << " ";
@@ -51,11 +54,13 @@ static void splitTarget(const string& target, string& triple, string& cpu)
 int main(int argc, char* argv[])
 {
     if (argc == 1 || isopt(argv, "-h") || isopt(argv, "-help")) {
-        cout << "faustbench-llvm [-notrace] [-generic] [-single] [-run <num>] [additional Faust options (-vec -vs 8...)] foo.dsp" << endl;
+        cout << "faustbench-llvm [-notrace] [-generic] [-single] [-run <num>] [-profile <file>] [-pgo <file>] [additional Faust options (-vec -vs 8...)] foo.dsp" << endl;
         cout << "Use '-notrace' to only generate the best compilation parameters\n";
         cout << "Use '-generic' to compile for a generic processor, otherwise the native CPU will be used\n";
         cout << "Use '-single' to execute only scalar test\n";
         cout << "Use '-run <num>' to execute each test <num> times\n";
+        cout << "Use '-profile <file>' to reuse and update the measures kept in <file>, so that only the best profiled parameters are tested again\n";
+        cout << "Use '-pgo <file>' to first run an instrumented version of the DSP, write how often each select2 condition is true in <file>, and compile the tested parameters with '-pgu <file>'\n";
         return 0;
     }
     
@@ -65,6 +70,8 @@ int main(int argc, char* argv[])
     bool is_generic = isopt(argv, "-generic");
     
     int run = lopt(argv, "-run", 1);
+    string profile = lopts(argv, "-profile", "");
+    string select_profile = lopts(argv, "-pgo", "");
     
     int buffer_size = 1024;
     
@@ -88,7 +95,7 @@ int main(int argc, char* argv[])
     for (int i = 1; i < argc-1; i++) {
         if (string(argv[i]) == "-single" || string(argv[i]) == "-generic") {
             continue;
-        } else if (string(argv[i]) == "-run") {
+        } else if (string(argv[i]) == "-run" || string(argv[i]) == "-profile" || string(argv[i]) == "-pgo") {
             i++;
             continue;
         }
@@ -130,9 +137,9 @@ int main(int argc, char* argv[])
 
         } else {
             if (is_double) {
-                bench(dsp_optimizer<double>(argv[argc-1], argc1, argv1, target, buffer_size, run, -1, is_trace), argv[argc-1], is_trace);
+                bench(dsp_optimizer<double>(argv[argc-1], argc1, argv1, target, buffer_size, run, -1, is_trace), argv[argc-1], profile, select_profile, is_trace);
             } else {
-                bench(dsp_optimizer<float>(argv[argc-1], argc1, argv1, target, buffer_size, run, -1, is_trace), argv[argc-1], is_trace);
+                bench(dsp_optimizer<float>(argv[argc-1], argc1, argv1, target, buffer_size, run, -1, is_trace), argv[argc-1], profile, select_profile, is_trace);
             }
         }
     } catch (...) {}
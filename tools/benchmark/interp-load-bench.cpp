@@ -0,0 +1,100 @@
+/************************************************************************
+    FAUST Architecture File
+    Copyright (C) 2003-2019 GRAME, Centre National de Creation Musicale
+    ---------------------------------------------------------------------
+    This Architecture section is free software; you can redistribute it
+    and/or modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 3 of
+    the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; If not, see <http://www.gnu.org/licenses/>.
+
+    EXCEPTION : As a special exception, you may create a larger work
+    that contains this FAUST architecture section and distribute
+    that work under terms of your choice, so long as this FAUST
+    architecture section is not modified.
+
+ ************************************************************************/
+
+#include <string.h>
+#include <sys/time.h>
+#include <iostream>
+#include <string>
+
+#include "faust/dsp/interpreter-dsp.h"
+#include "faust/misc.h"
+
+using namespace std;
+
+static double getMillisec()
+{
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return double(tv.tv_sec) * 1000. + double(tv.tv_usec) / 1000.;
+}
+
+typedef interpreter_dsp_factory* (*ReaderFun)(const string& path, string& error_msg);
+
+// Returns the mean loading time of a factory file in ms, including the first DSP instance creation
+static double benchLoad(ReaderFun reader, const string& path, int run)
+{
+    double start = getMillisec();
+    for (int i = 0; i < run; i++) {
+        string error_msg;
+        interpreter_dsp_factory* factory = reader(path, error_msg);
+        if (!factory) {
+            cerr << "Cannot read factory : " << error_msg;
+            exit(EXIT_FAILURE);
+        }
+        delete factory->createDSPInstance();
+        deleteInterpreterDSPFactory(factory);
+    }
+    return (getMillisec() - start) / run;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 1 || isopt(argv, "-h") || isopt(argv, "-help")) {
+        cout << "interp-load-bench [-run <num>] [additional Faust options (-vec -vs 8...)] foo.dsp" << endl;
+        cout << "Use '-run <num>' to load each file <num> times\n";
+        return 0;
+    }
+
+    int run = lopt(argv, "-run", 100);
+
+    int argc1 = 0;
+    const char* argv1[64];
+    for (int i = 1; i < argc-1; i++) {
+        if (string(argv[i]) == "-run") {
+            i++;
+            continue;
+        }
+        argv1[argc1++] = argv[i];
+    }
+    argv1[argc1] = 0;  // NULL terminated argv
+
+    string error_msg;
+    interpreter_dsp_factory* factory = createInterpreterDSPFactoryFromFile(argv[argc-1], argc1, argv1, error_msg);
+    if (!factory) {
+        cerr << "Cannot create factory : " << error_msg;
+        exit(EXIT_FAILURE);
+    }
+
+    string text_path = "/var/tmp/interp-load-bench.fbc";
+    string binary_path = "/var/tmp/interp-load-bench.fbcb";
+    writeInterpreterDSPFactoryToBitcodeFile(factory, text_path);
+    writeInterpreterDSPFactoryToBinaryFile(factory, binary_path);
+    deleteInterpreterDSPFactory(factory);
+
+    double text = benchLoad(readInterpreterDSPFactoryFromBitcodeFile, text_path, run);
+    double binary = benchLoad(readInterpreterDSPFactoryFromBinaryFile, binary_path, run);
+
+    cout << argv[argc-1] << " : text " << text << " ms, binary " << binary << " ms (speedup " << (text / binary) << ")" << endl;
+    return 0;
+}